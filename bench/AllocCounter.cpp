@@ -0,0 +1,76 @@
+/*
+ Copyright 2010, 2011 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Benchmark.h"
+#include <stddef.h>
+
+/*
+ * Counts heap allocations by interposing malloc family of glibc, so that
+ * allocations made inside cairo, pango and DirectFB are counted as well.
+ * Link this file into benchmarks which report allocs/op.
+ */
+
+volatile long ilixi::benchAllocs = 0;
+volatile long ilixi::benchAllocBytes = 0;
+
+extern "C"
+{
+  void*
+  __libc_malloc(size_t size);
+  void*
+  __libc_calloc(size_t count, size_t size);
+  void*
+  __libc_realloc(void* ptr, size_t size);
+  void
+  __libc_free(void* ptr);
+
+  void*
+  malloc(size_t size)
+  {
+    __sync_fetch_and_add(&ilixi::benchAllocs, 1);
+    __sync_fetch_and_add(&ilixi::benchAllocBytes, size);
+    return __libc_malloc(size);
+  }
+
+  void*
+  calloc(size_t count, size_t size)
+  {
+    __sync_fetch_and_add(&ilixi::benchAllocs, 1);
+    __sync_fetch_and_add(&ilixi::benchAllocBytes, count * size);
+    return __libc_calloc(count, size);
+  }
+
+  void*
+  realloc(void* ptr, size_t size)
+  {
+    __sync_fetch_and_add(&ilixi::benchAllocs, 1);
+    __sync_fetch_and_add(&ilixi::benchAllocBytes, size);
+    return __libc_realloc(ptr, size);
+  }
+
+  void
+  free(void* ptr)
+  {
+    __libc_free(ptr);
+  }
+}
@@ -0,0 +1,154 @@
+/*
+ Copyright 2010, 2011 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ui/Application.h"
+#include "ui/Checkbox.h"
+#include "ui/Frame.h"
+#include "ui/HBoxLayout.h"
+#include "ui/Label.h"
+#include "ui/PushButton.h"
+#include "ui/Slider.h"
+#include "ui/VBoxLayout.h"
+#include "core/Arena.h"
+#include "Benchmark.h"
+#include <stdlib.h>
+
+using namespace ilixi;
+
+/*
+ * Measures construction and destruction of widget trees with and without
+ * an arena, see ArenaScope. Time and heap allocations are reported for
+ * build and teardown separately.
+ *
+ * Usage: ilixi_bench_arena [iterations]
+ *
+ * Arena variant creates a new arena for each tree and destroys it after
+ * tree is deleted, as a dialog would.
+ */
+
+namespace
+{
+  long iterations = 100;
+
+  typedef Widget*
+  (*BuildFunc)();
+
+  //! Form with rows of labels, buttons, checkboxes and sliders.
+  Widget*
+  buildForm()
+  {
+    Frame* root = new Frame();
+    root->setLayout(new VBoxLayout());
+    for (int i = 0; i < 100; ++i)
+      {
+        Frame* row = new Frame();
+        row->setLayout(new HBoxLayout());
+        row->addWidget(new Label("Label"));
+        row->addWidget(new PushButton("Button"));
+        row->addWidget(new Checkbox("Check"));
+        row->addWidget(new Slider());
+        root->addWidget(row);
+      }
+    return root;
+  }
+
+  //! Frames nested in a grid, no text.
+  Widget*
+  buildFrames()
+  {
+    Frame* root = new Frame();
+    root->setLayout(new VBoxLayout());
+    for (int i = 0; i < 50; ++i)
+      {
+        Frame* row = new Frame();
+        row->setLayout(new HBoxLayout());
+        for (int j = 0; j < 40; ++j)
+          row->addWidget(new Frame());
+        root->addWidget(row);
+      }
+    return root;
+  }
+
+  void
+  benchBuild(const char* name, BuildFunc build, bool useArena)
+  {
+    long long buildTime = 0, teardownTime = 0;
+    long buildAllocs = 0, buildBytes = 0;
+    long teardownAllocs = 0, teardownBytes = 0;
+
+    for (long i = 0; i < iterations; ++i)
+      {
+        Arena* arena = useArena ? new Arena() : NULL;
+
+        long allocs = benchAllocs;
+        long bytes = benchAllocBytes;
+        long long start = benchNanos();
+        Widget* root;
+          {
+            ArenaScope scope(arena);
+            root = build();
+          }
+        long long built = benchNanos();
+        buildTime += built - start;
+        buildAllocs += benchAllocs - allocs;
+        buildBytes += benchAllocBytes - bytes;
+
+        allocs = benchAllocs;
+        bytes = benchAllocBytes;
+        delete root;
+        if (arena)
+          arena->destroy();
+        teardownTime += benchNanos() - built;
+        teardownAllocs += benchAllocs - allocs;
+        teardownBytes += benchAllocBytes - bytes;
+      }
+
+    char label[128];
+    snprintf(label, sizeof(label), "%s/%s/Build", name, useArena ? "Arena"
+        : "Heap");
+    benchReportAllocs(label, iterations, buildTime, buildAllocs, buildBytes);
+    snprintf(label, sizeof(label), "%s/%s/Teardown", name, useArena ? "Arena"
+        : "Heap");
+    benchReportAllocs(label, iterations, teardownTime, teardownAllocs,
+        teardownBytes);
+  }
+
+  void
+  run(int argc, char* argv[])
+  {
+    printf("# %ld iterations per result\n", iterations);
+    // warm up font map and designer caches.
+    delete buildForm();
+
+    benchBuild("Form", buildForm, false);
+    benchBuild("Form", buildForm, true);
+    benchBuild("Frames", buildFrames, false);
+    benchBuild("Frames", buildFrames, true);
+  }
+}
+
+int
+main(int argc, char* argv[])
+{
+  return benchMain(argc, argv, iterations, run);
+}
@@ -0,0 +1,128 @@
+/*
+ Copyright 2010, 2011 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ILIXI_BENCHMARK_H_
+#define ILIXI_BENCHMARK_H_
+
+#include "ui/Application.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+namespace ilixi
+{
+  //! Number of heap allocations so far, counted only if AllocCounter.cpp is linked.
+  extern volatile long benchAllocs;
+
+  //! Number of bytes requested from heap so far, see benchAllocs.
+  extern volatile long benchAllocBytes;
+
+  //! Returns a monotonic timestamp in nanoseconds.
+  inline long long
+  benchNanos()
+  {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+  }
+
+  /*!
+   * Prints a result line in the form
+   *
+   * Benchmark<name> <iterations> <ns> ns/op [<value> <unit> [<value2> <unit2>]]
+   *
+   * so that results can be compared with standard tools.
+   *
+   * @param name benchmark name.
+   * @param iterations number of operations measured.
+   * @param nanos total time in nanoseconds.
+   * @param value optional extra metric.
+   * @param unit unit of extra metric, or NULL if there is none.
+   * @param value2 optional second metric.
+   * @param unit2 unit of second metric, or NULL if there is none.
+   */
+  inline void
+  benchReport(const char* name, long iterations, long long nanos,
+      double value = 0, const char* unit = NULL, double value2 = 0,
+      const char* unit2 = NULL)
+  {
+    printf("Benchmark%-40s %10ld %14.1f ns/op", name, iterations,
+        nanos / (double) iterations);
+    if (unit)
+      printf(" %12.2f %s", value, unit);
+    if (unit2)
+      printf(" %12.2f %s", value2, unit2);
+    printf("\n");
+    fflush(stdout);
+  }
+
+  /*!
+   * Prints a result line with heap usage per operation in the form
+   *
+   * Benchmark<name> <iterations> <ns> ns/op <bytes> B/op <allocs> allocs/op
+   *
+   * @param name benchmark name.
+   * @param iterations number of operations measured.
+   * @param nanos total time in nanoseconds.
+   * @param allocs number of allocations during measurement.
+   * @param bytes number of bytes allocated during measurement.
+   */
+  inline void
+  benchReportAllocs(const char* name, long iterations, long long nanos,
+      long allocs, long bytes)
+  {
+    printf("Benchmark%-40s %10ld %14.1f ns/op %10ld B/op %8.2f allocs/op\n",
+        name, iterations, nanos / (double) iterations, bytes / iterations,
+        allocs / (double) iterations);
+    fflush(stdout);
+  }
+
+  //! Benchmark body, called by benchMain() with program arguments.
+  typedef void
+  (*BenchFunc)(int argc, char* argv[]);
+
+  /*!
+   * Reads iteration count from argv[1], creates a headless Application,
+   * see AppBase::headless(), and calls run.
+   *
+   * @param argc number of program arguments.
+   * @param argv program arguments.
+   * @param iterations set to argv[1] if given, at least 1.
+   * @param run benchmark body.
+   */
+  inline int
+  benchMain(int argc, char* argv[], long& iterations, BenchFunc run)
+  {
+    if (argc > 1)
+      iterations = atol(argv[1]);
+    if (iterations < 1)
+      iterations = 1;
+    setenv("ILIXI_HEADLESS", "1", 0);
+
+    Application app(argc, argv);
+    run(argc, argv);
+    return 0;
+  }
+}
+
+#endif /* ILIXI_BENCHMARK_H_ */
@@ -0,0 +1,318 @@
+/*
+ Copyright 2010, 2011 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ilixiConfig.h"
+#include "ui/Application.h"
+#include "ui/Checkbox.h"
+#include "ui/ComboBox.h"
+#include "ui/Label.h"
+#include "ui/LineEdit.h"
+#include "ui/ProgressBar.h"
+#include "ui/PushButton.h"
+#include "ui/RadioButton.h"
+#include "ui/ScrollBar.h"
+#include "ui/Slider.h"
+#include "ui/TabPanel.h"
+#include "ui/ToolButton.h"
+#include "graphics/Painter.h"
+#include "graphics/TDesigner.h"
+#include "types/Image.h"
+#include "types/LinearGradient.h"
+#include "Benchmark.h"
+#include <stdlib.h>
+#include <string.h>
+
+using namespace ilixi;
+
+/*
+ * Measures Designer draw routines and Painter primitives. Each routine is
+ * drawn onto an offscreen surface at several sizes, widget states and
+ * anti-alias modes; time and heap allocations per call are reported.
+ *
+ * Usage: ilixi_bench_designer [iterations] [TDesigner|Designer]
+ *
+ * Designers are compared using the same compiled stylesheet.
+ */
+
+namespace
+{
+  struct BenchSize
+  {
+    int width;
+    int height;
+  };
+
+  const BenchSize sizes[] =
+    {
+      { 64, 24 },
+      { 160, 40 },
+      { 480, 96 } };
+  const int sizeCount = sizeof(sizes) / sizeof(sizes[0]);
+
+  const Painter::AntiAliasMode aliasModes[] =
+    { Painter::AliasDefault, Painter::AliasNone };
+  const char* aliasNames[] =
+    { "AA", "NoAA" };
+
+  long iterations = 1000;
+  Designer* benchDesigner = NULL;
+  Surface* target = NULL;
+
+  typedef void
+  (*DrawFunc)(Painter* painter, Widget* widget);
+
+  void
+  drawPushButton(Painter* p, Widget* w)
+  {
+    benchDesigner->drawPushButton(p, dynamic_cast<PushButton*> (w));
+  }
+
+  void
+  drawToolButton(Painter* p, Widget* w)
+  {
+    benchDesigner->drawToolButton(p, dynamic_cast<ToolButton*> (w));
+  }
+
+  void
+  drawCheckBox(Painter* p, Widget* w)
+  {
+    benchDesigner->drawCheckBox(p, dynamic_cast<Checkbox*> (w));
+  }
+
+  void
+  drawRadioButton(Painter* p, Widget* w)
+  {
+    benchDesigner->drawRadioButton(p, dynamic_cast<RadioButton*> (w));
+  }
+
+  void
+  drawComboBox(Painter* p, Widget* w)
+  {
+    benchDesigner->drawComboBox(p, dynamic_cast<ComboBox*> (w));
+  }
+
+  void
+  drawLabel(Painter* p, Widget* w)
+  {
+    benchDesigner->drawLabel(p, dynamic_cast<Label*> (w));
+  }
+
+  void
+  drawProgressBar(Painter* p, Widget* w)
+  {
+    benchDesigner->drawProgressBar(p, dynamic_cast<ProgressBar*> (w));
+  }
+
+  void
+  drawSlider(Painter* p, Widget* w)
+  {
+    benchDesigner->drawSlider(p, dynamic_cast<Slider*> (w));
+  }
+
+  void
+  drawScrollBar(Painter* p, Widget* w)
+  {
+    benchDesigner->drawScrollBar(p, dynamic_cast<ScrollBar*> (w));
+  }
+
+  void
+  drawLineEdit(Painter* p, Widget* w)
+  {
+    benchDesigner->drawLineEdit(p, dynamic_cast<LineEdit*> (w), Rectangle());
+  }
+
+  void
+  drawTabPanel(Painter* p, Widget* w)
+  {
+    benchDesigner->drawTabPanel(p, dynamic_cast<TabPanel*> (w));
+  }
+
+  void
+  drawFrame(Painter* p, Widget* w)
+  {
+    benchDesigner->drawFrame(p, dynamic_cast<Frame*> (w), 0, 0, w->width(), w->height(), true);
+  }
+
+  /*
+   * Runs draw for widget at each size, anti-alias mode and in given state.
+   */
+  void
+  benchDraw(const char* name, const char* state, Widget* widget,
+      DrawFunc draw)
+  {
+    char label[128];
+    for (int s = 0; s < sizeCount; ++s)
+      {
+        widget->setGeometry(0, 0, sizes[s].width, sizes[s].height);
+        for (int a = 0; a < 2; ++a)
+          {
+            Painter painter(target);
+            painter.setAntiAliasMode(aliasModes[a]);
+            painter.begin(Rectangle(0, 0, sizes[s].width, sizes[s].height));
+            draw(&painter, widget);
+
+            long allocs = benchAllocs;
+            long bytes = benchAllocBytes;
+            long long start = benchNanos();
+            for (long i = 0; i < iterations; ++i)
+              draw(&painter, widget);
+            cairo_surface_flush(cairo_get_target(painter.cairoContext()));
+            long long nanos = benchNanos() - start;
+            allocs = benchAllocs - allocs;
+            bytes = benchAllocBytes - bytes;
+            painter.end();
+
+            snprintf(label, sizeof(label), "%s/%dx%d/%s/%s", name,
+                sizes[s].width, sizes[s].height, state, aliasNames[a]);
+            benchReportAllocs(label, iterations, nanos, allocs, bytes);
+          }
+      }
+  }
+
+  void
+  benchWidget(const char* name, Widget* widget, DrawFunc draw,
+      Button* checkable = NULL)
+  {
+    benchDraw(name, "Default", widget, draw);
+    if (checkable)
+      {
+        checkable->setCheckable(true);
+        checkable->setChecked(true);
+        benchDraw(name, "Checked", widget, draw);
+        checkable->setChecked(false);
+      }
+    widget->setDisabled();
+    benchDraw(name, "Disabled", widget, draw);
+    widget->setEnabled();
+    delete widget;
+  }
+
+  // Painter primitives
+  Image* image = NULL;
+
+  void
+  drawRoundRectangle(Painter* p, Widget* w)
+  {
+    p->drawRoundRectangle(Rectangle(0, 0, w->width(), w->height()), 8,
+        Painter::FillPath);
+  }
+
+  void
+  strokeRoundRectangle(Painter* p, Widget* w)
+  {
+    p->drawRoundRectangle(Rectangle(0, 0, w->width(), w->height()), 8);
+  }
+
+  void
+  drawText(Painter* p, Widget* w)
+  {
+    p->drawText("The quick brown fox jumps over the lazy dog", 0, 0,
+        w->width(), w->height());
+  }
+
+  void
+  drawImage(Painter* p, Widget* w)
+  {
+    p->drawImage(image, Rectangle(0, 0, w->width(), w->height()));
+  }
+
+  void
+  drawGradient(Painter* p, Widget* w)
+  {
+    LinearGradient gradient(0, 0, 0, w->height());
+    gradient.addStop(Color(0.9, 0.9, 0.9), 0);
+    gradient.addStop(Color(0.5, 0.5, 0.5), 1);
+    p->getBrush()->setGradient(gradient);
+    p->drawRectangle(0, 0, w->width(), w->height(), Painter::FillPath);
+  }
+
+  void
+  run(int argc, char* argv[])
+  {
+    const char* name = argc > 2 ? argv[2] : "TDesigner";
+    if (!strcmp(name, "Designer"))
+      benchDesigner = new Designer(TDesigner::defaultStyle());
+    else
+      benchDesigner = new TDesigner(TDesigner::defaultStyle());
+
+    target = new Surface();
+    if (!target->createDFBSurface(sizes[sizeCount - 1].width,
+        sizes[sizeCount - 1].height, false))
+      {
+        printf("# Cannot create target surface!\n");
+        return;
+      }
+
+    printf("# %s, %ld iterations per result\n", name, iterations);
+    benchWidget("DrawPushButton", new PushButton("Push Button"),
+        drawPushButton);
+    ToolButton* tool = new ToolButton("Tool Button");
+    benchWidget("DrawToolButton", tool, drawToolButton, tool);
+    Checkbox* check = new Checkbox("Checkbox");
+    benchWidget("DrawCheckBox", check, drawCheckBox, check);
+    RadioButton* radio = new RadioButton("Radio Button");
+    benchWidget("DrawRadioButton", radio, drawRadioButton, radio);
+    ComboBox* combo = new ComboBox("Combo Box");
+    combo->addItem("First item");
+    combo->addItem("Second item");
+    benchWidget("DrawComboBox", combo, drawComboBox);
+    benchWidget("DrawLabel", new Label("Label text"), drawLabel);
+    ProgressBar* bar = new ProgressBar();
+    bar->setValue(40);
+    benchWidget("DrawProgressBar", bar, drawProgressBar);
+    Slider* slider = new Slider();
+    slider->setValue(40);
+    benchWidget("DrawSlider", slider, drawSlider);
+    benchWidget("DrawScrollBar", new ScrollBar(), drawScrollBar);
+    benchWidget("DrawLineEdit", new LineEdit("Line edit text"),
+        drawLineEdit);
+    TabPanel* panel = new TabPanel();
+    panel->addPage(new Label("First"), "First");
+    panel->addPage(new Label("Second"), "Second");
+    panel->addPage(new Label("Third"), "Third");
+    benchWidget("DrawTabPanel", panel, drawTabPanel);
+    benchWidget("DrawFrame", new Frame(), drawFrame);
+
+    // Painter primitives use widget only for its size.
+    Frame* frame = new Frame();
+    image = new Image(ILIXI_DATADIR"ok.png", 48, 48);
+    benchDraw("PainterFillRoundRectangle", "Default", frame,
+        drawRoundRectangle);
+    benchDraw("PainterStrokeRoundRectangle", "Default", frame,
+        strokeRoundRectangle);
+    benchDraw("PainterDrawText", "Default", frame, drawText);
+    benchDraw("PainterDrawImage", "Default", frame, drawImage);
+    benchDraw("PainterLinearGradient", "Default", frame, drawGradient);
+    delete image;
+    delete frame;
+
+    delete target;
+    delete benchDesigner;
+  }
+}
+
+int
+main(int argc, char* argv[])
+{
+  return benchMain(argc, argv, iterations, run);
+}
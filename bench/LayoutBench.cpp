@@ -0,0 +1,353 @@
+/*
+ Copyright 2010, 2011 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ui/Application.h"
+#include "ui/Frame.h"
+#include "ui/GridLayout.h"
+#include "ui/HBoxLayout.h"
+#include "ui/ScrollArea.h"
+#include "ui/VBoxLayout.h"
+#include "Benchmark.h"
+#include <stdlib.h>
+#include <vector>
+
+using namespace ilixi;
+
+/*
+ * Measures layout engine on synthetic widget trees. For each tree, time of
+ * preferredSize() and tile() on root and of a full relayout after a single
+ * leaf changes its size are reported together with number of
+ * preferredSize() and heightForWidth() calls per operation.
+ *
+ * Usage: ilixi_bench_layout [iterations]
+ *
+ * Full relayout is leaf->doLayout(), i.e. what a widget does when its size
+ * changes, followed by updating every container's layout geometry top-down
+ * as it would happen during next paint.
+ */
+
+namespace
+{
+  long iterations = 100;
+  long preferredSizeCalls = 0;
+  long heightForWidthCalls = 0;
+
+  //! Leaf widget with a fixed preferred size and no drawing.
+  class Leaf : public Widget
+  {
+  public:
+    Leaf(int width, int height) :
+        Widget(), _preferred(width, height)
+    {
+      setConstraints(NoConstraint, NoConstraint);
+    }
+
+    virtual
+    ~Leaf()
+    {
+    }
+
+    virtual Size
+    preferredSize() const
+    {
+      preferredSizeCalls++;
+      return _preferred;
+    }
+
+    virtual int
+    heightForWidth(int width) const
+    {
+      heightForWidthCalls++;
+      if (width <= 0)
+        return -1;
+      return _preferred.width() * _preferred.height() / width;
+    }
+
+    void
+    setPreferred(int width, int height)
+    {
+      _preferred.setWidth(width);
+      _preferred.setHeight(height);
+      doLayout();
+    }
+
+  protected:
+    virtual void
+    compose(const Rectangle& rect)
+    {
+    }
+
+  private:
+    Size _preferred;
+  };
+
+  //! Layout which counts size queries.
+  template<class Base>
+    class Counted : public Base
+    {
+    public:
+      Counted() :
+          Base()
+      {
+      }
+
+      Counted(unsigned int rows, unsigned int columns) :
+          Base(rows, columns)
+      {
+      }
+
+      virtual Size
+      preferredSize() const
+      {
+        preferredSizeCalls++;
+        return Base::preferredSize();
+      }
+
+      virtual int
+      heightForWidth(int width) const
+      {
+        heightForWidthCalls++;
+        return Base::heightForWidth(width);
+      }
+    };
+
+  //! Frame which counts size queries and can update its layout geometry.
+  class CountedFrame : public Frame
+  {
+  public:
+    CountedFrame(LayoutBase* layout) :
+        Frame()
+    {
+      setLayout(layout);
+    }
+
+    virtual Size
+    preferredSize() const
+    {
+      preferredSizeCalls++;
+      return Frame::preferredSize();
+    }
+
+    virtual int
+    heightForWidth(int width) const
+    {
+      heightForWidthCalls++;
+      return Frame::heightForWidth(width);
+    }
+
+    void
+    relayout()
+    {
+      updateLayoutGeometry();
+      layout()->tile();
+    }
+  };
+
+  //! Synthetic widget tree.
+  struct Tree
+  {
+    Tree() :
+        root(NULL), scroll(NULL), content(NULL), leaf(NULL)
+    {
+    }
+
+    //! Root of tree.
+    ContainerBase* root;
+    //! Frames in top-down order.
+    std::vector<CountedFrame*> frames;
+    //! Set if tree is a scroll area.
+    ScrollArea* scroll;
+    //! Layout inside scroll area.
+    LayoutBase* content;
+    //! Leaf which changes its size during relayout.
+    Leaf* leaf;
+  };
+
+  void
+  buildBox(Tree& tree, bool horizontal, int count)
+  {
+    LayoutBase* box;
+    if (horizontal)
+      box = new Counted<HBoxLayout> ();
+    else
+      box = new Counted<VBoxLayout> ();
+    CountedFrame* frame = new CountedFrame(box);
+    for (int i = 0; i < count; ++i)
+      {
+        Leaf* leaf = new Leaf(20 + i % 7, 10 + i % 5);
+        box->addWidget(leaf);
+        if (i == count / 2)
+          tree.leaf = leaf;
+      }
+    tree.root = frame;
+    tree.frames.push_back(frame);
+  }
+
+  void
+  buildNested(Tree& tree, int depth)
+  {
+    CountedFrame* parent = NULL;
+    for (int i = 0; i < depth; ++i)
+      {
+        CountedFrame* frame = new CountedFrame(new Counted<VBoxLayout> ());
+        frame->addWidget(new Leaf(40, 10));
+        if (parent)
+          parent->addWidget(frame);
+        else
+          tree.root = frame;
+        tree.frames.push_back(frame);
+        parent = frame;
+      }
+    tree.leaf = new Leaf(40, 10);
+    parent->addWidget(tree.leaf);
+  }
+
+  void
+  buildGrid(Tree& tree, int rows, int columns)
+  {
+    Counted<GridLayout>* grid = new Counted<GridLayout> (rows, columns);
+    CountedFrame* frame = new CountedFrame(grid);
+    std::vector<bool> used(rows * columns, false);
+    for (int r = 0; r < rows; ++r)
+      for (int c = 0; c < columns; ++c)
+        {
+          if (used[r * columns + c])
+            continue;
+          // every tenth cell spans 2x2 cells.
+          int span = (r % 10 == 0 && c % 10 == 0 && r + 1 < rows && c + 1
+              < columns) ? 2 : 1;
+          for (int i = 0; i < span; ++i)
+            for (int j = 0; j < span; ++j)
+              used[(r + i) * columns + c + j] = true;
+          Leaf* leaf = new Leaf(10 * span, 10 * span);
+          grid->addWidget(leaf, r, c, span, span);
+          if (r == rows / 2 && c == columns / 2)
+            tree.leaf = leaf;
+        }
+    tree.root = frame;
+    tree.frames.push_back(frame);
+  }
+
+  void
+  buildScroll(Tree& tree, int count)
+  {
+    ScrollArea* scroll = new ScrollArea();
+    LayoutBase* box = new Counted<VBoxLayout> ();
+    scroll->setLayout(box);
+    for (int i = 0; i < count; ++i)
+      {
+        Leaf* leaf = new Leaf(200, 20 + i % 5);
+        box->addWidget(leaf);
+        if (i == count / 2)
+          tree.leaf = leaf;
+      }
+    tree.root = scroll;
+    tree.scroll = scroll;
+    tree.content = box;
+  }
+
+  void
+  relayout(Tree& tree)
+  {
+    for (unsigned int i = 0; i < tree.frames.size(); ++i)
+      tree.frames[i]->relayout();
+    if (tree.scroll)
+      {
+        tree.content->setGeometry(0, 0, tree.scroll->width(),
+            tree.content->preferredSize().height());
+        tree.content->tile();
+      }
+  }
+
+  void
+  report(const char* tree, const char* op, long n, long long nanos)
+  {
+    char name[128];
+    snprintf(name, sizeof(name), "%s/%s", tree, op);
+    benchReport(name, n, nanos, preferredSizeCalls / (double) n,
+        "preferredSize/op", heightForWidthCalls / (double) n,
+        "heightForWidth/op");
+  }
+
+  void
+  benchTree(const char* name, Tree& tree)
+  {
+    tree.root->setGeometry(0, 0, 800, 480);
+    relayout(tree);
+
+    preferredSizeCalls = heightForWidthCalls = 0;
+    long long start = benchNanos();
+    for (long i = 0; i < iterations; ++i)
+      tree.root->preferredSize();
+    report(name, "PreferredSize", iterations, benchNanos() - start);
+
+    preferredSizeCalls = heightForWidthCalls = 0;
+    start = benchNanos();
+    for (long i = 0; i < iterations; ++i)
+      tree.root->layout()->tile();
+    report(name, "Tile", iterations, benchNanos() - start);
+
+    preferredSizeCalls = heightForWidthCalls = 0;
+    start = benchNanos();
+    for (long i = 0; i < iterations; ++i)
+      {
+        tree.leaf->setPreferred(30 + i % 2 * 10, 10 + i % 2 * 5);
+        relayout(tree);
+      }
+    report(name, "LeafRelayout", iterations, benchNanos() - start);
+
+    delete tree.root;
+  }
+
+  void
+  run(int argc, char* argv[])
+  {
+    printf("# %ld iterations per result\n", iterations);
+
+    Tree hbox;
+    buildBox(hbox, true, 10000);
+    benchTree("FlatHBox10k", hbox);
+
+    Tree vbox;
+    buildBox(vbox, false, 10000);
+    benchTree("FlatVBox10k", vbox);
+
+    Tree nested;
+    buildNested(nested, 64);
+    benchTree("NestedFrames64", nested);
+
+    Tree grid;
+    buildGrid(grid, 100, 100);
+    benchTree("Grid100x100", grid);
+
+    Tree scroll;
+    buildScroll(scroll, 10000);
+    benchTree("ScrollArea10k", scroll);
+  }
+}
+
+int
+main(int argc, char* argv[])
+{
+  return benchMain(argc, argv, iterations, run);
+}
@@ -0,0 +1,294 @@
+/*
+ Copyright 2010, 2011 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "core/MessageRing.h"
+#include "Benchmark.h"
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <sched.h>
+#include <algorithm>
+#include <vector>
+
+using namespace ilixi;
+
+/*
+ * Compares delivering application messages to Maestro one kernel round-trip
+ * per message (as fusion_reactor_dispatch() does) with shared memory message
+ * rings and a single doorbell per batch. N producer processes send M messages
+ * each to one consumer. A pipe stands in for the reactor so that the
+ * benchmark runs without a Fusion world.
+ *
+ * Fallback mode sends like AppBase::callMaestro(): instead of waiting for a
+ * full ring, producers use the reactor until consumer acknowledges a fence,
+ * then return to the ring. It reports the share of messages sent over the
+ * reactor and the number of recoveries, and fails if messages of a producer
+ * are reordered.
+ */
+
+static const unsigned int ringCapacity = 32;
+
+enum Mode
+{
+  ReactorMode, RingMode, FallbackMode
+};
+
+static const char* modeNames[] =
+  { "Reactor", "Ring", "Fallback" };
+
+struct Shared
+{
+  int producers;
+  int messages;
+  // per message send time, indexed by producer * messages + sequence.
+  long long* sent;
+  MessageRing* rings[64];
+};
+
+static void
+produceReactor(Shared* shared, int producer, int fd)
+{
+  for (int i = 0; i < shared->messages; ++i)
+    {
+      ReactorMessage msg(producer, Notification, Ready, i);
+      shared->sent[producer * shared->messages + i] = benchNanos();
+      if (write(fd, &msg, sizeof(msg)) != sizeof(msg))
+        _exit(EXIT_FAILURE);
+    }
+}
+
+static void
+produceRing(Shared* shared, int producer, int fd)
+{
+  MessageRing* ring = shared->rings[producer];
+  char doorbell = producer;
+  bool notify;
+  for (int i = 0; i < shared->messages; ++i)
+    {
+      ReactorMessage msg(producer, Notification, Ready, i);
+      shared->sent[producer * shared->messages + i] = benchNanos();
+      while (!messageRingPush(ring, msg, &notify))
+        sched_yield();
+      if (notify && write(fd, &doorbell, 1) != 1)
+        _exit(EXIT_FAILURE);
+    }
+}
+
+static void
+sendReactor(int fd, const ReactorMessage& msg)
+{
+  if (write(fd, &msg, sizeof(msg)) != sizeof(msg))
+    _exit(EXIT_FAILURE);
+}
+
+static void
+produceFallback(Shared* shared, int producer, int fd)
+{
+  MessageRing* ring = shared->rings[producer];
+  bool overflowed = false;
+  unsigned int fence = 0;
+  bool notify;
+  for (int i = 0; i < shared->messages; ++i)
+    {
+      ReactorMessage msg(producer, Notification, Ready, i);
+      shared->sent[producer * shared->messages + i] = benchNanos();
+      if (overflowed && messageRingFenced(ring, fence))
+        overflowed = false;
+      bool queued = false;
+      notify = false;
+      if (!overflowed)
+        queued = messageRingPush(ring, msg, &notify);
+      if (notify)
+        sendReactor(fd, ReactorMessage(producer, RingDoorbell, None));
+      else if (!queued)
+        sendReactor(fd, msg);
+      if (!queued && !overflowed)
+        {
+          overflowed = true;
+          sendReactor(fd, ReactorMessage(producer, RingFence, None, ++fence));
+        }
+    }
+}
+
+static void
+consume(Shared* shared, const ReactorMessage& msg,
+    std::vector<long long>& latencies)
+{
+  long long now = benchNanos();
+  latencies.push_back(
+      now - shared->sent[msg.senderFusionID * shared->messages + msg.appID]);
+}
+
+static void
+drain(Shared* shared, MessageRing* ring, std::vector<long long>& latencies,
+    std::vector<int>& next)
+{
+  ReactorMessage msg(0, Notification, None);
+  do
+    {
+      while (messageRingPop(ring, &msg))
+        {
+          if ((int) msg.appID != next[msg.senderFusionID]++)
+            {
+              printf("# message of producer %u is out of order!\n",
+                  msg.senderFusionID);
+              exit(EXIT_FAILURE);
+            }
+          consume(shared, msg, latencies);
+        }
+    }
+  while (!messageRingRelease(ring));
+}
+
+static void
+run(Shared* shared, Mode mode)
+{
+  bool useRing = mode != ReactorMode;
+  int fds[2];
+  if (pipe(fds))
+    exit(EXIT_FAILURE);
+
+  int total = shared->producers * shared->messages;
+  std::vector<long long> latencies;
+  latencies.reserve(total);
+
+  long long start = benchNanos();
+  for (int p = 0; p < shared->producers; ++p)
+    {
+      if (useRing)
+        messageRingInit(shared->rings[p], ringCapacity);
+      if (fork() == 0)
+        {
+          close(fds[0]);
+          if (mode == FallbackMode)
+            produceFallback(shared, p, fds[1]);
+          else if (useRing)
+            produceRing(shared, p, fds[1]);
+          else
+            produceReactor(shared, p, fds[1]);
+          _exit(EXIT_SUCCESS);
+        }
+    }
+  close(fds[1]);
+
+  int wakeups = 0;
+  int fallbacks = 0;
+  int recoveries = 0;
+  std::vector<int> next(shared->producers, 0);
+  ReactorMessage msg(0, Notification, None);
+  while ((int) latencies.size() < total)
+    {
+      if (mode == RingMode)
+        {
+          char doorbell;
+          if (read(fds[0], &doorbell, 1) != 1)
+            break;
+          drain(shared, shared->rings[(int) doorbell], latencies, next);
+        }
+      else
+        {
+          if (read(fds[0], &msg, sizeof(msg)) != sizeof(msg))
+            break;
+          if (msg.type == RingDoorbell)
+            drain(shared, shared->rings[msg.senderFusionID], latencies, next);
+          else if (msg.type == RingFence)
+            {
+              MessageRing* ring = shared->rings[msg.senderFusionID];
+              drain(shared, ring, latencies, next);
+              messageRingAcknowledge(ring, msg.appID);
+              recoveries++;
+            }
+          else
+            {
+              if ((int) msg.appID != next[msg.senderFusionID]++)
+                {
+                  printf("# message of producer %u is out of order!\n",
+                      msg.senderFusionID);
+                  exit(EXIT_FAILURE);
+                }
+              consume(shared, msg, latencies);
+              if (useRing)
+                fallbacks++;
+            }
+        }
+      wakeups++;
+    }
+  long long elapsed = benchNanos() - start;
+  close(fds[0]);
+  while (wait(NULL) > 0)
+    ;
+
+  if ((int) latencies.size() < total)
+    {
+      printf("# consumer lost messages!\n");
+      exit(EXIT_FAILURE);
+    }
+
+  long long sum = 0;
+  for (unsigned int i = 0; i < latencies.size(); ++i)
+    sum += latencies[i];
+  std::vector<long long>::iterator p99 = latencies.begin() + (total * 99)
+      / 100;
+  std::nth_element(latencies.begin(), p99, latencies.end());
+
+  char name[64];
+  snprintf(name, sizeof(name), "%s/producers=%d", modeNames[mode],
+      shared->producers);
+  if (mode == FallbackMode)
+    benchReport(name, total, elapsed, 100.0 * fallbacks / total, "%reactor",
+        recoveries, "recoveries");
+  else
+    benchReport(name, total, elapsed, total / (double) wakeups, "msg/wakeup");
+  snprintf(name, sizeof(name), "%sLatency/producers=%d", modeNames[mode],
+      shared->producers);
+  benchReport(name, total, sum, *p99 / 1000.0, "p99-us");
+}
+
+int
+main(int argc, char* argv[])
+{
+  Shared shared;
+  shared.producers = argc > 1 ? atoi(argv[1]) : 4;
+  shared.messages = argc > 2 ? atoi(argv[2]) : 100000;
+  if (shared.producers < 1 || shared.producers > 64 || shared.messages < 1)
+    {
+      printf("Usage: %s [producers (1-64)] [messages per producer]\n", argv[0]);
+      return 1;
+    }
+
+  unsigned int ringSize = messageRingSize(ringCapacity);
+  size_t sentSize = sizeof(long long) * shared.producers * shared.messages;
+  char* memory = (char*) mmap(NULL, sentSize + shared.producers * ringSize,
+      PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (memory == MAP_FAILED)
+    return 1;
+  shared.sent = (long long*) memory;
+  for (int p = 0; p < shared.producers; ++p)
+    shared.rings[p] = (MessageRing*) (memory + sentSize + p * ringSize);
+
+  printf("# %d producers, %d messages each, ring capacity %u\n",
+      shared.producers, shared.messages, ringCapacity);
+  run(&shared, ReactorMode);
+  run(&shared, RingMode);
+  run(&shared, FallbackMode);
+  return 0;
+}
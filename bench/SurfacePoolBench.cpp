@@ -0,0 +1,122 @@
+/*
+ Copyright 2010, 2011 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "graphics/Surface.h"
+#include "graphics/SurfacePool.h"
+#include "Benchmark.h"
+#include <stdlib.h>
+
+using namespace ilixi;
+
+/*
+ * Measures surface pool hit rate for surfaces created the way
+ * Widget::updateSurface() creates HasOwnSurface widgets, i.e. single
+ * buffered at widget size.
+ *
+ * Usage: ilixi_bench_surfacepool [iterations]
+ *
+ * Resize grows and shrinks one surface a few pixels at a time, as a scroll
+ * area does while its window is resized. Reopen creates and deletes the
+ * surfaces of a dialog with several scroll areas.
+ */
+
+namespace
+{
+  long iterations = 100;
+
+  //! Sizes of scroll area layouts in reopened dialog.
+  const int dialogSizes[][2] =
+    {
+      { 320, 240 },
+      { 200, 400 },
+      { 480, 96 },
+      { 64, 300 } };
+  const int dialogSurfaces = sizeof(dialogSizes) / sizeof(dialogSizes[0]);
+
+  void
+  report(const char* name, long ops, long long nanos,
+      const SurfacePoolStats& before)
+  {
+    SurfacePoolStats after = surfacePoolStats();
+    unsigned int hits = after.hits - before.hits;
+    unsigned int misses = after.misses - before.misses;
+    benchReport(name, ops, nanos,
+        hits + misses ? 100.0 * hits / (hits + misses) : 0, "%hit",
+        after.idleBytes / 1024.0, "idle-KiB");
+  }
+
+  void
+  benchResize()
+  {
+    surfacePoolTrim(true);
+    SurfacePoolStats before = surfacePoolStats();
+    Surface* surface = new Surface();
+    long long start = benchNanos();
+    for (long i = 0; i < iterations; ++i)
+      {
+        // sweep width 300..340 and back in 2 pixel steps.
+        int step = i % 40;
+        int width = 300 + 2 * (step < 20 ? step : 40 - step);
+        surface->createDFBSurface(width, 200 + width / 4, false);
+      }
+    long long elapsed = benchNanos() - start;
+    delete surface;
+    report("Resize", iterations, elapsed, before);
+  }
+
+  void
+  benchReopen()
+  {
+    surfacePoolTrim(true);
+    SurfacePoolStats before = surfacePoolStats();
+    long long start = benchNanos();
+    for (long i = 0; i < iterations; ++i)
+      {
+        Surface* surfaces[dialogSurfaces];
+        for (int s = 0; s < dialogSurfaces; ++s)
+          {
+            surfaces[s] = new Surface();
+            surfaces[s]->createDFBSurface(dialogSizes[s][0],
+                dialogSizes[s][1], false);
+          }
+        for (int s = 0; s < dialogSurfaces; ++s)
+          delete surfaces[s];
+      }
+    long long elapsed = benchNanos() - start;
+    report("Reopen", iterations, elapsed, before);
+  }
+
+  void
+  run(int argc, char* argv[])
+  {
+    printf("# %ld iterations per result\n", iterations);
+    benchResize();
+    benchReopen();
+  }
+}
+
+int
+main(int argc, char* argv[])
+{
+  return benchMain(argc, argv, iterations, run);
+}
@@ -0,0 +1,110 @@
+/*
+ Copyright 2010, 2011 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "graphics/ColorConversion.h"
+#include "Benchmark.h"
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+using namespace ilixi;
+
+/*
+ * Measures YUV to ARGB conversion of a 1080p frame using the vectorised
+ * converter selected at compile time and the scalar reference. Results of
+ * both are compared to make sure they are identical.
+ */
+
+static const int frameWidth = 1920;
+static const int frameHeight = 1080;
+
+int
+main(int argc, char* argv[])
+{
+  int frames = argc > 1 ? atoi(argv[1]) : 100;
+  if (frames < 1)
+    frames = 1;
+
+  std::vector<unsigned char> i420(frameWidth * frameHeight * 3 / 2);
+  std::vector<unsigned char> uyvy(frameWidth * frameHeight * 2);
+  std::vector<unsigned char> argb(frameWidth * frameHeight * 4);
+  std::vector<unsigned char> reference(frameWidth * frameHeight * 4);
+
+  srand(1);
+  for (unsigned int i = 0; i < i420.size(); ++i)
+    i420[i] = rand();
+  for (unsigned int i = 0; i < uyvy.size(); ++i)
+    uyvy[i] = rand();
+
+  const unsigned char* y = &i420[0];
+  const unsigned char* u = y + frameWidth * frameHeight;
+  const unsigned char* v = u + frameWidth * frameHeight / 4;
+  double pixels = frameWidth * frameHeight;
+  long long start;
+
+  printf("# YUV to ARGB, %dx%d, %s\n", frameWidth, frameHeight,
+      colorConversionPath());
+
+  start = benchNanos();
+  for (int i = 0; i < frames; ++i)
+    convertI420ToARGB(y, frameWidth, u, v, frameWidth / 2, &argb[0],
+        frameWidth * 4, frameWidth, frameHeight);
+  long long simd = benchNanos() - start;
+  benchReport("I420", frames, simd, pixels * frames * 1000 / simd, "MPix/s");
+
+  start = benchNanos();
+  for (int i = 0; i < frames; ++i)
+    convertI420ToARGBScalar(y, frameWidth, u, v, frameWidth / 2,
+        &reference[0], frameWidth * 4, frameWidth, frameHeight);
+  long long scalar = benchNanos() - start;
+  benchReport("I420Scalar", frames, scalar, pixels * frames * 1000 / scalar,
+      "MPix/s");
+
+  if (memcmp(&argb[0], &reference[0], argb.size()))
+    {
+      printf("# I420 output differs from scalar reference!\n");
+      return 1;
+    }
+
+  start = benchNanos();
+  for (int i = 0; i < frames; ++i)
+    convertUYVYToARGB(&uyvy[0], frameWidth * 2, &argb[0], frameWidth * 4,
+        frameWidth, frameHeight);
+  simd = benchNanos() - start;
+  benchReport("UYVY", frames, simd, pixels * frames * 1000 / simd, "MPix/s");
+
+  start = benchNanos();
+  for (int i = 0; i < frames; ++i)
+    convertUYVYToARGBScalar(&uyvy[0], frameWidth * 2, &reference[0],
+        frameWidth * 4, frameWidth, frameHeight);
+  scalar = benchNanos() - start;
+  benchReport("UYVYScalar", frames, scalar, pixels * frames * 1000 / scalar,
+      "MPix/s");
+
+  if (memcmp(&argb[0], &reference[0], argb.size()))
+    {
+      printf("# UYVY output differs from scalar reference!\n");
+      return 1;
+    }
+  return 0;
+}
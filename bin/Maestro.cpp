@@ -23,6 +23,14 @@
 
 #include "core/IFusion.h"
 #include "core/Logger.h"
+#include "core/MessageRing.h"
+#include "core/AppIndex.h"
+#include "core/Clipboard.h"
+#include "core/OSKBuffer.h"
+#include "core/Zygote.h"
+#include "core/Startup.h"
+#include "core/Window.h"
+#include "graphics/TDesigner.h"
 #include <sys/stat.h>
 #include <spawn.h>
 #include <sys/wait.h>
@@ -58,6 +66,9 @@ struct Parameters
   int APP_VECTOR_SIZE;
   int OSK_SIZE;
   int CLIPBOARD_SIZE;
+  int MESSAGE_RING_SIZE;
+  // launch applications using zygote
+  bool ZYGOTE;
   // layer background
   bool BG_MODE_IMAGE;
   char BG_IMAGE[150];
@@ -109,7 +120,13 @@ DFBWindowID id;
 // DirectFB Event buffer of application window
 IDirectFBEventBuffer *buffer;
 
-AppRecord *currentApp = NULL;
+// FusionID of visible application, 0 if none
+unsigned int currentAppID = 0;
+
+// Pre-initialised process which forks applications
+Zygote zygote;
+// Designer which owns decoded theme images
+Designer* designer = NULL;
 
 bool
 initFusion(bool slaveMode = false);
@@ -123,6 +140,12 @@ initDFB(int argc, char **argv);
 void
 releaseDFB();
 
+void
+initTheme();
+
+void
+releaseTheme();
+
 void
 callApp(int channel, ReactorMessageType type, AppMode mode = Terminated);
 
@@ -132,6 +155,9 @@ notifyStatusBar(unsigned int AppIndex, AppMode mode = Terminated);
 void
 createFork(int argc, char **argv);
 
+pid_t
+spawnApp(char* path);
+
 int
 initArenaCB(FusionArena*, void*);
 
@@ -144,6 +170,12 @@ cleanArenaCB(FusionArena *arena, void *ctx, bool emergency);
 ReactionResult
 reactionCB(const void *msgData, void *ctx);
 
+ReactionResult
+handleMessage(ReactorMessage* msg);
+
+void
+drainRing(unsigned int fusionID, bool retired, unsigned int fence = 0);
+
 ReactionResult
 reaction2StatusBar(ReactorMessage* msg);
 
@@ -208,8 +240,62 @@ status()
           for (int i = 0; i < appCount; i++)
             {
               AppRecord *app = (AppRecord *) fusion_vector_at(appVector, i);
-              printf("%d\t%d\t%-20s\t%s\n", i, app->pid, app->title,
-                  (app->mode == Hidden) ? "Background" : "Foreground");
+              if (app->hibernated)
+                printf("%d\t%d\t%-20s\tHibernating (%u KB freed)\n", i,
+                    app->pid, app->title, app->hibernated / 1024);
+              else
+                printf("%d\t%d\t%-20s\t%s\n", i, app->pid, app->title,
+                    (app->mode == Hidden) ? "Background" : "Foreground");
+            }
+
+          // startup breakdown, phase durations and time to first frame.
+          printf("\nStartup (ms)\n#");
+          for (int p = 0; p < StartupPhaseCount; p++)
+            printf("%10s", startupPhaseName((StartupPhase) p));
+          printf("%8s%10s\n", "Images", "Frame");
+          printf(
+              "------------------------------------------------------------"
+                "--------------------------------\n");
+          for (int i = 0; i < appCount; i++)
+            {
+              AppRecord *app = (AppRecord *) fusion_vector_at(appVector, i);
+              printf("%d", i);
+              StartupRecord* record = app->startup;
+              if (!record)
+                {
+                  printf("\tnot available\n");
+                  continue;
+                }
+              for (int p = 0; p < StartupPhaseCount; p++)
+                {
+                  if (!record->end[p])
+                    printf("%10s", "-");
+                  else if (p == StartupImages)
+                    printf("%10.1f", record->imageTime / 1000.0);
+                  else
+                    printf("%10.1f", (record->end[p] - record->begin[p])
+                        / 1000.0);
+                }
+              printf("%8u", record->imageCount);
+              if (record->end[StartupFlip])
+                printf("%10.1f\n", record->end[StartupFlip] / 1000.0);
+              else
+                printf("%10s\n", "-");
+            }
+
+          // memory held by windows, cairo/pango/fonts are estimates.
+          printf("\nMemory (KB)\n#%10s%10s%10s%10s%10s%10s\n", "Pixels",
+              "Cairo", "Pango", "Images", "Fonts", "Total");
+          printf(
+              "------------------------------------------------------------"
+                "------\n");
+          for (int i = 0; i < appCount; i++)
+            {
+              AppRecord *app = (AppRecord *) fusion_vector_at(appVector, i);
+              const MemoryUsage& m = app->memory;
+              printf("%d%10u%10u%10u%10u%10u%10u\n", i, m.pixels / 1024,
+                  m.cairo / 1024, m.pango / 1024, m.images / 1024, m.fonts
+                      / 1024, m.total() / 1024);
             }
         }
       else
@@ -221,6 +307,112 @@ status()
   ILOG_CLOSE();
 }
 
+//*****************************************************************
+// Launches application and returns milliseconds until its first
+// flip, or a negative value on failure.
+//*****************************************************************
+double
+measureLaunch(char* path, bool useZygote)
+{
+  long long start = startupNow();
+  pid_t pid = -1;
+  if (useZygote)
+    pid = Zygote::launch(path);
+  else
+    {
+      char *arg[] =
+        { path, NULL };
+      if (posix_spawn(&pid, arg[0], NULL, NULL, arg, environ) != 0)
+        pid = -1;
+    }
+  if (pid <= 0)
+    return -1;
+
+  AppInfo app;
+  bool found = false;
+  double elapsed = -1;
+  for (int i = 0; i < 10000; i++)
+    {
+      found = appIndexFind(maestro->appIndex, path, &app);
+      if (found && app.firstFrame)
+        {
+          elapsed = (app.firstFrame - start) / 1000.0;
+          break;
+        }
+      usleep(1000);
+    }
+
+  if (found)
+    {
+      callApp(app.fusionID, SwitchMode, Terminated);
+      for (int i = 0; i < 10000; i++)
+        {
+          if (!appIndexFind(maestro->appIndex, path, &app))
+            break;
+          usleep(1000);
+        }
+    }
+  else
+    kill(pid, SIGTERM);
+  // zygote's children are reaped by zygote.
+  if (!useZygote)
+    waitpid(pid, NULL, 0);
+  return elapsed;
+}
+
+//*****************************************************************
+// Compares time to first frame of applications launched by zygote
+// and by posix_spawn.
+//*****************************************************************
+void
+launchTime(char* path, int runs)
+{
+  parseConfig();
+  if (!initFusion(true))
+    {
+      printf("Please start Maestro\n");
+      ILOG_CLOSE();
+      return;
+    }
+
+  AppInfo app;
+  if (appIndexFind(maestro->appIndex, path, &app))
+    printf("%s is already running, terminate it first.\n", path);
+  else
+    {
+      printf("Time to first frame of %s (ms)\n", path);
+      printf("%-12s%6s%10s%10s%10s\n", "Launch", "Runs", "Mean", "Min",
+          "Max");
+      printf("------------------------------------------------\n");
+      for (int method = 0; method < 2; method++)
+        {
+          double sum = 0, min = 0, max = 0;
+          int count = 0;
+          for (int i = 0; i < runs; i++)
+            {
+              double ms = measureLaunch(path, method == 0);
+              if (ms < 0)
+                continue;
+              sum += ms;
+              min = (count == 0 || ms < min) ? ms : min;
+              max = (ms > max) ? ms : max;
+              count++;
+            }
+          const char* name = method == 0 ? "Zygote" : "posix_spawn";
+          if (count)
+            printf("%-12s%6d%10.1f%10.1f%10.1f\n", name, count, sum / count,
+                min, max);
+          else
+            printf("%-12s%6d%10s%10s%10s\n", name, 0, "-", "-", "-");
+          if (!count && method == 0)
+            printf("Zygote is not running, set ZYGOTE = YES in maestro.conf"
+              " and restart Maestro.\n");
+        }
+    }
+  exitFusion(true);
+  ILOG_CLOSE();
+}
+
 //*****************************************************************
 // Connect to ilixi dfb-fusion world and create objects in shared
 // memory.
@@ -268,6 +460,11 @@ initFusion(bool slaveMode)
 
       if (master)
         {
+          if (!maestro->appIndex)
+            {
+              ILOG_FATAL("Unable to create AppIndex!");
+              return false;
+            }
           ILOG_DEBUG("Maestro-Master is setting up DFB-Reactor...");
           maestro->reactor = fusion_reactor_new(sizeof(ReactorMessage),
               "ilixiReactor", world);
@@ -351,14 +548,21 @@ initArenaCB(FusionArena *arena, void *ctx)
   maestro = (MaestroObject*) SHMALLOC(pool, sizeof(MaestroObject));
   fusion_arena_add_shared_field(arena, "MaestroObject", (void *) maestro);
   maestro->statusBarHeight = config.STATUSBAR_HEIGHT;
+  maestro->messageRingSize = config.MESSAGE_RING_SIZE;
+  maestro->retiredRings = NULL;
 
   maestro->pool = pool;
-  maestro->OSK = (char*) SHMALLOC(pool, sizeof(char) * config.OSK_SIZE);
-  sprintf(maestro->OSK, "ilixi OSK");
+  maestro->OSK = (OSKBuffer*) SHMALLOC(pool, oskBufferSize(config.OSK_SIZE));
+  oskBufferInit(maestro->OSK, config.OSK_SIZE);
+  oskBufferReset(maestro->OSK, "ilixi OSK", 9);
 
   appVector = (FusionVector*) SHMALLOC(pool, sizeof(FusionVector));
   fusion_arena_add_shared_field(arena, "AppVector", (void *) appVector);
   fusion_vector_init(appVector, config.APP_VECTOR_SIZE, pool);
+  maestro->appIndex = appIndexCreate(appVector, config.APP_VECTOR_SIZE, pool,
+      world);
+  maestro->clipboard = clipboardCreate(config.CLIPBOARD_SIZE, pool, world);
+  maestro->theme = NULL;
 
   ILOG_INFO("Maesto-Master initialised DFB-Arena!");
   return 0;
@@ -386,6 +590,15 @@ cleanArenaCB(FusionArena *arena, void *ctx, bool emergency)
   ILOG_DEBUG("Maestro-Master is cleaning DFB-Arena...");
   fusion_vector_destroy(appVector);
   SHFREE(pool, appVector);
+  while (maestro->retiredRings)
+    {
+      MessageRing* ring = maestro->retiredRings;
+      maestro->retiredRings = ring->next;
+      SHFREE(pool, ring);
+    }
+  appIndexDestroy(maestro->appIndex, pool);
+  if (maestro->clipboard)
+    clipboardDestroy(maestro->clipboard, pool);
   if (maestro->reactor)
     {
       fusion_reactor_destroy(maestro->reactor);
@@ -461,6 +674,41 @@ releaseDFB()
   ILOG_INFO("DFB interfaces are released.");
 }
 
+//*****************************************************************
+// Parse stylesheet and decode its images once, applications attach
+// to published theme instead of decoding their own copies.
+//*****************************************************************
+void
+initTheme()
+{
+  Window::setDFBInterface(dfb);
+  designer = new TDesigner(TDesigner::defaultStyle());
+  Theme* theme = (Theme*) SHMALLOC(pool, sizeof(Theme));
+  if (!theme)
+    {
+      ILOG_ERROR("Cannot allocate theme!");
+      return;
+    }
+  designer->exportTheme(theme);
+  maestro->theme = theme;
+}
+
+//*****************************************************************
+// Release theme and its shared surfaces.
+//*****************************************************************
+void
+releaseTheme()
+{
+  if (maestro->theme)
+    {
+      Theme* theme = maestro->theme;
+      maestro->theme = NULL;
+      SHFREE(pool, theme);
+    }
+  delete designer;
+  designer = NULL;
+}
+
 //*****************************************************************
 // Called when a dispatched message has been processed by all recipients.
 //*****************************************************************
@@ -483,6 +731,27 @@ ReactionResult
 reactionCB(const void *msgData, void *ctx)
 {
   ReactorMessage* msg = (ReactorMessage*) msgData;
+  if (msg->type == RingDoorbell)
+    {
+      drainRing(msg->senderFusionID, msg->mode == Terminated);
+      return RS_OK;
+    }
+  if (msg->type == RingFence)
+    {
+      // messages sent before fence are handled, application may use its
+      // ring again.
+      drainRing(msg->senderFusionID, false, msg->appID);
+      return RS_OK;
+    }
+  return handleMessage(msg);
+}
+
+//*****************************************************************
+// Forwards a message to its handler depending on sender.
+//*****************************************************************
+ReactionResult
+handleMessage(ReactorMessage* msg)
+{
   if (msg->senderFusionID == 2)
     return reaction2StatusBar(msg);
   else if (msg->senderFusionID == 3)
@@ -491,6 +760,46 @@ reactionCB(const void *msgData, void *ctx)
     return reaction2Application(msg);
 }
 
+//*****************************************************************
+// Handle all messages waiting in an application's message ring and
+// acknowledge fence if given.
+//*****************************************************************
+void
+drainRing(unsigned int fusionID, bool retired, unsigned int fence)
+{
+  // ring of an application which left arena is owned by Maestro, it is
+  // freed once its last doorbell (retired) is handled.
+  MessageRing* ring = messageRingTakeRetired(&maestro->retiredRings, fusionID);
+  bool owned = ring != NULL;
+  AppInfo app;
+  if (!ring && appIndexFind(maestro->appIndex, fusionID, &app))
+    ring = app.ring;
+  if (!ring)
+    {
+      ILOG_ERROR("ID: %d has no message ring!", fusionID);
+      return;
+    }
+
+  ReactorMessage msg(0, Notification, None);
+  do
+    {
+      while (messageRingPop(ring, &msg))
+        handleMessage(&msg);
+    }
+  while (!messageRingRelease(ring));
+  if (fence)
+    messageRingAcknowledge(ring, fence);
+
+  if (owned && retired)
+    SHFREE(pool, ring);
+  else if (owned)
+    messageRingRetire(&maestro->retiredRings, ring);
+
+  // application left arena, free its record once lookups are done.
+  if (retired)
+    appIndexReclaim(maestro->appIndex);
+}
+
 //*****************************************************************
 // Handle incoming messages from StatusBar.
 //*****************************************************************
@@ -526,8 +835,8 @@ reaction2StatusBar(ReactorMessage* msg)
         callApp(msg->appID, SwitchMode, Terminated);
       else if (msg->mode == Visible)
         {
-          if (currentApp)
-            callApp(currentApp->fusionID, SwitchMode, Hidden);
+          if (currentAppID)
+            callApp(currentAppID, SwitchMode, Hidden);
           callApp(msg->appID, SwitchMode, Visible);
         }
       else
@@ -585,9 +894,9 @@ reaction2OSK(ReactorMessage* msg)
     break;
 
   case OSKEvent:
-    ILOG_INFO("Received OSKEvent from OSK.");
-    if (currentApp)
-      callApp(currentApp->fusionID, OSKEvent, Ready);
+    ILOG_DEBUG("Received OSKEvent (%d) from OSK.", msg->mode);
+    if (currentAppID)
+      callApp(currentAppID, OSKEvent, msg->mode);
     break;
 
   default:
@@ -604,25 +913,26 @@ ReactionResult
 reaction2Application(ReactorMessage* msg)
 {
 
-  AppRecord* app;
-  for (int i = 0; i < appVector->count; i++)
+  AppInfo app;
+  bool registered = appIndexFind(maestro->appIndex, msg->appID, &app);
+  // Terminated notification may be drained after application left arena.
+  if (!registered && !(msg->type == Notification && msg->mode == Terminated))
     {
-      AppRecord* record = (AppRecord *) fusion_vector_at(appVector, i);
-      if (record->fusionID == msg->appID)
-        app = record;
+      ILOG_ERROR("ID: %d is not a registered application!", msg->appID);
+      return RS_DROP;
     }
 
   switch (msg->type)
     {
   case ModeRequest:
     {
-      ILOG_INFO("Received ModeRequest from %s (ID: %d).", app->title, msg->senderFusionID);
+      ILOG_INFO("Received ModeRequest from %s (ID: %d).", app.title, msg->senderFusionID);
       switch (msg->mode)
         {
       case Visible:
         // if there is a visible app hide it.
-        if (currentApp)
-          callApp(currentApp->fusionID, SwitchMode, Hidden);
+        if (currentAppID)
+          callApp(currentAppID, SwitchMode, Hidden);
 
         callApp(msg->senderFusionID, SwitchMode, Visible);
         return RS_OK;
@@ -659,17 +969,17 @@ reaction2Application(ReactorMessage* msg)
         return RS_OK;
 
       case Ready:
-        ILOG_INFO( "%s (ID: %d) is ready.", app->title, msg->senderFusionID);
+        ILOG_INFO( "%s (ID: %d) is ready.", app.title, msg->senderFusionID);
         return RS_OK;
 
       case Visible:
         ILOG_INFO( "ID: %d is visible.", msg->senderFusionID);
-        currentApp = app;
-        notifyStatusBar(currentApp->fusionID, Visible);
+        currentAppID = app.fusionID;
+        notifyStatusBar(currentAppID, Visible);
         return RS_OK;
 
       case Hidden:
-        ILOG_INFO( "%s (ID: %d) is hidden.", app->title, msg->senderFusionID);
+        ILOG_INFO( "%s (ID: %d) is hidden.", app.title, msg->senderFusionID);
         return RS_OK;
 
       case Terminated:
@@ -679,7 +989,7 @@ reaction2Application(ReactorMessage* msg)
           if (appVector->count >= 2 && msg->senderFusionID != 4)
             callApp(4, SwitchMode, Visible);
           else
-            currentApp = NULL;
+            currentAppID = 0;
           return RS_OK;
         }
       default:
@@ -778,10 +1088,19 @@ createFork(int argc, char **argv)
       //      close( STDOUT_FILENO);
       //      close( STDERR_FILENO);
 
+      // zygote must not inherit fusion or DirectFB connections. StatusBar
+      // is not preloaded, it is spawned as Maestro's child so that Maestro
+      // can wait for it.
+      char* preload[] =
+        { config.OSK, config.HOME, NULL };
+      if (config.ZYGOTE)
+        zygote.start(preload);
+
       if (initFusion())
         {
 
           initDFB(argc, argv);
+          initTheme();
           ILOG_NOTICE("Maestro (pid: %d) is running now!", getpid());
 
           int err;
@@ -800,27 +1119,15 @@ createFork(int argc, char **argv)
           while (fusion_vector_size(appVector) < 1)
             sleep(1);
 
-          char *oskArg[] =
-            { config.OSK, NULL };
-          if ((err = posix_spawn(&osk_id, oskArg[0], NULL, NULL, oskArg,
-              environ)) != 0)
-            {
-              ILOG_ERROR("posix_spawn() error: %d", err);
-              exit(EXIT_FAILURE);
-            }
+          if ((osk_id = spawnApp(config.OSK)) < 0)
+            exit(EXIT_FAILURE);
           ILOG_DEBUG("OSK (%d) is running...", osk_id);
 
           while (fusion_vector_size(appVector) < 2)
             sleep(1);
 
-          char *homeArg[] =
-            { config.HOME, NULL };
-          if ((err = posix_spawn(&home_id, homeArg[0], NULL, NULL, homeArg,
-              environ)) != 0)
-            {
-              ILOG_ERROR("posix_spawn() error: %d", err);
-              exit(EXIT_FAILURE);
-            }
+          if ((home_id = spawnApp(config.HOME)) < 0)
+            exit(EXIT_FAILURE);
           ILOG_DEBUG("Home (%d) is running...", home_id);
 
           int childExitStatus;
@@ -838,8 +1145,10 @@ createFork(int argc, char **argv)
           while (fusion_vector_has_elements(appVector))
             sleep(1);
 
+          releaseTheme();
           releaseDFB();
           exitFusion();
+          zygote.stop();
           ILOG_NOTICE("Maestro ends.");
         }
       else
@@ -848,6 +1157,27 @@ createFork(int argc, char **argv)
     }
 }
 
+//*****************************************************************
+// Launch application using zygote, fall back to posix_spawn.
+//*****************************************************************
+pid_t
+spawnApp(char* path)
+{
+  pid_t id = Zygote::launch(path);
+  if (id > 0)
+    return id;
+
+  int err;
+  char *arg[] =
+    { path, NULL };
+  if ((err = posix_spawn(&id, arg[0], NULL, NULL, arg, environ)) != 0)
+    {
+      ILOG_ERROR("posix_spawn() error: %d", err);
+      return -1;
+    }
+  return id;
+}
+
 void
 parseConfig()
 {
@@ -857,6 +1187,8 @@ parseConfig()
   config.APP_VECTOR_SIZE = 10;
   config.OSK_SIZE = 10;
   config.CLIPBOARD_SIZE = 10;
+  config.MESSAGE_RING_SIZE = 32;
+  config.ZYGOTE = false;
   config.BG_MODE_IMAGE = false;
   sprintf(config.BG_IMAGE, "");
   config.BG_COLOR_R = 0;
@@ -896,6 +1228,10 @@ parseConfig()
             config.OSK_SIZE = atoi(value);
           else if (strcmp(tag, "CLIPBOARD_SIZE") == 0)
             config.CLIPBOARD_SIZE = atoi(value);
+          else if (strcmp(tag, "MESSAGE_RING_SIZE") == 0)
+            config.MESSAGE_RING_SIZE = atoi(value);
+          else if (strcmp(tag, "ZYGOTE") == 0)
+            config.ZYGOTE = strcmp(value, "YES") == 0;
 
           else if (strcmp(tag, "BACKGROUND_MODE") == 0)
             {
@@ -939,7 +1275,11 @@ printUsage()
   printf("      --stop                               Stops Maestro\n");
   printf("      --restart                            Restarts Maestro\n");
   printf(
-      "      --status                             List running applications\n");
+      "      --status                             List running applications,\n"
+        "                                           their startup times and memory\n");
+  printf(
+      "      --launch-time <Path> [Runs]          Compares time to first frame\n"
+        "                                           using zygote and posix_spawn\n");
   printf(
       "      --install <Path> <Title> <IconPath>  Adds an application to Home\n");
   printf(
@@ -972,6 +1312,8 @@ main(int argc, char **argv)
         }
       else if (strcmp(argv[1], "--status") == 0)
         status();
+      else if (!strcmp(argv[1], "--launch-time") && argc >= 3)
+        launchTime(argv[2], argc >= 4 ? atoi(argv[3]) : 10);
       else if (!strcmp(argv[1], "--install") && argc >= 4)
         {
           if (access(argv[2], F_OK) != 0)
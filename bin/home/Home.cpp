@@ -29,6 +29,7 @@
 #include <sigc++/bind.h>
 #include <sqlite3.h>
 #include "core/Logger.h"
+#include "core/Zygote.h"
 
 using namespace ilixi;
 
@@ -119,15 +120,19 @@ Home::~Home()
 void
 Home::spawnApp(int index)
 {
-  AppRecord* app = getAppRecord(_apps[index].basename);
-  if (app)
+  AppInfo app;
+  if (getAppRecord(_apps[index].basename, &app))
     {
-      callMaestro(SwitchMode, Visible, app->fusionID);
+      callMaestro(SwitchMode, Visible, app.fusionID);
       hide(); // NOTE Home hides itself.
       return;
     }
 
-  // if app is not running spawn it.
+  // if app is not running, ask Maestro's zygote to fork it.
+  if (Zygote::launch(_apps[index].basename.c_str()) > 0)
+    return;
+
+  // otherwise spawn it.
   char* path = const_cast<char*> (_apps[index].basename.c_str());
   char *arg[] =
     { path, NULL };
@@ -179,10 +184,17 @@ Home::parseApps()
   sqlite3_close(db);
 }
 
-int
-main(int argc, char* argv[])
+// Entry point used by Zygote, see ilixi_home module.
+extern "C" int
+ilixi_main(int argc, char* argv[])
 {
   Home app(argc, argv);
   app.exec();
   return 0;
 }
+
+int
+main(int argc, char* argv[])
+{
+  return ilixi_main(argc, argv);
+}
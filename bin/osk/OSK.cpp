@@ -109,6 +109,8 @@ OSK::OSK(int argc, char* argv[]) :
 {
   setTitle("OSK");
   setBackgroundFilled(true);
+  // OSK is shown frequently, keep its surfaces while hidden.
+  setHibernation(false);
   deFont->setWeight(PANGO_WEIGHT_BOLD);
 
   setLayout(new VBoxLayout());
@@ -117,6 +119,8 @@ OSK::OSK(int argc, char* argv[]) :
   addWidget(_input);
 
   OSKButton::_target = _input;
+  _input->sigTextInserted.connect(sigc::mem_fun(this, &OSK::textInserted));
+  _input->sigTextErased.connect(sigc::mem_fun(this, &OSK::textErased));
 
   createKeys();
 }
@@ -128,6 +132,13 @@ OSK::~OSK()
 ReactionResult
 OSK::reactorCB(ReactorMessage *msg, void *ctx)
 {
+  // clipboard changes are broadcast by the application which copied.
+  if (msg->type == ClipboardChanged)
+    {
+      onClipboardChanged(msg->appID);
+      return RS_OK;
+    }
+
   if (msg->senderFusionID != 1)
     {
       ILOG_ERROR("Sender is not authorised!");
@@ -471,11 +482,24 @@ OSK::createKeys()
 void
 OSK::done()
 {
-  setOSKText(_input->text());
   callMaestro(OSKEvent, Ready);
   hide(Slide, getStatusBarHeight(), _layerConfig.height);
 }
 
+void
+OSK::textInserted(int index, std::string text)
+{
+  insertOSKText(index, text);
+  callMaestro(OSKEvent, Visible);
+}
+
+void
+OSK::textErased(int index, int length)
+{
+  eraseOSKText(index, length);
+  callMaestro(OSKEvent, Visible);
+}
+
 void
 OSK::compose(const Rectangle& rect)
 {
@@ -486,10 +510,17 @@ OSK::compose(const Rectangle& rect)
   painter.end();
 }
 
-int
-main(int argc, char* argv[])
+// Entry point used by Zygote, see ilixi_osk module.
+extern "C" int
+ilixi_main(int argc, char* argv[])
 {
   OSK app(argc, argv);
   app.exec();
   return 0;
 }
+
+int
+main(int argc, char* argv[])
+{
+  return ilixi_main(argc, argv);
+}
@@ -124,6 +124,12 @@ private:
   void
   done();
 
+  void
+  textInserted(int index, std::string text);
+
+  void
+  textErased(int index, int length);
+
   void
   compose(const Rectangle& rect);
 
@@ -75,6 +75,8 @@ TextInput::cursorIndex() const
 void
 TextInput::clear()
 {
+  if (!_text.empty())
+    sigTextErased(0, _text.length());
   _text = "";
   pango_layout_set_text(_layout, _text.c_str(), _text.length());
   _selection.setSize(0, 0);
@@ -105,7 +107,7 @@ TextInput::pointerButtonDownEvent(const PointerEvent& mouseEvent)
   Point p = mapToSurface(Point(mouseEvent.x, mouseEvent.y));
   p -= _layoutPosition;
   int index = 0;
-  bool rc = pango_layout_xy_to_index(_layout, p.x() * PANGO_SCALE,
+  bool rc = pango_layout_xy_to_index(layout(), p.x() * PANGO_SCALE,
       p.y() * PANGO_SCALE, &index, NULL);
 
   // fix last character
@@ -141,7 +143,7 @@ TextInput::pointerMotionEvent(const PointerEvent& mouseEvent)
       int index = 0;
       Point p = mapToSurface(Point(mouseEvent.x, mouseEvent.y));
       p -= _layoutPosition;
-      bool rc = pango_layout_xy_to_index(_layout, p.x() * PANGO_SCALE,
+      bool rc = pango_layout_xy_to_index(layout(), p.x() * PANGO_SCALE,
           p.y() * PANGO_SCALE, &index, NULL);
 
       // fix last character
@@ -180,6 +182,8 @@ TextInput::keyUpEvent(const KeyEvent& keyEvent)
       if (_selection.isNull())
         {
           _text.insert(_cursorIndex, 1, (char) keyEvent.keySymbol);
+          sigTextInserted(_cursorIndex,
+              std::string(1, (char) keyEvent.keySymbol));
           sigCursorMoved(_cursorIndex, ++_cursorIndex);
         }
       else
@@ -187,6 +191,8 @@ TextInput::keyUpEvent(const KeyEvent& keyEvent)
           int pos1 = std::min(_selectedIndex, _cursorIndex);
           int n1 = abs(_selectedIndex - _cursorIndex);
           _text.replace(pos1, n1, 1, (char) keyEvent.keySymbol);
+          sigTextErased(pos1, n1);
+          sigTextInserted(pos1, std::string(1, (char) keyEvent.keySymbol));
           _selection.setSize(0, 0);
           sigCursorMoved(_cursorIndex, pos1 + 1);
           _cursorIndex = pos1 + 1;
@@ -235,6 +241,7 @@ TextInput::keyUpEvent(const KeyEvent& keyEvent)
     if (_cursorIndex < _text.length())
       {
         _text.erase(_cursorIndex, 1);
+        sigTextErased(_cursorIndex, 1);
         pango_layout_set_text(_layout, _text.c_str(), _text.length());
         update();
       }
@@ -247,6 +254,7 @@ TextInput::keyUpEvent(const KeyEvent& keyEvent)
           {
             sigCursorMoved(_cursorIndex, --_cursorIndex);
             _text.erase(_cursorIndex, 1);
+            sigTextErased(_cursorIndex, 1);
           }
       }
     else
@@ -254,6 +262,7 @@ TextInput::keyUpEvent(const KeyEvent& keyEvent)
         int pos1 = std::min(_selectedIndex, _cursorIndex);
         int n1 = abs(_selectedIndex - _cursorIndex);
         _text.erase(pos1, n1);
+        sigTextErased(pos1, n1);
         _selection.setSize(0, 0);
         sigSelectionChanged();
         sigCursorMoved(_cursorIndex, pos1);
@@ -304,7 +313,7 @@ void
 TextInput::updateCursorPosition()
 {
   PangoRectangle weak;
-  pango_layout_get_cursor_pos(_layout, _cursorIndex, NULL, &weak);
+  pango_layout_get_cursor_pos(layout(), _cursorIndex, NULL, &weak);
   _cursor.moveTo(weak.x / PANGO_SCALE + _layoutPosition.x(),
       weak.y + _layoutPosition.y());
   if (_cursor.x() > _layoutPosition.x() + textLayoutWidth())
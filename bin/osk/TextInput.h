@@ -65,6 +65,10 @@ namespace ilixi
 
     sigc::signal<void, int, int> sigCursorMoved;
     sigc::signal<void> sigSelectionChanged;
+    //! Emitted with byte index and text as user inserts text.
+    sigc::signal<void, int, std::string> sigTextInserted;
+    //! Emitted with byte index and length as user erases text.
+    sigc::signal<void, int, int> sigTextErased;
 
   protected:
     virtual void
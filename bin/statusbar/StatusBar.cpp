@@ -161,6 +161,13 @@ StatusBar::updateTime()
 ReactionResult
 StatusBar::reactorCB(ReactorMessage *msg, void *ctx)
 {
+  // clipboard changes are broadcast by the application which copied.
+  if (msg->type == ClipboardChanged)
+    {
+      onClipboardChanged(msg->appID);
+      return RS_OK;
+    }
+
   if (msg->senderFusionID != 1)
     {
       ILOG_ERROR("Sender is not authorised!");
@@ -194,10 +201,15 @@ StatusBar::reactorCB(ReactorMessage *msg, void *ctx)
 
     if (msg->mode == Visible)
       {
-        AppRecord* app = getAppRecord(msg->appID);
+        AppInfo app;
+        if (!getAppRecord(msg->appID, &app))
+          {
+            ILOG_ERROR("ID: %d is not a registered application!", msg->appID);
+            break;
+          }
         _currentAppID = msg->appID;
-        _app->setText((std::string) app->title);
-        ILOG_INFO("%s (ID: %d) is visible.", app->title, app->fusionID);
+        _app->setText((std::string) app.title);
+        ILOG_INFO("%s (ID: %d) is visible.", app.title, app.fusionID);
 
         if (_currentAppID == 4) // Notification comes from Home app.
 
@@ -209,7 +221,7 @@ StatusBar::reactorCB(ReactorMessage *msg, void *ctx)
           {
             _home->setEnabled();
             _sDialog->setKillVisibility(true);
-            _sDialog->setAppName((std::string) app->title);
+            _sDialog->setAppName((std::string) app.title);
           }
       }
     break;
@@ -261,10 +273,17 @@ StatusBar::showHome()
   callMaestro(SwitchMode, Visible, 4);
 }
 
-int
-main(int argc, char* argv[])
+// Entry point used by Zygote, see ilixi_statusbar module.
+extern "C" int
+ilixi_main(int argc, char* argv[])
 {
   StatusBar app(argc, argv);
   app.exec();
   return 0;
 }
+
+int
+main(int argc, char* argv[])
+{
+  return ilixi_main(argc, argv);
+}
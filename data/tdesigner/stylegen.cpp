@@ -0,0 +1,358 @@
+/*
+ Copyright 2010, 2011 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Compiles a stylesheet into static tables which are loaded by
+ * Designer(const StyleTable&) without parsing XML at runtime.
+ *
+ * Usage: stylegen <stylesheet.xml> <name> <directory>
+ *
+ * The generated header is written to stdout. Images are loaded at runtime
+ * from ILIXI_DATADIR/<directory>.
+ */
+
+#include <libxml/parser.h>
+#include <libxml/tree.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <libgen.h>
+#include <string>
+
+// Hint element names which do not match WidgetHint prefixes.
+static const char* hintAliases[][2] =
+  {
+    { "Frame", "FrameBorder" },
+    { "RadioButton", "Radio" },
+    { "TextInput", "TextInputFrame" },
+    { NULL, NULL } };
+
+// Image names which do not match ThemeImageType suffixes.
+static const char* imageAliases[][2] =
+  {
+    { "Critical", "DialogCritical" },
+    { "Information", "DialogInfo" },
+    { "Question", "DialogQuestion" },
+    { "Warning", "DialogWarning" },
+    { "Plus", "PlusSign" },
+    { "Minus", "MinusSign" },
+    { NULL, NULL } };
+
+static const char* groups[] =
+  { "default", "exposed", "pressed", "disabled", NULL };
+
+static const char* fonts[] =
+  { "Default", "Button", "Title", "Input", NULL };
+
+static int errors = 0;
+
+static std::string
+prop(xmlNodePtr node, const char* name)
+{
+  xmlChar* value = xmlGetProp(node, (const xmlChar*) name);
+  if (!value)
+    return "";
+  std::string ret((char*) value);
+  xmlFree(value);
+  return ret;
+}
+
+static bool
+isIdentifier(const std::string& s)
+{
+  if (s.empty() || isdigit(s[0]))
+    return false;
+  for (unsigned int i = 0; i < s.length(); i++)
+    if (!isalnum(s[i]) && s[i] != '_')
+      return false;
+  return true;
+}
+
+static bool
+isNumber(const std::string& s)
+{
+  if (s.empty())
+    return false;
+  for (unsigned int i = (s[0] == '-') ? 1 : 0; i < s.length(); i++)
+    if (!isdigit(s[i]))
+      return false;
+  return true;
+}
+
+static const char*
+alias(const char* table[][2], const std::string& name)
+{
+  for (int i = 0; table[i][0]; i++)
+    if (name == table[i][0])
+      return table[i][1];
+  return name.c_str();
+}
+
+static bool
+contains(const char* list[], const std::string& name)
+{
+  for (int i = 0; list[i]; i++)
+    if (name == list[i])
+      return true;
+  return false;
+}
+
+static void
+error(xmlNodePtr node, const char* message, const std::string& value)
+{
+  fprintf(stderr, "stylegen: line %ld: %s \"%s\"\n", xmlGetLineNo(node),
+      message, value.c_str());
+  errors++;
+}
+
+static int
+component(xmlNodePtr node, const char* name, int value)
+{
+  std::string s = prop(node, name);
+  if (s.empty())
+    return value;
+  if (!isNumber(s) || atoi(s.c_str()) < 0 || atoi(s.c_str()) > 255)
+    {
+      error(node, "Invalid colour component", s);
+      return value;
+    }
+  return atoi(s.c_str());
+}
+
+static void
+writePalette(xmlNodePtr palette, const char* name)
+{
+  printf("  static const StyleColor %sColors[] =\n    {\n", name);
+  for (xmlNodePtr group = palette->children; group; group = group->next)
+    {
+      if (xmlStrcmp(group->name, (const xmlChar*) "group"))
+        continue;
+      std::string groupName = prop(group, "name");
+      bool application = (groupName == "application");
+      if (!application && !contains(groups, groupName))
+        {
+          error(group, "Unknown colour group", groupName);
+          continue;
+        }
+
+      for (xmlNodePtr color = group->children; color; color = color->next)
+        {
+          std::string target = prop(color, "target");
+          if (target.empty())
+            continue;
+          if (!isIdentifier(target))
+            {
+              error(color, "Invalid colour target", target);
+              continue;
+            }
+          if (application)
+            printf("      { 0, 0, &Palette::%s, ", target.c_str());
+          else
+            printf("      { &Palette::_%s, &ColorGroup::%s, 0, ",
+                groupName.c_str(), target.c_str());
+          printf("%d, %d, %d, %d },\n", component(color, "red", 0),
+              component(color, "green", 0), component(color, "blue", 0),
+              component(color, "alpha", 255));
+        }
+    }
+  printf("      { 0, 0, 0, 0, 0, 0, 0 } };\n\n");
+}
+
+static void
+writeFonts(xmlNodePtr node, const char* name)
+{
+  printf("  static const StyleFont %sFonts[] =\n    {\n", name);
+  for (xmlNodePtr font = node->children; font; font = font->next)
+    {
+      if (xmlStrcmp(font->name, (const xmlChar*) "font"))
+        continue;
+      std::string fontName = prop(font, "name");
+      std::string family = prop(font, "family");
+      std::string size = prop(font, "size");
+      std::string weight = prop(font, "weight");
+      if (!contains(fonts, fontName))
+        error(font, "Unknown font", fontName);
+      else if (family.empty() || family.find_first_of("\"\\") != std::string::npos)
+        error(font, "Invalid font family", family);
+      else if (!isNumber(size))
+        error(font, "Invalid font size", size);
+      else if (!weight.empty() && !isIdentifier(weight))
+        error(font, "Invalid font weight", weight);
+      else
+        {
+          for (unsigned int i = 0; i < weight.length(); i++)
+            weight[i] = toupper(weight[i]);
+          printf("      { %sFont, \"%s\", %s, PANGO_WEIGHT_%s },\n",
+              fontName.c_str(), family.c_str(), size.c_str(),
+              weight.empty() ? "MEDIUM" : weight.c_str());
+        }
+    }
+  printf("      { DefaultFont, 0, 0, PANGO_WEIGHT_MEDIUM } };\n\n");
+}
+
+static void
+writeHints(xmlNodePtr node, const char* name)
+{
+  printf("  static const StyleHint %sHints[] =\n    {\n", name);
+  for (xmlNodePtr hint = node->children; hint; hint = hint->next)
+    {
+      if (xmlStrcmp(hint->name, (const xmlChar*) "hint"))
+        continue;
+      std::string hintName = prop(hint, "name");
+      if (!isIdentifier(hintName))
+        {
+          error(hint, "Invalid hint name", hintName);
+          continue;
+        }
+      std::string prefix = alias(hintAliases, hintName);
+      for (xmlAttrPtr attr = hint->properties; attr; attr = attr->next)
+        {
+          std::string attrName((const char*) attr->name);
+          if (attrName == "name")
+            continue;
+          std::string value = prop(hint, attrName.c_str());
+          if (!isIdentifier(attrName) || !isNumber(value))
+            {
+              error(hint, "Invalid hint", attrName + "=" + value);
+              continue;
+            }
+          attrName[0] = toupper(attrName[0]);
+          printf("      { %s%s, %s },\n", prefix.c_str(), attrName.c_str(),
+              value.c_str());
+        }
+    }
+  printf("      { BorderWidth, 0 } };\n\n");
+}
+
+static void
+writeImages(xmlNodePtr node, const char* name)
+{
+  printf("  static const StyleImage %sImages[] =\n    {\n", name);
+  for (xmlNodePtr image = node->children; image; image = image->next)
+    {
+      if (xmlStrcmp(image->name, (const xmlChar*) "image"))
+        continue;
+      std::string imageName = prop(image, "name");
+      std::string path = prop(image, "path");
+      if (!isIdentifier(imageName))
+        error(image, "Invalid image name", imageName);
+      else if (path.empty() || path.find_first_of("\"\\") != std::string::npos)
+        error(image, "Invalid image path", path);
+      else
+        printf("      { Theme%s, \"%s\" },\n", alias(imageAliases, imageName),
+            path.c_str());
+    }
+  printf("      { ThemeImageCount, 0 } };\n\n");
+}
+
+int
+main(int argc, char* argv[])
+{
+  if (argc != 4)
+    {
+      fprintf(stderr, "Usage: %s <stylesheet.xml> <name> <directory>\n",
+          argv[0]);
+      return EXIT_FAILURE;
+    }
+
+  const char* name = argv[2];
+  std::string directory = argv[3];
+  if (!isIdentifier(name) || directory.find_first_of("\"\\")
+      != std::string::npos)
+    {
+      fprintf(stderr, "stylegen: invalid name or directory\n");
+      return EXIT_FAILURE;
+    }
+
+  xmlDocPtr doc = xmlParseFile(argv[1]);
+  if (!doc)
+    {
+      fprintf(stderr, "stylegen: %s is not parsed successfully\n", argv[1]);
+      return EXIT_FAILURE;
+    }
+
+  xmlNodePtr root = xmlDocGetRootElement(doc);
+  if (!root || xmlStrcmp(root->name, (const xmlChar*) "style"))
+    {
+      fprintf(stderr, "stylegen: %s is not a valid style file\n", argv[1]);
+      xmlFreeDoc(doc);
+      return EXIT_FAILURE;
+    }
+
+  std::string guard = std::string("ILIXI_") + name + "_STYLE_H_";
+  for (unsigned int i = 0; i < guard.length(); i++)
+    guard[i] = toupper(guard[i]);
+
+  printf("/* Generated by stylegen from %s, do not edit. */\n\n",
+      basename(argv[1]));
+  printf("#ifndef %s\n#define %s\n\n", guard.c_str(), guard.c_str());
+  printf("#include \"ilixiConfig.h\"\n#include \"graphics/StyleTable.h\"\n\n");
+  printf("namespace ilixi\n{\n");
+
+  bool sections[4] =
+    { false, false, false, false };
+  for (xmlNodePtr cur = root->children; cur; cur = cur->next)
+    {
+      if (!xmlStrcmp(cur->name, (const xmlChar*) "palette"))
+        {
+          writePalette(cur, name);
+          sections[0] = true;
+        }
+      else if (!xmlStrcmp(cur->name, (const xmlChar*) "fonts"))
+        {
+          writeFonts(cur, name);
+          sections[1] = true;
+        }
+      else if (!xmlStrcmp(cur->name, (const xmlChar*) "hints"))
+        {
+          writeHints(cur, name);
+          sections[2] = true;
+        }
+      else if (!xmlStrcmp(cur->name, (const xmlChar*) "images"))
+        {
+          writeImages(cur, name);
+          sections[3] = true;
+        }
+    }
+  xmlFreeDoc(doc);
+
+  if (!(sections[0] && sections[1] && sections[2] && sections[3]))
+    {
+      fprintf(stderr,
+          "stylegen: palette, fonts, hints and images are required\n");
+      return EXIT_FAILURE;
+    }
+
+  // last entry of each table is a terminator and is not counted.
+  printf("  static const StyleTable %sStyle =\n    { ILIXI_DATADIR\"%s\", "
+    "\"%s\",\n", name, directory.c_str(), basename(argv[1]));
+  const char* tables[] =
+    { "Colors", "Fonts", "Hints", "Images" };
+  for (int i = 0; i < 4; i++)
+    printf("        %s%s, sizeof(%s%s) / sizeof(%s%s[0]) - 1%s\n", name,
+        tables[i], name, tables[i], name, tables[i], i < 3 ? "," : " };");
+  printf("}\n\n#endif /* %s */\n", guard.c_str());
+
+  return errors ? EXIT_FAILURE : EXIT_SUCCESS;
+}
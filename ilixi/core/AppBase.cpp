@@ -23,6 +23,12 @@
 
 #include "AppBase.h"
 #include "core/Logger.h"
+#include "core/MessageRing.h"
+#include "core/AppIndex.h"
+#include "core/Clipboard.h"
+#include "core/OSKBuffer.h"
+#include "core/Startup.h"
+#include "core/Trace.h"
 #include <fstream> // Required for reading maestro.conf
 using namespace ilixi;
 
@@ -52,6 +58,7 @@ ReactionResult
 AppBase::reactionCBW(const void *msgData, void *ctx)
 {
   ReactorMessage *msg = (ReactorMessage*) msgData;
+  ILIXI_TRACE("reactor");
   if (appInstance)
     return appInstance->reactorCB(msg, ctx);
   return RS_REMOVE;
@@ -76,14 +83,19 @@ AppBase::AppBase(int argc, char* argv[])
   appInstance = this;
   world = NULL;
   arena = NULL;
+  maestroObject = NULL;
+  appRecord = NULL;
+  ringOverflowed = false;
+  ringFence = 0;
+  pthread_mutex_init(&callLock, NULL);
 
   ILOG_OPEN(basename(argv[0]));
-  if (joinFusion())
+  traceInit();
+  startupBegin(StartupFusion);
+  if (headless() ? joinHeadless(argv[0]) : joinFusion(argv[0]))
     {
+      startupEnd(StartupFusion);
       ILOG_DEBUG( "%s has joined fusion.", basename(argv[0]));
-      appRecord->process = (char*) SHMALLOC(maestroObject->pool,
-          sizeof(char) * strlen(argv[0]));
-      sprintf(appRecord->process, "%s", argv[0]);
     }
   else
     {
@@ -94,7 +106,11 @@ AppBase::AppBase(int argc, char* argv[])
 
 AppBase::~AppBase()
 {
-  leaveFusion();
+  if (world)
+    leaveFusion();
+  else
+    leaveHeadless();
+  pthread_mutex_destroy(&callLock);
   ILOG_CLOSE();
 }
 
@@ -113,11 +129,23 @@ AppBase::title() const
 void
 AppBase::setTitle(std::string title)
 {
-  if (appRecord->title)
-    SHFREE(maestroObject->pool, appRecord->title);
-  appRecord->title = (char*) SHMALLOC(maestroObject->pool,
+  if (!world)
+    {
+      free(appRecord->title);
+      appRecord->title = strdup(title.c_str());
+      return;
+    }
+  char* old = appRecord->title;
+  char* copy = (char*) SHMALLOC(maestroObject->pool,
       sizeof(char) * (title.length() + 1));
-  sprintf(appRecord->title, "%s", title.c_str());
+  sprintf(copy, "%s", title.c_str());
+  __sync_synchronize();
+  appRecord->title = copy;
+  // other processes may be copying old title inside appIndexFind().
+  if (maestroObject->appIndex)
+    appIndexRetire(maestroObject->appIndex, old);
+  else if (old)
+    SHFREE(maestroObject->pool, old);
 }
 
 void
@@ -126,16 +154,123 @@ AppBase::setAppMode(AppMode mode)
   appRecord->mode = mode;
 }
 
-char*
+const Theme*
+AppBase::sharedTheme() const
+{
+  return maestroObject->theme;
+}
+
+void
+AppBase::setHibernated(unsigned int bytes)
+{
+  appRecord->hibernated = bytes;
+}
+
+void
+AppBase::setMemoryUsage(const MemoryUsage& usage)
+{
+  appRecord->memory = usage;
+}
+
+ClipboardBuffer*
+AppBase::createClipboardBuffer(const std::string& mimeType, unsigned int size)
+{
+  if (!maestroObject->clipboard)
+    return NULL;
+  return clipboardAllocate(maestroObject->clipboard, maestroObject->pool,
+      mimeType.c_str(), size);
+}
+
+void
+AppBase::setClipboard(ClipboardBuffer* buffer)
+{
+  if (!maestroObject->clipboard || !buffer)
+    return;
+  unsigned int generation = clipboardPublish(maestroObject->clipboard,
+      maestroObject->pool, buffer);
+  ILOG_DEBUG("Published %s on clipboard, generation %u.", buffer->mimeType,
+      generation);
+
+  // all applications are attached to global channel.
+  ReactorMessage message(appRecord->fusionID, ClipboardChanged, None,
+      generation);
+  fusion_reactor_dispatch_channel(maestroObject->reactor, 1, &message,
+      sizeof(ReactorMessage), false, NULL);
+}
+
+bool
+AppBase::setClipboard(const std::string& mimeType, const void* data,
+    unsigned int size)
+{
+  ClipboardBuffer* buffer = createClipboardBuffer(mimeType, size);
+  if (!buffer)
+    return false;
+  memcpy(buffer->data, data, size);
+  setClipboard(buffer);
+  return true;
+}
+
+ClipboardBuffer*
+AppBase::acquireClipboard() const
+{
+  if (!maestroObject->clipboard)
+    return NULL;
+  return clipboardAcquire(maestroObject->clipboard);
+}
+
+void
+AppBase::releaseClipboard(ClipboardBuffer* buffer) const
+{
+  if (buffer)
+    clipboardRelease(buffer, maestroObject->pool);
+}
+
+unsigned int
+AppBase::clipboardGeneration() const
+{
+  if (!maestroObject->clipboard)
+    return 0;
+  return maestroObject->clipboard->generation;
+}
+
+bool
+AppBase::headless()
+{
+  static int headless = -1;
+  if (headless < 0)
+    {
+      const char* env = getenv("ILIXI_HEADLESS");
+      headless = (env && *env) ? 1 : 0;
+    }
+  return headless;
+}
+
+std::string
 AppBase::getOSKText() const
 {
-  return maestroObject->OSK;
+  std::string text;
+  oskBufferText(maestroObject->OSK, &text);
+  return text;
 }
 
 void
 AppBase::setOSKText(const std::string& text)
 {
-  sprintf(maestroObject->OSK, "%s", text.c_str());
+  oskBufferReset(maestroObject->OSK, text.c_str(), text.length());
+}
+
+void
+AppBase::insertOSKText(int index, const std::string& text)
+{
+  if (!oskBufferInsert(maestroObject->OSK, index, text.c_str(), text.length()))
+    ILOG_ERROR("OSK text exceeds OSK_SIZE!");
+}
+
+void
+AppBase::eraseOSKText(int index, int length)
+{
+  if (!oskBufferErase(maestroObject->OSK, index, length))
+    ILOG_ERROR("Cannot erase OSK text at %d!", index);
 }
 
 int
@@ -152,17 +287,40 @@ AppBase::enterArenaCB(FusionArena *arena, void *ctx)
       (void **) &maestroObject);
   fusion_arena_get_shared_field(arena, "AppVector", (void **) &appVector);
 
+  if (maestroObject->appIndex)
+    appIndexBeginWrite(maestroObject->appIndex);
   if (appVector->count < appVector->capacity)
     {
-      // TODO: lock app vector here.
+      const char* process = (const char*) ctx;
       appRecord = (AppRecord*) SHMALLOC(maestroObject->pool, sizeof(AppRecord));
       appRecord->mode = Initialising;
       appRecord->fusionID = fusion_id(world);
       appRecord->pid = getpid();
       appRecord->title = NULL;
-      appRecord->process = NULL;
+      appRecord->process = (char*) SHMALLOC(maestroObject->pool,
+          sizeof(char) * (strlen(process) + 1));
+      sprintf(appRecord->process, "%s", process);
+      appRecord->ring = NULL;
+      appRecord->hibernated = 0;
+      appRecord->memory = MemoryUsage();
+      if (maestroObject->messageRingSize > 0)
+        {
+          appRecord->ring = (MessageRing*) SHMALLOC(maestroObject->pool,
+              messageRingSize(maestroObject->messageRingSize));
+          if (appRecord->ring)
+            messageRingInit(appRecord->ring, maestroObject->messageRingSize,
+                appRecord->fusionID);
+          else
+            ILOG_WARNING("Unable to allocate message ring, using reactor.");
+        }
+      appRecord->startup = (StartupRecord*) SHMALLOC(maestroObject->pool,
+          sizeof(StartupRecord));
+      if (appRecord->startup)
+        startupPublish(appRecord->startup);
       fusion_vector_add(appVector, appRecord);
     }
+  if (maestroObject->appIndex)
+    appIndexEndWrite(maestroObject->appIndex);
 
   ILOG_INFO( "Joined ilixiArena.");
   return 0;
@@ -174,10 +332,53 @@ AppBase::cleanArenaCB(FusionArena *arena, void *ctx, bool emergency)
   ILOG_DEBUG( "Cleaning ilixiArena...");
   if (appRecord)
     {
+      AppIndex* index = maestroObject->appIndex;
+      if (index)
+        appIndexBeginWrite(index);
       int appIndex = fusion_vector_index_of(appVector, appRecord);
       fusion_vector_remove(appVector, appIndex);
-      SHFREE(maestroObject->pool, appRecord->title);
-      SHFREE(maestroObject->pool, appRecord);
+      if (index)
+        appIndexEndWrite(index);
+
+      MessageRing* ring = appRecord->ring;
+      unsigned int fusionID = appRecord->fusionID;
+      if (ring)
+        {
+          pthread_mutex_lock(&callLock);
+          appRecord->ring = NULL;
+          pthread_mutex_unlock(&callLock);
+        }
+      if (appRecord->startup)
+        startupPublish(NULL);
+      if (index)
+        {
+          // lookups may still copy record, Maestro frees it once they are
+          // done, see appIndexReclaim(). Record is not touched afterwards.
+          appIndexRetire(index, appRecord->title);
+          appIndexRetire(index, appRecord->process);
+          appIndexRetire(index, appRecord->startup);
+          appIndexRetire(index, appRecord);
+          appIndexLeave(index);
+        }
+      else
+        {
+          SHFREE(maestroObject->pool, appRecord->title);
+          SHFREE(maestroObject->pool, appRecord->process);
+          if (appRecord->startup)
+            SHFREE(maestroObject->pool, appRecord->startup);
+          SHFREE(maestroObject->pool, appRecord);
+        }
+      appRecord = NULL;
+      if (ring)
+        {
+          // Maestro may not have drained ring yet, e.g. Terminated
+          // notification, so it takes over ring and frees it. Its doorbell
+          // also makes Maestro reclaim retired record.
+          messageRingRetire(&maestroObject->retiredRings, ring);
+          ReactorMessage retired(fusionID, RingDoorbell, Terminated, fusionID);
+          fusion_reactor_dispatch(maestroObject->reactor, &retired, false,
+              NULL);
+        }
       fusion_reactor_detach(maestroObject->reactor, &reaction);
     }
   ILOG_INFO( "ilixiArena is cleaned.");
@@ -202,17 +403,64 @@ AppBase::callMaestro(ReactorMessageType type, AppMode mode, unsigned int appID)
   else
     ILOG_DEBUG("Sending SwitchMode via reactor...");
 
-  if (appID == 0)
+  ReactorMessage message(appRecord->fusionID, type, mode,
+      appID ? appID : appRecord->fusionID);
+
+  // In headless mode, mode requests are granted as Maestro would do.
+  if (!world)
+    {
+      if (type == ModeRequest)
+        {
+          ReactorMessage reply(1, SwitchMode, mode, message.appID);
+          reactionCBW(&reply, NULL);
+        }
+      return;
+    }
+
+  // messages are queued in shared memory and Maestro is woken up once per
+  // batch, reactor is only used if ring is not available. Once ring is full
+  // all following messages use reactor too, otherwise they could overtake
+  // messages sent over reactor meanwhile. Ring is used again after Maestro
+  // acknowledges the fence which followed the first of those messages.
+  pthread_mutex_lock(&callLock);
+  bool notify = false;
+  bool queued = false;
+  bool fence = false;
+  if (appRecord->ring && ringOverflowed
+      && messageRingFenced(appRecord->ring, ringFence))
+    {
+      ILOG_DEBUG("Maestro acknowledged fence %u, using message ring.",
+          ringFence);
+      ringOverflowed = false;
+    }
+  if (appRecord->ring && !ringOverflowed)
+    {
+      queued = messageRingPush(appRecord->ring, message, &notify);
+      if (!queued)
+        {
+          ILOG_WARNING("Message ring is full, using reactor.");
+          ringOverflowed = true;
+          fence = true;
+        }
+    }
+  if (notify)
     {
-      ReactorMessage message(appRecord->fusionID, type, mode,
+      ReactorMessage doorbell(appRecord->fusionID, RingDoorbell, None,
           appRecord->fusionID);
-      fusion_reactor_dispatch(maestroObject->reactor, &message, false, NULL);
+      fusion_reactor_dispatch(maestroObject->reactor, &doorbell, false, NULL);
     }
-  else
+  else if (!queued)
+    fusion_reactor_dispatch(maestroObject->reactor, &message, false, NULL);
+  if (fence)
     {
-      ReactorMessage message(appRecord->fusionID, type, mode, appID);
-      fusion_reactor_dispatch(maestroObject->reactor, &message, false, NULL);
+      if (++ringFence == 0)
+        ringFence = 1;
+      ReactorMessage fenceMessage(appRecord->fusionID, RingFence, None,
+          ringFence);
+      fusion_reactor_dispatch(maestroObject->reactor, &fenceMessage, false,
+          NULL);
     }
+  pthread_mutex_unlock(&callLock);
 }
 
 ReactionResult
@@ -239,36 +487,53 @@ AppBase::reactorCB(ReactorMessage *msg, void *ctx)
       }
     break;
 
+  case ClipboardChanged:
+    return RS_OK;
+
   default:
     ILOG_ERROR("Message type is not supported!");
     }
   return RS_DROP;
 }
 
-AppRecord* const
-AppBase::getAppRecord(unsigned int appID) const
+bool
+AppBase::getAppRecord(unsigned int appID, AppInfo* info) const
 {
-  AppRecord* record;
-  for (int i = 0; i < appVector->count; i++)
-    {
-      record = (AppRecord *) fusion_vector_at(appVector, i);
-      if (record->fusionID == appID)
-        return record;
-    }
-  return NULL;
+  if (maestroObject->appIndex)
+    return appIndexFind(maestroObject->appIndex, appID, info);
+  if (appID != appRecord->fusionID)
+    return false;
+  copyOwnRecord(info);
+  return true;
 }
 
-AppRecord* const
-AppBase::getAppRecord(std::string process) const
+bool
+AppBase::getAppRecord(std::string process, AppInfo* info) const
 {
-  AppRecord* record;
-  for (int i = 0; i < appVector->count; i++)
+  if (maestroObject->appIndex)
+    return appIndexFind(maestroObject->appIndex, process.c_str(), info);
+  if (process != appRecord->process)
+    return false;
+  copyOwnRecord(info);
+  return true;
+}
+
+void
+AppBase::copyOwnRecord(AppInfo* info) const
+{
+  info->mode = appRecord->mode;
+  info->fusionID = appRecord->fusionID;
+  info->pid = appRecord->pid;
+  info->ring = appRecord->ring;
+  const StartupRecord* startup = startupRecord();
+  info->firstFrame = startup->end[StartupFlip] ? startup->origin
+      + startup->end[StartupFlip] : 0;
+  info->title[0] = 0;
+  if (appRecord->title)
     {
-      record = (AppRecord *) fusion_vector_at(appVector, i);
-      if (strcmp(record->process, process.c_str()) == 0)
-        return record;
+      strncpy(info->title, appRecord->title, sizeof(info->title) - 1);
+      info->title[sizeof(info->title) - 1] = 0;
     }
-  return NULL;
 }
 
 //Designer*
@@ -284,7 +549,7 @@ AppBase::getAppRecord(std::string process) const
 //  return maestroObject->dfbInterface;
 //}
 bool
-AppBase::joinFusion()
+AppBase::joinFusion(const char* process)
 {
   // parse maestro config file
   int ilixi_world = 0;
@@ -330,8 +595,8 @@ AppBase::joinFusion()
         }
 
       int ret;
-      if (fusion_arena_enter(world, "ilixiArena", NULL, joinFusionCBW, NULL,
-          &arena, &ret) != DR_OK)
+      if (fusion_arena_enter(world, "ilixiArena", NULL, joinFusionCBW,
+          (void*) process, &arena, &ret) != DR_OK)
         {
           ILOG_FATAL("Could not enter ilixiArena!");
           return false;
@@ -398,3 +663,44 @@ AppBase::leaveFusion()
         ILOG_FATAL("Unable to exit ilixiWorld");
     }
 }
+
+bool
+AppBase::joinHeadless(const char* process)
+{
+  ILOG_INFO("Running headless without Maestro, pid: %d", getpid());
+  maestroObject = (MaestroObject*) calloc(1, sizeof(MaestroObject));
+  appRecord = (AppRecord*) calloc(1, sizeof(AppRecord));
+  if (!maestroObject || !appRecord)
+    return false;
+
+  maestroObject->OSK = (OSKBuffer*) malloc(oskBufferSize(1024));
+  if (!maestroObject->OSK)
+    return false;
+  oskBufferInit(maestroObject->OSK, 1024);
+
+  appVector = NULL;
+  appRecord->mode = Initialising;
+  // Maestro is 1, so application takes the first free ID.
+  appRecord->fusionID = 2;
+  appRecord->pid = getpid();
+  appRecord->process = strdup(process);
+  return true;
+}
+
+void
+AppBase::leaveHeadless()
+{
+  if (appRecord)
+    {
+      free(appRecord->title);
+      free(appRecord->process);
+      free(appRecord);
+      appRecord = NULL;
+    }
+  if (maestroObject)
+    {
+      free(maestroObject->OSK);
+      free(maestroObject);
+      maestroObject = NULL;
+    }
+}
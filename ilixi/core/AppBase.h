@@ -27,6 +27,8 @@
 #include <string>
 #include <pthread.h>
 #include "core/IFusion.h"
+#include "core/AppIndex.h"
+#include "core/Clipboard.h"
 
 namespace ilixi
 {
@@ -41,6 +43,11 @@ namespace ilixi
    * AppBase initiates a connection attempt to ilixi dfb-fusion world during construction;
    * the process is terminated if the attempt was unsuccessful. If successful a new
    * application record is created inside shared memory pool and initialised using joinFusionCB().
+   *
+   * If ILIXI_HEADLESS environment variable is set, application does not join
+   * fusion world and an in-process stub replaces Maestro: records are kept in
+   * process memory and mode requests are granted immediately. Clipboard and
+   * shared theme are not available in this mode.
    */
   class AppBase
   {
@@ -70,15 +77,107 @@ namespace ilixi
     void
     setAppMode(AppMode mode);
 
+    /*!
+     * Publishes number of bytes released by hibernation, 0 if application is awake.
+     */
+    void
+    setHibernated(unsigned int bytes);
+
+    /*!
+     * Publishes memory held by application windows, see Maestro --status.
+     */
+    void
+    setMemoryUsage(const MemoryUsage& usage);
+
+    /*!
+     * Allocates a clipboard buffer inside shared memory pool. Write payload
+     * directly into its data and pass buffer to setClipboard(), or release
+     * it using releaseClipboard(). Returns NULL if size exceeds
+     * CLIPBOARD_SIZE.
+     *
+     * @param mimeType MIME type of payload.
+     * @param size payload size in bytes.
+     */
+    ClipboardBuffer*
+    createClipboardBuffer(const std::string& mimeType, unsigned int size);
+
+    /*!
+     * Publishes buffer on clipboard and notifies other applications.
+     * Ownership of buffer passes to clipboard.
+     */
+    void
+    setClipboard(ClipboardBuffer* buffer);
+
+    /*!
+     * Copies data to a new clipboard buffer and publishes it.
+     *
+     * @return false if data could not be stored.
+     */
+    bool
+    setClipboard(const std::string& mimeType, const void* data,
+        unsigned int size);
+
+    /*!
+     * Returns current clipboard buffer, or NULL if clipboard is empty.
+     * Buffer can be read in place and must be released using
+     * releaseClipboard().
+     */
+    ClipboardBuffer*
+    acquireClipboard() const;
+
+    /*!
+     * Releases a buffer obtained from acquireClipboard() or
+     * createClipboardBuffer().
+     */
+    void
+    releaseClipboard(ClipboardBuffer* buffer) const;
+
+    /*!
+     * Returns number of buffers published on clipboard so far.
+     */
+    unsigned int
+    clipboardGeneration() const;
+
+    /*!
+     * Returns true if ILIXI_HEADLESS environment variable is set. Windows are
+     * then rendered into system memory surfaces without a display layer.
+     */
+    static bool
+    headless();
+
   protected:
     //    std::string processName;
 
-    char*
+    /*!
+     * Returns theme published by Maestro, or NULL if not available.
+     */
+    const Theme*
+    sharedTheme() const;
+
+    /*!
+     * Returns a copy of OSK text.
+     */
+    std::string
     getOSKText() const;
 
+    /*!
+     * Replaces OSK text, e.g. as OSK is shown for a widget.
+     */
     void
     setOSKText(const std::string& text);
 
+    /*!
+     * Inserts text into OSK text at given byte index.
+     */
+    void
+    insertOSKText(int index, const std::string& text);
+
+    /*!
+     * Erases length bytes of OSK text starting at given byte index.
+     */
+    void
+    eraseOSKText(int index, int length);
+
     int
     getStatusBarHeight() const;
 
@@ -88,7 +187,7 @@ namespace ilixi
      * and the record is initialised.
      *
      * @param arena Pointer to ilixiArena.
-     * @param ctx
+     * @param ctx Path to application.
      */
     int
     enterArenaCB(FusionArena* arena, void* ctx);
@@ -115,11 +214,19 @@ namespace ilixi
     virtual ReactionResult
     reactorCB(ReactorMessage *msg, void *ctx);
 
-    AppRecord* const
-    getAppRecord(unsigned int appID) const;
+    /*!
+     * Copies record of application with given fusionID to info.
+     * Returns false if there is no such application.
+     */
+    bool
+    getAppRecord(unsigned int appID, AppInfo* info) const;
 
-    AppRecord* const
-    getAppRecord(std::string process) const;
+    /*!
+     * Copies record of application with given process path to info.
+     * Returns false if there is no such application.
+     */
+    bool
+    getAppRecord(std::string process, AppInfo* info) const;
 
     //    Designer*
     //    getDesigner() const;
@@ -153,6 +260,12 @@ namespace ilixi
     FusionVector *appVector;
     //! Pointer to AppRecord instance of this application inside shared memory pool
     AppRecord *appRecord;
+    //! Serialises callMaestro(), message ring allows a single producer.
+    pthread_mutex_t callLock;
+    //! Set while message ring is bypassed because it was full.
+    bool ringOverflowed;
+    //! Last fence sent to Maestro, ring is used again once it is acknowledged.
+    unsigned int ringFence;
 
     static AppBase* appInstance;
 
@@ -177,10 +290,11 @@ namespace ilixi
      *
      * \sa enterArenaCB
      *
+     * @param process path to application, stored in application record.
      * @return true if operation is successful.
      */
     bool
-    joinFusion();
+    joinFusion(const char* process);
 
     /*!
      * Leaves ilixi dfb-fusion world and arena.
@@ -189,6 +303,23 @@ namespace ilixi
     void
     leaveFusion();
 
+    /*!
+     * Creates application record and a stub Maestro object in process
+     * memory, used instead of joinFusion() in headless mode.
+     */
+    bool
+    joinHeadless(const char* process);
+
+    /*!
+     * Frees records created by joinHeadless().
+     */
+    void
+    leaveHeadless();
+
+    //! Copies this application's record to info.
+    void
+    copyOwnRecord(AppInfo* info) const;
+
   };
 }
 #endif /* ILIXI_APPBASE_H_ */
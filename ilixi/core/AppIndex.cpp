@@ -0,0 +1,426 @@
+/*
+ Copyright 2010, 2011 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "core/AppIndex.h"
+#include "core/Logger.h"
+#include "core/Startup.h"
+#include <string.h>
+#include <sched.h>
+#include <signal.h>
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+
+using namespace ilixi;
+
+//! Number of times a reader spins on an odd sequence before it takes writer lock.
+static const int MaxSpins = 1 << 16;
+
+//! Reader slot of calling thread, valid for index and process it was taken in.
+static __thread AppIndexReader* threadReader = NULL;
+static __thread AppIndex* threadReaderIndex = NULL;
+static __thread pid_t threadReaderPid = 0;
+
+static pthread_key_t readerKey;
+static pthread_once_t readerKeyOnce = PTHREAD_ONCE_INIT;
+
+// Frees slot of an exiting thread.
+static void
+releaseReader(void* data)
+{
+  AppIndexReader* reader = (AppIndexReader*) data;
+  if (reader->pid == getpid())
+    {
+      reader->epoch = 0;
+      __sync_synchronize();
+      reader->pid = 0;
+    }
+}
+
+static void
+createReaderKey()
+{
+  pthread_key_create(&readerKey, releaseReader);
+}
+
+// Returns slot of calling thread, or NULL if all slots are taken.
+static AppIndexReader*
+readerSlot(AppIndex* index)
+{
+  pid_t pid = getpid();
+  if (threadReader && threadReaderIndex == index && threadReaderPid == pid)
+    return threadReader;
+
+  for (unsigned int i = 0; i < AppIndexReaders; ++i)
+    {
+      AppIndexReader* reader = &index->readers[i];
+      if (!reader->pid && __sync_bool_compare_and_swap(&reader->pid, 0, pid))
+        {
+          reader->epoch = 0;
+          threadReader = reader;
+          threadReaderIndex = index;
+          threadReaderPid = pid;
+          pthread_once(&readerKeyOnce, createReaderKey);
+          pthread_setspecific(readerKey, reader);
+          return reader;
+        }
+    }
+  return NULL;
+}
+
+static unsigned int
+hashID(unsigned int fusionID)
+{
+  return fusionID * 2654435761u;
+}
+
+static unsigned int
+hashProcess(const char* process)
+{
+  // FNV-1a
+  unsigned int hash = 2166136261u;
+  while (*process)
+    {
+      hash ^= (unsigned char) *process++;
+      hash *= 16777619u;
+    }
+  return hash;
+}
+
+static void
+insert(AppIndexEntry* table, unsigned int capacity, unsigned int key,
+    unsigned int hash, AppRecord* record)
+{
+  unsigned int slot = hash & (capacity - 1);
+  while (table[slot].record)
+    slot = (slot + 1) & (capacity - 1);
+  table[slot].key = key;
+  table[slot].record = record;
+}
+
+static void
+rebuild(AppIndex* index)
+{
+  FusionVector* apps = index->apps;
+  memset(index->byID, 0, 2 * index->capacity * sizeof(AppIndexEntry));
+  for (int i = 0; i < apps->count; i++)
+    {
+      if (2 * i >= (int) index->capacity)
+        {
+          ILOG_ERROR("AppIndex is full, %d records are not indexed!",
+              apps->count - i);
+          break;
+        }
+      AppRecord* record = (AppRecord*) fusion_vector_at(apps, i);
+      insert(index->byID, index->capacity, record->fusionID,
+          hashID(record->fusionID), record);
+      if (record->process)
+        {
+          unsigned int hash = hashProcess(record->process);
+          insert(index->byProcess, index->capacity, hash, hash, record);
+        }
+    }
+}
+
+// Probes table for key and copies matching record to info. If process is
+// not NULL, records are compared by process path as well.
+static bool
+lookup(AppIndex* index, AppIndexEntry* table, unsigned int key,
+    unsigned int hash, const char* process, AppInfo* info)
+{
+  unsigned int mask = index->capacity - 1;
+  for (unsigned int slot = hash & mask; table[slot].record; slot = (slot + 1)
+      & mask)
+    {
+      AppRecord* record = table[slot].record;
+      if (table[slot].key != key || (process && strcmp(record->process,
+          process) != 0))
+        continue;
+      info->mode = record->mode;
+      info->fusionID = record->fusionID;
+      info->pid = record->pid;
+      info->ring = record->ring;
+      StartupRecord* startup = record->startup;
+      info->firstFrame = startup && startup->end[StartupFlip] ? startup->origin
+          + startup->end[StartupFlip] : 0;
+      info->title[0] = 0;
+      if (record->title)
+        {
+          strncpy(info->title, record->title, sizeof(info->title) - 1);
+          info->title[sizeof(info->title) - 1] = 0;
+        }
+      return true;
+    }
+  return false;
+}
+
+// Looks up record holding writer lock, rebuilds index if a writer died.
+static bool
+lockedFind(AppIndex* index, AppIndexEntry* table, unsigned int key,
+    unsigned int hash, const char* process, AppInfo* info)
+{
+  bool found = false;
+  if (fusion_skirmish_prevail(&index->lock) == DR_OK)
+    {
+      if (index->sequence & 1)
+        {
+          ILOG_ERROR("AppIndex writer did not finish, rebuilding index.");
+          rebuild(index);
+          __sync_synchronize();
+          index->sequence++;
+        }
+      found = lookup(index, table, key, hash, process, info);
+      fusion_skirmish_dismiss(&index->lock);
+    }
+  else
+    ILOG_ERROR("Unable to lock AppIndex!");
+  return found;
+}
+
+static bool
+find(AppIndex* index, AppIndexEntry* table, unsigned int key,
+    unsigned int hash, const char* process, AppInfo* info)
+{
+  // Without a slot, lookup takes writer lock which reclaim holds as well.
+  AppIndexReader* reader = readerSlot(index);
+  if (!reader)
+    return lockedFind(index, table, key, hash, process, info);
+
+  // retired memory is not freed while reader's epoch is at or before its
+  // retirement, see appIndexReclaim().
+  reader->epoch = index->epoch;
+  __sync_synchronize();
+
+  bool found = false;
+  int spins = 0;
+  while (true)
+    {
+      unsigned int sequence = index->sequence;
+      if (sequence & 1)
+        {
+          // writer is taking too long, probably it died with sequence odd.
+          if (++spins == MaxSpins)
+            {
+              found = lockedFind(index, table, key, hash, process, info);
+              break;
+            }
+          if (spins > 100)
+            sched_yield();
+          continue;
+        }
+      __sync_synchronize();
+      found = lookup(index, table, key, hash, process, info);
+      __sync_synchronize();
+      if (index->sequence == sequence)
+        break;
+    }
+
+  __sync_synchronize();
+  reader->epoch = 0;
+  return found;
+}
+
+AppIndex*
+ilixi::appIndexCreate(FusionVector* apps, unsigned int maxApps,
+    FusionSHMPoolShared* pool, FusionWorld* world)
+{
+  // keep load factor at most 0.5 so that probe sequences stay short.
+  unsigned int capacity = 4;
+  while (capacity < 2 * maxApps)
+    capacity *= 2;
+
+  AppIndex* index = (AppIndex*) SHMALLOC(pool, sizeof(AppIndex));
+  if (!index)
+    return NULL;
+  index->byID = (AppIndexEntry*) SHCALLOC(pool, 2 * capacity,
+      sizeof(AppIndexEntry));
+  if (!index->byID)
+    {
+      SHFREE(pool, index);
+      return NULL;
+    }
+  index->byProcess = index->byID + capacity;
+  index->capacity = capacity;
+  index->apps = apps;
+  index->pool = pool;
+  index->sequence = 0;
+  index->epoch = 1;
+  index->retired = NULL;
+  memset(index->readers, 0, sizeof(index->readers));
+  if (fusion_skirmish_init(&index->lock, "AppIndex", world) != DR_OK)
+    {
+      ILOG_ERROR("Unable to initialise AppIndex lock!");
+      SHFREE(pool, index->byID);
+      SHFREE(pool, index);
+      return NULL;
+    }
+  return index;
+}
+
+void
+ilixi::appIndexDestroy(AppIndex* index, FusionSHMPoolShared* pool)
+{
+  // every process left arena, nothing can reach retired memory.
+  while (index->retired)
+    {
+      AppIndexRetired* retired = index->retired;
+      index->retired = retired->next;
+      SHFREE(pool, retired->memory);
+      SHFREE(pool, retired);
+    }
+  fusion_skirmish_destroy(&index->lock);
+  SHFREE(pool, index->byID);
+  SHFREE(pool, index);
+}
+
+void
+ilixi::appIndexBeginWrite(AppIndex* index)
+{
+  if (fusion_skirmish_prevail(&index->lock) != DR_OK)
+    ILOG_ERROR("Unable to lock AppIndex!");
+  // sequence stays odd until appIndexEndWrite(), readers which overlap any
+  // part of write retry.
+  index->sequence++;
+  __sync_synchronize();
+}
+
+void
+ilixi::appIndexEndWrite(AppIndex* index)
+{
+  rebuild(index);
+  __sync_synchronize();
+  index->sequence++;
+  fusion_skirmish_dismiss(&index->lock);
+}
+
+void
+ilixi::appIndexRetire(AppIndex* index, void* memory)
+{
+  if (!memory)
+    return;
+  AppIndexRetired* retired = (AppIndexRetired*) SHMALLOC(index->pool,
+      sizeof(AppIndexRetired));
+  if (!retired)
+    {
+      // leaking is safe, freeing while a lookup may copy it is not.
+      ILOG_ERROR("Unable to retire AppIndex memory, leaking it!");
+      return;
+    }
+  retired->memory = memory;
+
+  __sync_synchronize();
+  if (fusion_skirmish_prevail(&index->lock) != DR_OK)
+    {
+      ILOG_ERROR("Unable to lock AppIndex, leaking retired memory!");
+      SHFREE(index->pool, retired);
+      return;
+    }
+  // lookups which read a later epoch started after memory became
+  // unreachable.
+  retired->epoch = index->epoch;
+  index->epoch = index->epoch + 1 ? index->epoch + 1 : 1;
+  retired->next = index->retired;
+  index->retired = retired;
+  fusion_skirmish_dismiss(&index->lock);
+}
+
+void
+ilixi::appIndexLeave(AppIndex* index)
+{
+  pid_t pid = getpid();
+  for (unsigned int i = 0; i < AppIndexReaders; ++i)
+    if (index->readers[i].pid == pid)
+      {
+        index->readers[i].epoch = 0;
+        __sync_synchronize();
+        index->readers[i].pid = 0;
+      }
+  threadReader = NULL;
+}
+
+void
+ilixi::appIndexReclaim(AppIndex* index)
+{
+  if (fusion_skirmish_prevail(&index->lock) != DR_OK)
+    {
+      ILOG_ERROR("Unable to lock AppIndex!");
+      return;
+    }
+  __sync_synchronize();
+
+  // oldest epoch of lookups in progress, relative to current epoch.
+  unsigned int current = index->epoch;
+  unsigned int oldest = 0;
+  bool active = false;
+  for (unsigned int i = 0; i < AppIndexReaders; ++i)
+    {
+      AppIndexReader* reader = &index->readers[i];
+      pid_t pid = reader->pid;
+      if (!pid)
+        continue;
+      if (kill(pid, 0) == -1 && errno == ESRCH)
+        {
+          ILOG_WARNING("AppIndex reader (pid: %d) died, resetting its slot.",
+              pid);
+          reader->epoch = 0;
+          __sync_synchronize();
+          __sync_bool_compare_and_swap(&reader->pid, pid, 0);
+          continue;
+        }
+      unsigned int epoch = reader->epoch;
+      if (epoch && (!active || current - epoch > current - oldest))
+        {
+          oldest = epoch;
+          active = true;
+        }
+    }
+
+  AppIndexRetired** link = &index->retired;
+  while (*link)
+    {
+      AppIndexRetired* retired = *link;
+      // reachable by lookups which started at its epoch or before.
+      if (active && current - retired->epoch <= current - oldest)
+        link = &retired->next;
+      else
+        {
+          *link = retired->next;
+          SHFREE(index->pool, retired->memory);
+          SHFREE(index->pool, retired);
+        }
+    }
+  fusion_skirmish_dismiss(&index->lock);
+}
+
+bool
+ilixi::appIndexFind(AppIndex* index, unsigned int fusionID, AppInfo* info)
+{
+  return find(index, index->byID, fusionID, hashID(fusionID), NULL, info);
+}
+
+bool
+ilixi::appIndexFind(AppIndex* index, const char* process, AppInfo* info)
+{
+  unsigned int hash = hashProcess(process);
+  return find(index, index->byProcess, hash, hash, process, info);
+}
@@ -0,0 +1,183 @@
+/*
+ Copyright 2010, 2011 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ILIXI_APPINDEX_H_
+#define ILIXI_APPINDEX_H_
+
+#include "core/IFusion.h"
+
+namespace ilixi
+{
+  //! A slot in AppIndex hash tables.
+  struct AppIndexEntry
+  {
+    //! FusionID or hash of process path.
+    unsigned int key;
+    //! Indexed record, NULL if slot is empty.
+    AppRecord* record;
+  };
+
+  //! Copy of AppRecord fields returned by appIndexFind().
+  struct AppInfo
+  {
+    //! Mode of application at the time of lookup.
+    AppMode mode;
+    //! FusionID of application.
+    unsigned int fusionID;
+    //! pid of task.
+    pid_t pid;
+    //! Message ring, owned by Maestro once application leaves.
+    MessageRing* ring;
+    //! CLOCK_MONOTONIC time of first flip in microseconds, 0 if not yet.
+    long long firstFrame;
+    //! Title of application, truncated if necessary.
+    char title[128];
+  };
+
+  //! Number of threads which may look up records without taking writer lock.
+  const unsigned int AppIndexReaders = 64;
+
+  //! Lookup state of a reading thread.
+  struct AppIndexReader
+  {
+    //! Process which owns slot, 0 if slot is free.
+    volatile pid_t pid;
+    //! Epoch at which lookup in progress started, 0 if there is none.
+    volatile unsigned int epoch;
+  };
+
+  //! Memory removed from index, freed once no lookup can reach it.
+  struct AppIndexRetired
+  {
+    //! Shared memory to free.
+    void* memory;
+    //! Epoch at which memory was retired.
+    unsigned int epoch;
+    AppIndexRetired* next;
+  };
+
+  //! Hash index over AppVector inside shared memory.
+  /*!
+   * Records are indexed by fusionID and by process path using open
+   * addressing. Readers do not block writers: the index is protected by a
+   * seqlock and a lookup is retried if a writer modified the index
+   * meanwhile. Writers (applications joining or leaving ilixiArena)
+   * serialise on a fusion skirmish and rebuild both tables from AppVector.
+   *
+   * Lookups copy record fields to an AppInfo, so callers never hold a
+   * pointer to a record. Memory reachable from index is not freed directly
+   * but passed to appIndexRetire(). Each reading thread owns a slot which
+   * holds the epoch its lookup started at; appIndexReclaim(), called by
+   * Maestro, frees retired memory once no lookup from that epoch or before
+   * is in progress. Slots of processes which died are reset by reclaim, so
+   * a reader dying inside a lookup does not block reclamation. If a writer
+   * dies with an odd sequence, readers stop spinning after a while, take
+   * writer lock and rebuild index.
+   */
+  struct AppIndex
+  {
+    //! Odd while a writer is modifying index.
+    volatile unsigned int sequence;
+    //! Incremented by appIndexRetire(), never 0.
+    volatile unsigned int epoch;
+    //! Serialises writers and reclamation across processes.
+    FusionSkirmish lock;
+    //! Number of slots in each table, a power of two.
+    unsigned int capacity;
+    //! Records hashed by fusionID.
+    AppIndexEntry* byID;
+    //! Records hashed by process path.
+    AppIndexEntry* byProcess;
+    //! Indexed vector, AppVector.
+    FusionVector* apps;
+    //! Pool of index and retired memory.
+    FusionSHMPoolShared* pool;
+    //! Retired memory, most recent first, protected by lock.
+    AppIndexRetired* retired;
+    //! Slots of reading threads.
+    AppIndexReader readers[AppIndexReaders];
+  };
+
+  /*!
+   * Allocates and initialises an index for at most maxApps records of apps
+   * in pool. Returns NULL on failure.
+   */
+  AppIndex*
+  appIndexCreate(FusionVector* apps, unsigned int maxApps,
+      FusionSHMPoolShared* pool, FusionWorld* world);
+
+  /*!
+   * Destroys index and frees its memory, including retired memory.
+   */
+  void
+  appIndexDestroy(AppIndex* index, FusionSHMPoolShared* pool);
+
+  /*!
+   * Acquires writer lock. AppVector may be modified until appIndexEndWrite().
+   */
+  void
+  appIndexBeginWrite(AppIndex* index);
+
+  /*!
+   * Rebuilds index from AppVector and releases writer lock.
+   */
+  void
+  appIndexEndWrite(AppIndex* index);
+
+  /*!
+   * Schedules memory for release once lookups which could still reach it
+   * are done. Used for records removed from index and for memory replaced
+   * inside an indexed record. Memory must already be unreachable from index.
+   */
+  void
+  appIndexRetire(AppIndex* index, void* memory);
+
+  /*!
+   * Frees reader slots of calling process. Called when process leaves
+   * ilixiArena, no lookups may follow.
+   */
+  void
+  appIndexLeave(AppIndex* index);
+
+  /*!
+   * Frees retired memory which no lookup in progress can reach and resets
+   * slots of readers which died. Called by Maestro.
+   */
+  void
+  appIndexReclaim(AppIndex* index);
+
+  /*!
+   * Copies record with given fusionID to info. Returns false if not found.
+   */
+  bool
+  appIndexFind(AppIndex* index, unsigned int fusionID, AppInfo* info);
+
+  /*!
+   * Copies record with given process path to info. Returns false if not
+   * found.
+   */
+  bool
+  appIndexFind(AppIndex* index, const char* process, AppInfo* info);
+}
+
+#endif /* ILIXI_APPINDEX_H_ */
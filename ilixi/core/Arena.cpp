@@ -0,0 +1,213 @@
+/*
+ Copyright 2010, 2011 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "core/Arena.h"
+#include <stdlib.h>
+#include <string.h>
+#include <map>
+#include <utility>
+
+using namespace ilixi;
+
+namespace
+{
+  //! Smallest block size, a block must fit largest object.
+  const size_t MinBlockSize = 4096;
+
+  __thread Arena* currentArena = NULL;
+
+  //! Maps end of each block to its start and owner.
+  typedef std::map<const char*, std::pair<const char*, Arena*> > BlockMap;
+
+  //! Created with first block and never freed, objects may outlive statics.
+  BlockMap* blockMap = NULL;
+  //! Number of entries in blockMap, read without lock.
+  volatile unsigned int blockCount = 0;
+  pthread_rwlock_t blockMapLock = PTHREAD_RWLOCK_INITIALIZER;
+}
+
+Arena::Arena(size_t blockSize) :
+  _blockSize(blockSize < MinBlockSize ? MinBlockSize : blockSize),
+      _reserved(0), _blocks(NULL), _top(NULL), _end(NULL), _objects(0),
+      _destroyed(false)
+{
+  memset(_free, 0, sizeof(_free));
+  pthread_mutex_init(&_lock, NULL);
+}
+
+Arena::~Arena()
+{
+  pthread_rwlock_wrlock(&blockMapLock);
+  while (_blocks)
+    {
+      Block* next = _blocks->next;
+      blockMap->erase((char*) _blocks + _blockSize);
+      __sync_fetch_and_sub(&blockCount, 1);
+      free(_blocks);
+      _blocks = next;
+    }
+  pthread_rwlock_unlock(&blockMapLock);
+  pthread_mutex_destroy(&_lock);
+}
+
+void
+Arena::destroy()
+{
+  pthread_mutex_lock(&_lock);
+  _destroyed = true;
+  bool empty = !_objects;
+  pthread_mutex_unlock(&_lock);
+  if (empty)
+    delete this;
+}
+
+unsigned int
+Arena::objects() const
+{
+  return _objects;
+}
+
+size_t
+Arena::reserved() const
+{
+  return _reserved;
+}
+
+Arena*
+Arena::current()
+{
+  return currentArena;
+}
+
+void*
+Arena::allocate(Arena* arena, size_t size)
+{
+  void* ptr = NULL;
+  if (arena && size <= MaxObjectSize)
+    ptr = arena->take(sizeClass(size));
+
+  if (!ptr)
+    {
+      ptr = malloc(size ? size : 1);
+      if (!ptr)
+        throw std::bad_alloc();
+    }
+  return ptr;
+}
+
+void
+Arena::deallocate(void* ptr, size_t size)
+{
+  if (!ptr)
+    return;
+  Arena* arena = size <= MaxObjectSize ? owner(ptr) : NULL;
+  if (!arena)
+    free(ptr);
+  else if (arena->give(ptr, sizeClass(size)))
+    delete arena;
+}
+
+void*
+Arena::take(unsigned int sizeClass)
+{
+  pthread_mutex_lock(&_lock);
+  void* ptr = _free[sizeClass];
+  if (ptr)
+    _free[sizeClass] = _free[sizeClass]->next;
+  else
+    {
+      size_t bytes = sizeClass * ClassSize;
+      if (_top + bytes > _end)
+        {
+          Block* block = (Block*) malloc(_blockSize);
+          if (!block)
+            {
+              pthread_mutex_unlock(&_lock);
+              return NULL;
+            }
+          pthread_rwlock_wrlock(&blockMapLock);
+          if (!blockMap)
+            blockMap = new BlockMap;
+          (*blockMap)[(char*) block + _blockSize] = std::make_pair(
+              (const char*) block, this);
+          __sync_fetch_and_add(&blockCount, 1);
+          pthread_rwlock_unlock(&blockMapLock);
+          block->next = _blocks;
+          _blocks = block;
+          _top = (char*) (block + 1);
+          _end = (char*) block + _blockSize;
+          _reserved += _blockSize;
+        }
+      ptr = _top;
+      _top += bytes;
+    }
+  ++_objects;
+  pthread_mutex_unlock(&_lock);
+  return ptr;
+}
+
+bool
+Arena::give(void* ptr, unsigned int sizeClass)
+{
+  pthread_mutex_lock(&_lock);
+  FreeObject* object = (FreeObject*) ptr;
+  object->next = _free[sizeClass];
+  _free[sizeClass] = object;
+  bool dead = --_objects == 0 && _destroyed;
+  pthread_mutex_unlock(&_lock);
+  return dead;
+}
+
+unsigned int
+Arena::sizeClass(size_t size)
+{
+  // objects of size 0 still get a class.
+  return size ? (size + ClassSize - 1) / ClassSize : 1;
+}
+
+Arena*
+Arena::owner(const void* ptr)
+{
+  // objects are only freed after they were allocated, so a block of ptr is
+  // already counted.
+  if (!blockCount)
+    return NULL;
+  Arena* arena = NULL;
+  pthread_rwlock_rdlock(&blockMapLock);
+  BlockMap::const_iterator it = blockMap->upper_bound((const char*) ptr);
+  if (it != blockMap->end() && it->second.first <= (const char*) ptr)
+    arena = it->second.second;
+  pthread_rwlock_unlock(&blockMapLock);
+  return arena;
+}
+
+ArenaScope::ArenaScope(Arena* arena) :
+  _previous(currentArena)
+{
+  currentArena = arena;
+}
+
+ArenaScope::~ArenaScope()
+{
+  currentArena = _previous;
+}
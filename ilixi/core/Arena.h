@@ -0,0 +1,267 @@
+/*
+ Copyright 2010, 2011 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ILIXI_ARENA_H_
+#define ILIXI_ARENA_H_
+
+#include <stddef.h>
+#include <pthread.h>
+#include <new>
+
+namespace ilixi
+{
+  //! Allocates small objects of a widget tree from large blocks.
+  /*!
+   * Objects are carved from blocks of memory and freed objects are kept in
+   * free lists by size, so a widget tree is laid out contiguously and
+   * rebuilding a screen reuses memory of the previous one. Blocks are
+   * returned to the system in bulk once arena is destroyed and its last
+   * object is freed.
+   *
+   * Widgets, their surfaces, fonts and brushes, and nodes of containers
+   * using ArenaAllocator are allocated from current arena of thread, see
+   * ArenaScope. Allocations larger than MaxObjectSize and allocations made
+   * without an arena use malloc().
+   *
+   * Objects carry no header. Callers pass object size when freeing and
+   * owner is found from address of object, which is skipped while no arena
+   * has blocks.
+   */
+  class Arena
+  {
+  public:
+    //! Largest object which is allocated from blocks.
+    static const size_t MaxObjectSize = 512;
+
+    /*!
+     * Constructor.
+     *
+     * @param blockSize size of each block in bytes.
+     */
+    Arena(size_t blockSize = 64 * 1024);
+
+    /*!
+     * Marks arena for destruction. Arena is deleted immediately if it has no
+     * objects, otherwise once its last object is freed.
+     */
+    void
+    destroy();
+
+    /*!
+     * Returns number of objects allocated from arena and not freed.
+     */
+    unsigned int
+    objects() const;
+
+    /*!
+     * Returns bytes reserved in blocks.
+     */
+    size_t
+    reserved() const;
+
+    /*!
+     * Returns current arena of calling thread, NULL if there is none.
+     */
+    static Arena*
+    current();
+
+    /*!
+     * Allocates size bytes from arena, or using malloc() if arena is NULL.
+     * Throws std::bad_alloc on failure.
+     */
+    static void*
+    allocate(Arena* arena, size_t size);
+
+    /*!
+     * Frees memory returned by allocate().
+     *
+     * @param ptr object.
+     * @param size size given to allocate().
+     */
+    static void
+    deallocate(void* ptr, size_t size);
+
+  private:
+    //! Overlays a freed object while it is in a free list.
+    struct FreeObject
+    {
+      FreeObject* next;
+    };
+
+    //! Precedes each block, keeps objects aligned to 16 bytes.
+    union Block
+    {
+      Block* next;
+      double align[2];
+    };
+
+    //! Number of bytes in each size class.
+    static const size_t ClassSize = sizeof(Block);
+    //! Number of size classes.
+    static const unsigned int ClassCount = MaxObjectSize / ClassSize + 1;
+
+    size_t _blockSize;
+    size_t _reserved;
+    Block* _blocks;
+    char* _top;
+    char* _end;
+    FreeObject* _free[ClassCount];
+    unsigned int _objects;
+    bool _destroyed;
+    pthread_mutex_t _lock;
+
+    ~Arena();
+
+    void*
+    take(unsigned int sizeClass);
+
+    //! Returns true if arena should be deleted.
+    bool
+    give(void* ptr, unsigned int sizeClass);
+
+    //! Returns size class of objects with given size.
+    static unsigned int
+    sizeClass(size_t size);
+
+    //! Returns arena which owns ptr, NULL if ptr was allocated by malloc().
+    static Arena*
+    owner(const void* ptr);
+  };
+
+  //! Allocates container nodes from current arena, see Arena.
+  /*!
+   * Memory is taken from arena which is current when an element is
+   * allocated, and may be freed in any scope.
+   */
+  template<class T>
+    class ArenaAllocator
+    {
+    public:
+      typedef size_t size_type;
+      typedef ptrdiff_t difference_type;
+      typedef T* pointer;
+      typedef const T* const_pointer;
+      typedef T& reference;
+      typedef const T& const_reference;
+      typedef T value_type;
+
+      template<class U>
+        struct rebind
+        {
+          typedef ArenaAllocator<U> other;
+        };
+
+      ArenaAllocator()
+      {
+      }
+
+      template<class U>
+        ArenaAllocator(const ArenaAllocator<U>&)
+        {
+        }
+
+      pointer
+      address(reference x) const
+      {
+        return &x;
+      }
+
+      const_pointer
+      address(const_reference x) const
+      {
+        return &x;
+      }
+
+      pointer
+      allocate(size_type n, const void* = 0)
+      {
+        return (pointer) Arena::allocate(Arena::current(), n * sizeof(T));
+      }
+
+      void
+      deallocate(pointer p, size_type n)
+      {
+        Arena::deallocate(p, n * sizeof(T));
+      }
+
+      size_type
+      max_size() const
+      {
+        return size_t(-1) / sizeof(T);
+      }
+
+      void
+      construct(pointer p, const T& value)
+      {
+        new ((void*) p) T(value);
+      }
+
+      void
+      destroy(pointer p)
+      {
+        p->~T();
+      }
+    };
+
+  template<class T, class U>
+    inline bool
+    operator==(const ArenaAllocator<T>&, const ArenaAllocator<U>&)
+    {
+      return true;
+    }
+
+  template<class T, class U>
+    inline bool
+    operator!=(const ArenaAllocator<T>&, const ArenaAllocator<U>&)
+    {
+      return false;
+    }
+
+  //! Makes an arena current for calling thread during its lifetime.
+  /*!
+   * Widgets constructed in scope, and surfaces they create later, are
+   * allocated from given arena:
+   *
+   * \code
+   * Dialog* dialog = new Dialog("Settings");
+   * {
+   *   ArenaScope scope(dialog->arena());
+   *   dialog->addWidget(new Label("Name"));
+   * }
+   * \endcode
+   *
+   * Scopes can be nested, previous arena is made current on destruction.
+   */
+  class ArenaScope
+  {
+  public:
+    ArenaScope(Arena* arena);
+
+    ~ArenaScope();
+
+  private:
+    Arena* _previous;
+  };
+}
+
+#endif /* ILIXI_ARENA_H_ */
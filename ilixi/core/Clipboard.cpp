@@ -0,0 +1,115 @@
+/*
+ Copyright 2010, 2011 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "core/Clipboard.h"
+#include "core/Logger.h"
+#include <string.h>
+
+using namespace ilixi;
+
+Clipboard*
+ilixi::clipboardCreate(unsigned int capacity, FusionSHMPoolShared* pool,
+    FusionWorld* world)
+{
+  Clipboard* clipboard = (Clipboard*) SHMALLOC(pool, sizeof(Clipboard));
+  if (!clipboard)
+    return NULL;
+  clipboard->generation = 0;
+  clipboard->capacity = capacity;
+  clipboard->current = NULL;
+  if (fusion_skirmish_init(&clipboard->lock, "Clipboard", world) != DR_OK)
+    {
+      ILOG_ERROR("Unable to initialise clipboard lock!");
+      SHFREE(pool, clipboard);
+      return NULL;
+    }
+  return clipboard;
+}
+
+void
+ilixi::clipboardDestroy(Clipboard* clipboard, FusionSHMPoolShared* pool)
+{
+  if (clipboard->current)
+    clipboardRelease(clipboard->current, pool);
+  fusion_skirmish_destroy(&clipboard->lock);
+  SHFREE(pool, clipboard);
+}
+
+ClipboardBuffer*
+ilixi::clipboardAllocate(Clipboard* clipboard, FusionSHMPoolShared* pool,
+    const char* mimeType, unsigned int size)
+{
+  if (size > clipboard->capacity)
+    {
+      ILOG_ERROR("Clipboard payload (%u bytes) exceeds CLIPBOARD_SIZE!", size);
+      return NULL;
+    }
+
+  ClipboardBuffer* buffer = (ClipboardBuffer*) SHMALLOC(pool,
+      sizeof(ClipboardBuffer) + size);
+  if (!buffer)
+    {
+      ILOG_ERROR("Unable to allocate clipboard buffer!");
+      return NULL;
+    }
+  buffer->references = 1;
+  buffer->size = size;
+  strncpy(buffer->mimeType, mimeType, CLIPBOARD_MIME_SIZE - 1);
+  buffer->mimeType[CLIPBOARD_MIME_SIZE - 1] = 0;
+  return buffer;
+}
+
+unsigned int
+ilixi::clipboardPublish(Clipboard* clipboard, FusionSHMPoolShared* pool,
+    ClipboardBuffer* buffer)
+{
+  // payload must be visible before buffer is.
+  __sync_synchronize();
+  fusion_skirmish_prevail(&clipboard->lock);
+  ClipboardBuffer* previous = clipboard->current;
+  clipboard->current = buffer;
+  unsigned int generation = ++clipboard->generation;
+  fusion_skirmish_dismiss(&clipboard->lock);
+
+  if (previous)
+    clipboardRelease(previous, pool);
+  return generation;
+}
+
+ClipboardBuffer*
+ilixi::clipboardAcquire(Clipboard* clipboard)
+{
+  fusion_skirmish_prevail(&clipboard->lock);
+  ClipboardBuffer* buffer = clipboard->current;
+  if (buffer)
+    __sync_add_and_fetch(&buffer->references, 1);
+  fusion_skirmish_dismiss(&clipboard->lock);
+  return buffer;
+}
+
+void
+ilixi::clipboardRelease(ClipboardBuffer* buffer, FusionSHMPoolShared* pool)
+{
+  if (__sync_sub_and_fetch(&buffer->references, 1) == 0)
+    SHFREE(pool, buffer);
+}
@@ -0,0 +1,117 @@
+/*
+ Copyright 2010, 2011 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ILIXI_CLIPBOARD_H_
+#define ILIXI_CLIPBOARD_H_
+
+#include "core/IFusion.h"
+
+namespace ilixi
+{
+  //! Maximum length of a MIME type including terminating null.
+  const unsigned int CLIPBOARD_MIME_SIZE = 64;
+
+  //! Reference counted clipboard payload inside shared memory.
+  /*!
+   * A buffer is written once by its creator and is read only afterwards.
+   * Readers access data in place, so copying between applications involves
+   * no memcpy other than the initial write.
+   */
+  struct ClipboardBuffer
+  {
+    //! Number of references, buffer is freed when it drops to zero.
+    volatile int references;
+    //! Size of data in bytes.
+    unsigned int size;
+    //! MIME type of data, e.g. "text/plain;charset=utf-8".
+    char mimeType[CLIPBOARD_MIME_SIZE];
+    //! Payload, size bytes.
+    char data[1];
+  };
+
+  //! Clipboard shared by all applications in ilixi fusion world.
+  /*!
+   * Clipboard holds a reference to the current buffer. Each publish replaces
+   * the buffer and increments generation; buffers are freed as soon as the
+   * last application reading it releases its reference.
+   */
+  struct Clipboard
+  {
+    //! Protects current against concurrent publish and acquire.
+    FusionSkirmish lock;
+    //! Incremented each time a buffer is published.
+    volatile unsigned int generation;
+    //! Maximum size of a payload in bytes.
+    unsigned int capacity;
+    //! Current buffer, NULL if clipboard is empty.
+    ClipboardBuffer* current;
+  };
+
+  /*!
+   * Allocates and initialises an empty clipboard in pool. Returns NULL on
+   * failure.
+   *
+   * @param capacity maximum payload size in bytes.
+   */
+  Clipboard*
+  clipboardCreate(unsigned int capacity, FusionSHMPoolShared* pool,
+      FusionWorld* world);
+
+  /*!
+   * Destroys clipboard and releases its buffer.
+   */
+  void
+  clipboardDestroy(Clipboard* clipboard, FusionSHMPoolShared* pool);
+
+  /*!
+   * Allocates a buffer with a single reference owned by caller. Caller
+   * writes its payload into data and either publishes or releases buffer.
+   * Returns NULL if size exceeds capacity or pool is exhausted.
+   */
+  ClipboardBuffer*
+  clipboardAllocate(Clipboard* clipboard, FusionSHMPoolShared* pool,
+      const char* mimeType, unsigned int size);
+
+  /*!
+   * Makes buffer current and returns new generation. Caller's reference is
+   * passed to clipboard, previous buffer is released.
+   */
+  unsigned int
+  clipboardPublish(Clipboard* clipboard, FusionSHMPoolShared* pool,
+      ClipboardBuffer* buffer);
+
+  /*!
+   * Returns current buffer with a new reference for caller, or NULL if
+   * clipboard is empty.
+   */
+  ClipboardBuffer*
+  clipboardAcquire(Clipboard* clipboard);
+
+  /*!
+   * Drops a reference and frees buffer if it was the last one.
+   */
+  void
+  clipboardRelease(ClipboardBuffer* buffer, FusionSHMPoolShared* pool);
+}
+
+#endif /* ILIXI_CLIPBOARD_H_ */
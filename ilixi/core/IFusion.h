@@ -41,6 +41,7 @@ extern "C"
 #include <unistd.h>
 #include <stdlib.h>
 #include <directfb.h>
+#include "core/MemoryUsage.h"
 
 namespace ilixi
 {
@@ -54,6 +55,13 @@ namespace ilixi
            }                                                                   \
         }
 
+  struct MessageRing;
+  struct AppIndex;
+  struct Clipboard;
+  struct OSKBuffer;
+  struct StartupRecord;
+  struct Theme;
+
   //! Maestro creates a unique instance of this object in ilixi fusion world.
   struct MaestroObject
   {
@@ -61,11 +69,20 @@ namespace ilixi
     FusionSHMPoolShared* pool;
     //! Pointer to dfb-fusion reactor
     FusionReactor* reactor;
-    //! Pointer to OSK input.
-    char* OSK;
+    //! OSK text and log of its edits.
+    OSKBuffer* OSK;
     //! Height of statusbar application in pixels.
     int statusBarHeight;
-    // TODO: Add clipboard.
+    //! Number of messages in each application's message ring, 0 disables rings.
+    int messageRingSize;
+    //! Rings of applications which left ilixiArena, freed by Maestro.
+    MessageRing* retiredRings;
+    //! Index of records in AppVector.
+    AppIndex* appIndex;
+    //! Clipboard shared by applications.
+    Clipboard* clipboard;
+    //! Stylesheet parsed and decoded by Maestro, NULL if not available.
+    Theme* theme;
   };
 
   /*!
@@ -91,7 +108,11 @@ namespace ilixi
     SwitchMode, //!< Switch mode (Maestro -> Application).
     ModeRequest, //!< Request a mode change (Application -> Maestro).
     Notification, //!< The notification of a state change (Application -> Maestro).
-    OSKEvent
+    OSKEvent, //!< OSK related event, mode is Visible while editing and Ready once done.
+    RingDoorbell, //!< Sender's message ring has new messages, mode is Terminated if ring is retired (Application -> Maestro).
+    RingFence, //!< Sender falls back to reactor until appID is acknowledged as ring fence (Application -> Maestro).
+    ClipboardChanged
+  //!< Clipboard is modified, appID is new generation (Application -> Applications).
   };
 
   //! An active application has a record in ilixi fusion world.
@@ -107,6 +128,14 @@ namespace ilixi
     char* title;
     //! Path to application.
     char* process;
+    //! Messages from application to Maestro, NULL if not available.
+    MessageRing* ring;
+    //! Startup timestamps of application, NULL if not available.
+    StartupRecord* startup;
+    //! Bytes released while application is hibernating, 0 otherwise.
+    unsigned int hibernated;
+    //! Memory held by application windows, updated once a second.
+    MemoryUsage memory;
   };
 
   //! Maestro and applications communicate over reactor using this message format.
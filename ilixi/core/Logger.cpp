@@ -24,36 +24,433 @@
 #include "core/Logger.h"
 #if ILIXI_LOGGER_ENABLED
 #include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <ctime>
 #include <syslog.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <unistd.h>
 
 using namespace ilixi;
 using namespace std;
 
+volatile int ilixi::ilixi_log_generation = 0;
+
+namespace
+{
+  //! Number of records in each thread's ring, must be a power of two.
+  const unsigned int LogRingSize = 128;
+  //! Maximum length of a formatted message.
+  const unsigned int LogTextSize = 256;
+  //! Maximum number of category rules in a filter.
+  const unsigned int LogMaxRules = 32;
+
+  struct LogRecord
+  {
+    int level;
+    char text[LogTextSize];
+  };
+
+  /*
+   * Single producer, single consumer ring. Only owning thread writes head
+   * and only drainer writes tail.
+   */
+  struct LogRing
+  {
+    volatile unsigned int head;
+    volatile unsigned int tail;
+    volatile unsigned int dropped;
+    volatile int closed;
+    LogRing* next;
+    LogRecord records[LogRingSize];
+  };
+
+  struct LogRule
+  {
+    char category[64];
+    int level;
+  };
+
+  pthread_mutex_t __ringsLock = PTHREAD_MUTEX_INITIALIZER;
+  LogRing* __rings = NULL;
+  __thread LogRing* __threadRing = NULL;
+  pthread_key_t __ringKey;
+  pthread_once_t __ringKeyOnce = PTHREAD_ONCE_INIT;
+
+  pthread_t __drainer;
+  sem_t __drainSem;
+  volatile int __opened = 0;
+  volatile int __running = 0;
+  volatile int __quit = 0;
+  FILE* __file = NULL;
+  char __ident[64];
+  int __facility = LOG_USER;
+
+  pthread_mutex_t __filterLock = PTHREAD_MUTEX_INITIALIZER;
+  LogRule __rules[LogMaxRules];
+  unsigned int __ruleCount = 0;
+#if ILIXI_LOG_DEBUG_ENABLED
+  int __defaultLevel = 7;
+#else
+  int __defaultLevel = 5;
+#endif
+
+  const char* __levelNames[] =
+    { "emerg", "alert", "crit", "error", "warning", "notice", "info", "debug" };
+
+  void
+  writeRecord(int level, const char* text)
+  {
+    if (__file)
+      {
+        time_t now = time(NULL);
+        char stamp[32];
+        strftime(stamp, sizeof(stamp), "%b %d %H:%M:%S", localtime(&now));
+        fprintf(__file, "%s %s[%d]: <%s> %s\n", stamp, __ident, getpid(),
+            __levelNames[level & 7], text);
+      }
+    else
+      syslog(level, "%s", text);
+  }
+
+  // Called by drainer only.
+  void
+  drainRings()
+  {
+    pthread_mutex_lock(&__ringsLock);
+    LogRing** link = &__rings;
+    while (*link)
+      {
+        LogRing* ring = *link;
+        unsigned int head = ring->head;
+        __sync_synchronize();
+        while (ring->tail != head)
+          {
+            LogRecord* rec = &ring->records[ring->tail & (LogRingSize - 1)];
+            writeRecord(rec->level, rec->text);
+            __sync_synchronize();
+            ring->tail = ring->tail + 1;
+          }
+        unsigned int dropped = __sync_fetch_and_and(&ring->dropped, 0);
+        if (dropped)
+          {
+            char text[64];
+            snprintf(text, sizeof(text), "Logger dropped %u message(s).",
+                dropped);
+            writeRecord(LOG_WARNING, text);
+          }
+        if (ring->closed && ring->tail == ring->head)
+          {
+            *link = ring->next;
+            free(ring);
+          }
+        else
+          link = &ring->next;
+      }
+    // Flush under the lock too, so fork never sees stdio locked by us.
+    if (__file)
+      fflush(__file);
+    pthread_mutex_unlock(&__ringsLock);
+  }
+
+  void*
+  drainerMain(void*)
+  {
+    while (!__quit)
+      {
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_nsec += 100000000;
+        if (ts.tv_nsec >= 1000000000)
+          {
+            ts.tv_sec++;
+            ts.tv_nsec -= 1000000000;
+          }
+        while (sem_timedwait(&__drainSem, &ts) == -1 && errno == EINTR)
+          ;
+        drainRings();
+      }
+    drainRings();
+    return NULL;
+  }
+
+  void
+  releaseRing(void* data)
+  {
+    LogRing* ring = (LogRing*) data;
+    __sync_synchronize();
+    ring->closed = 1;
+  }
+
+  void
+  stopDrainer()
+  {
+    if (!__sync_bool_compare_and_swap(&__running, 1, 0))
+      return;
+    __quit = 1;
+    sem_post(&__drainSem);
+    pthread_join(__drainer, NULL);
+    sem_destroy(&__drainSem);
+  }
+
+  void
+  startDrainer()
+  {
+    if (!__sync_bool_compare_and_swap(&__running, 0, 1))
+      return;
+    __quit = 0;
+    sem_init(&__drainSem, 0, 0);
+    if (pthread_create(&__drainer, NULL, drainerMain, NULL) != 0)
+      {
+        sem_destroy(&__drainSem);
+        __running = 0;
+      }
+  }
+
+  void
+  flushAtExit()
+  {
+    stopDrainer();
+  }
+
+  /*
+   * Drainer writes to syslog and stdio only while holding __ringsLock, so
+   * holding it across fork keeps those locks free in the child.
+   */
+  void
+  lockForFork()
+  {
+    pthread_mutex_lock(&__filterLock);
+    pthread_mutex_lock(&__ringsLock);
+  }
+
+  void
+  unlockAfterFork()
+  {
+    pthread_mutex_unlock(&__ringsLock);
+    pthread_mutex_unlock(&__filterLock);
+  }
+
+  // Child has only the forking thread, rings of other threads are dead.
+  void
+  resetInChild()
+  {
+    unlockAfterFork();
+    __running = 0;
+    __rings = NULL;
+    __threadRing = NULL;
+  }
+
+  void
+  createRingKey()
+  {
+    pthread_key_create(&__ringKey, releaseRing);
+    pthread_atfork(lockForFork, unlockAfterFork, resetInChild);
+    atexit(flushAtExit);
+  }
+
+  LogRing*
+  threadRing()
+  {
+    if (__threadRing)
+      return __threadRing;
+    LogRing* ring = (LogRing*) calloc(1, sizeof(LogRing));
+    if (!ring)
+      return NULL;
+    pthread_once(&__ringKeyOnce, createRingKey);
+    pthread_setspecific(__ringKey, ring);
+    pthread_mutex_lock(&__ringsLock);
+    ring->next = __rings;
+    __rings = ring;
+    pthread_mutex_unlock(&__ringsLock);
+    __threadRing = ring;
+    return ring;
+  }
+
+  int
+  parseLevel(const char* name, size_t len)
+  {
+    if (len == 1 && name[0] >= '0' && name[0] <= '7')
+      return name[0] - '0';
+    for (int i = 0; i < 8; ++i)
+      if (strlen(__levelNames[i]) == len
+          && strncasecmp(__levelNames[i], name, len) == 0)
+        return i;
+    if (len == 3 && strncasecmp(name, "err", 3) == 0)
+      return LOG_ERR;
+    if (len == 4 && strncasecmp(name, "warn", 4) == 0)
+      return LOG_WARNING;
+    return -1;
+  }
+
+  // Returns true if category equals the len characters at name.
+  bool
+  matches(const char* category, const char* name, size_t len)
+  {
+    return strlen(category) == len && strncmp(category, name, len) == 0;
+  }
+}
+
 void
 ilixi::ilixi_log_init(char* ident, int facility)
 {
-#if ILIXI_LOG_DEBUG_ENABLED == 0
-  setlogmask(LOG_UPTO(LOG_NOTICE));
-#endif
-  if (facility)
-    openlog(ident, LOG_NDELAY | LOG_CONS | LOG_PID, facility);
-  else
-    openlog(ident, LOG_NDELAY | LOG_CONS | LOG_PID, LOG_USER);
+  pthread_once(&__ringKeyOnce, createRingKey);
+  snprintf(__ident, sizeof(__ident), "%s", ident ? ident : "ilixi");
+  __facility = facility ? facility : LOG_USER;
+
+  const char* path = getenv("ILIXI_LOG_FILE");
+  if (path && !__file)
+    __file = fopen(path, "a");
+  if (!__file)
+    openlog(ident, LOG_NDELAY | LOG_CONS | LOG_PID, __facility);
+
+  ilixi_log_set_filter(getenv("ILIXI_LOG_FILTER"));
+  __opened = 1;
+  startDrainer();
 }
 
 void
 ilixi::ilixi_log_close()
 {
-  closelog();
+  stopDrainer();
+  __opened = 0;
+  if (__file)
+    {
+      fclose(__file);
+      __file = NULL;
+    }
+  else
+    closelog();
 }
 
 void
 ilixi::ilixi_log(int level, const char* message, ...)
 {
+  if (__opened && !__running)
+    startDrainer();
+
+  LogRing* ring = (level > LOG_CRIT && __running) ? threadRing() : NULL;
+  if (ring)
+    {
+      unsigned int head = ring->head;
+      if (head - ring->tail >= LogRingSize)
+        {
+          __sync_fetch_and_add(&ring->dropped, 1);
+          return;
+        }
+      LogRecord* rec = &ring->records[head & (LogRingSize - 1)];
+      rec->level = level;
+      va_list args;
+      va_start(args, message);
+      vsnprintf(rec->text, LogTextSize, message, args);
+      va_end(args);
+      __sync_synchronize();
+      ring->head = head + 1;
+      if (head - ring->tail >= LogRingSize / 2)
+        sem_post(&__drainSem);
+      return;
+    }
+
+  char text[LogTextSize];
   va_list args;
   va_start(args, message);
-  vsyslog(level, message, args);
+  vsnprintf(text, LogTextSize, message, args);
   va_end(args);
+  writeRecord(level, text);
+  if (__file)
+    fflush(__file);
+}
+
+void
+ilixi::ilixi_log_set_filter(const char* filter)
+{
+  pthread_mutex_lock(&__filterLock);
+#if ILIXI_LOG_DEBUG_ENABLED
+  __defaultLevel = 7;
+#else
+  __defaultLevel = 5;
+#endif
+  __ruleCount = 0;
+  while (filter && *filter)
+    {
+      const char* end = strchr(filter, ',');
+      size_t len = end ? (size_t) (end - filter) : strlen(filter);
+      const char* eq = (const char*) memchr(filter, '=', len);
+      if (eq)
+        {
+          size_t catLen = eq - filter;
+          int level = parseLevel(eq + 1, len - catLen - 1);
+          if (level < 0 || catLen == 0 || catLen >= sizeof(__rules[0].category)
+              || __ruleCount == LogMaxRules)
+            fprintf(stderr, "ilixi: Ignoring log filter \"%.*s\"\n", (int) len,
+                filter);
+          else
+            {
+              memcpy(__rules[__ruleCount].category, filter, catLen);
+              __rules[__ruleCount].category[catLen] = 0;
+              __rules[__ruleCount++].level = level;
+            }
+        }
+      else if (len)
+        {
+          int level = parseLevel(filter, len);
+          if (level < 0)
+            fprintf(stderr, "ilixi: Ignoring log filter \"%.*s\"\n", (int) len,
+                filter);
+          else
+            __defaultLevel = level;
+        }
+      filter = end ? end + 1 : NULL;
+    }
+  __sync_fetch_and_add(&ilixi_log_generation, 1);
+  pthread_mutex_unlock(&__filterLock);
+}
+
+void
+ilixi::ilixi_log_resolve(LogSite* site)
+{
+  // e.g. "../../ilixi/layout/HBoxLayout.cpp", base is "HBoxLayout" and
+  // directory is "layout".
+  const char* file = site->file;
+  const char* slash = strrchr(file, '/');
+  const char* base = slash ? slash + 1 : file;
+  const char* dot = strchr(base, '.');
+  size_t baseLen = dot ? (size_t) (dot - base) : strlen(base);
+  const char* dir = NULL;
+  size_t dirLen = 0;
+  if (slash)
+    {
+      dir = slash;
+      while (dir > file && dir[-1] != '/')
+        --dir;
+      dirLen = slash - dir;
+    }
+
+  pthread_mutex_lock(&__filterLock);
+  int generation = ilixi_log_generation;
+  int level = __defaultLevel;
+  int dirLevel = -1;
+  for (unsigned int i = 0; i < __ruleCount; ++i)
+    {
+      if (matches(__rules[i].category, base, baseLen))
+        {
+          level = __rules[i].level;
+          dirLevel = -1;
+          break;
+        }
+      if (dir && matches(__rules[i].category, dir, dirLen))
+        dirLevel = __rules[i].level;
+    }
+  if (dirLevel >= 0)
+    level = dirLevel;
+  pthread_mutex_unlock(&__filterLock);
+
+  site->level = level;
+  __sync_synchronize();
+  site->generation = generation;
 }
 
 #endif
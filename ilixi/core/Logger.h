@@ -26,33 +26,114 @@
 
 #include "ilixiConfig.h"
 
+#ifndef ILIXI_LOG_LEVEL
+#define ILIXI_LOG_LEVEL 5
+#endif
+
 namespace ilixi
 {
 #if ILIXI_LOGGER_ENABLED
 
+  //! Caches filter level of a logging call site, see ilixi_log_enabled().
+  struct LogSite
+  {
+    //! Source file of call site, its base name and directory are categories.
+    const char* file;
+    //! Filter generation level was resolved for.
+    volatile int generation;
+    //! Messages up to this level are submitted.
+    volatile int level;
+  };
+
+  //! Incremented each time filter is changed.
+  extern volatile int ilixi_log_generation;
+
   /*!
-   * Opens a connection to Syslog in preparation for submitting messages.
+   * Opens a connection to Syslog in preparation for submitting messages and
+   * starts the thread which drains message rings.
+   *
+   * If ILIXI_LOG_FILE environment variable is set, messages are appended to
+   * this file instead of Syslog. Runtime filter is read from ILIXI_LOG_FILTER, see
+   * ilixi_log_set_filter().
    */
   void
   ilixi_log_init(char* ident, int facility = 0);
 
   /*!
-   * Closes the current Syslog connection.
+   * Drains pending messages and closes the current Syslog connection.
    */
   void
   ilixi_log_close();
 
   /*!
-   * Submits a message to the Syslog facility on the same system.
+   * Formats a message into calling thread's ring. Messages are submitted
+   * by a background thread, fatal messages are submitted immediately.
    */
   void
   ilixi_log(int level, const char* message, ...);
 
-#define ILOG_DEBUG(_fmt...)     ilixi_log(7, _fmt)
-#define ILOG_INFO(_fmt...)      ilixi_log(6, _fmt)
-#define ILOG_NOTICE(_fmt...)    ilixi_log(5, _fmt)
-#define ILOG_WARNING(_fmt...)   ilixi_log(4, _fmt)
-#define ILOG_ERROR(_fmt...)     ilixi_log(3, _fmt)
+  /*!
+   * Sets runtime filter. Filter is a comma separated list of levels with an
+   * optional category, e.g. "notice,ui=info,HBoxLayout=debug". Category is
+   * either the directory or the base name of a source file. Levels are syslog
+   * names or numbers; a level without category sets default level.
+   *
+   * @param filter NULL resets to default level.
+   */
+  void
+  ilixi_log_set_filter(const char* filter);
+
+  /*!
+   * Resolves filter level of a call site for current filter.
+   */
+  void
+  ilixi_log_resolve(LogSite* site);
+
+  /*!
+   * Returns true if a message at given level is submitted from call site.
+   */
+  inline bool
+  ilixi_log_enabled(LogSite* site, int level)
+  {
+    if (site->generation != ilixi_log_generation)
+      ilixi_log_resolve(site);
+    return level <= site->level;
+  }
+
+#define ILOG_SITE(_level, _fmt...)                                          \
+  do                                                                        \
+    {                                                                       \
+      static ilixi::LogSite _ilog_site = { __FILE__, -1, 0 };               \
+      if (ilixi::ilixi_log_enabled(&_ilog_site, _level))                    \
+        ilixi::ilixi_log(_level, _fmt);                                     \
+    }                                                                       \
+  while (0)
+
+#if ILIXI_LOG_LEVEL >= 7
+#define ILOG_DEBUG(_fmt...)     ILOG_SITE(7, _fmt)
+#else
+#define ILOG_DEBUG(_fmt...)     while(0)
+#endif
+#if ILIXI_LOG_LEVEL >= 6
+#define ILOG_INFO(_fmt...)      ILOG_SITE(6, _fmt)
+#else
+#define ILOG_INFO(_fmt...)      while(0)
+#endif
+#if ILIXI_LOG_LEVEL >= 5
+#define ILOG_NOTICE(_fmt...)    ILOG_SITE(5, _fmt)
+#else
+#define ILOG_NOTICE(_fmt...)    while(0)
+#endif
+#if ILIXI_LOG_LEVEL >= 4
+#define ILOG_WARNING(_fmt...)   ILOG_SITE(4, _fmt)
+#else
+#define ILOG_WARNING(_fmt...)   while(0)
+#endif
+#if ILIXI_LOG_LEVEL >= 3
+#define ILOG_ERROR(_fmt...)     ILOG_SITE(3, _fmt)
+#else
+#define ILOG_ERROR(_fmt...)     while(0)
+#endif
 #define ILOG_FATAL(_fmt...)     ilixi_log(2, _fmt)
 #define ILOG_OPEN(ident)        ilixi_log_init(ident)
 #define ILOG_CLOSE()            ilixi_log_close()
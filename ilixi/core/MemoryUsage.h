@@ -0,0 +1,76 @@
+/*
+ Copyright 2010, 2011 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ILIXI_MEMORYUSAGE_H_
+#define ILIXI_MEMORYUSAGE_H_
+
+namespace ilixi
+{
+  //! Memory held by widgets and windows, in bytes per category.
+  /*!
+   * Pixel buffers and images are computed from the size and format of
+   * DirectFB surfaces. cairo and pango do not report their allocations, so
+   * their state and fonts are estimated from the number of live objects
+   * using the sizes below.
+   *
+   * @sa Widget::memoryUsage()
+   */
+  struct MemoryUsage
+  {
+    MemoryUsage() :
+      pixels(0), cairo(0), pango(0), images(0), fonts(0)
+    {
+    }
+
+    //! Returns sum of all categories.
+    unsigned int
+    total() const
+    {
+      return pixels + cairo + pango + images + fonts;
+    }
+
+    //! Window surfaces and widget surfaces which own their pixels.
+    unsigned int pixels;
+    //! cairo surfaces and contexts.
+    unsigned int cairo;
+    //! Pango contexts and layouts, including layout text.
+    unsigned int pango;
+    //! Decoded images which are not shared with other processes.
+    unsigned int images;
+    //! Font descriptions.
+    unsigned int fonts;
+  };
+
+  //! Estimated size of a cairo surface, excluding its pixels.
+  const unsigned int MemoryCairoSurface = 512;
+  //! Estimated size of a cairo context and its graphics state.
+  const unsigned int MemoryCairoContext = 2048;
+  //! Estimated size of a Pango context.
+  const unsigned int MemoryPangoContext = 256;
+  //! Estimated size of a Pango layout, excluding its text.
+  const unsigned int MemoryPangoLayout = 512;
+  //! Estimated size of a Pango font description, excluding family name.
+  const unsigned int MemoryFontDescription = 64;
+}
+
+#endif /* ILIXI_MEMORYUSAGE_H_ */
@@ -0,0 +1,146 @@
+/*
+ Copyright 2010, 2011 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "core/MessageRing.h"
+
+using namespace ilixi;
+
+unsigned int
+ilixi::messageRingSize(unsigned int capacity)
+{
+  return sizeof(MessageRing) + (capacity - 1) * sizeof(ReactorMessage);
+}
+
+void
+ilixi::messageRingInit(MessageRing* ring, unsigned int capacity,
+    unsigned int owner)
+{
+  unsigned int size = 1;
+  while (size * 2 <= capacity)
+    size *= 2;
+  ring->head = 0;
+  ring->tail = 0;
+  ring->doorbell = 0;
+  ring->fence = 0;
+  ring->capacity = size;
+  ring->owner = owner;
+  ring->next = NULL;
+  __sync_synchronize();
+}
+
+bool
+ilixi::messageRingPush(MessageRing* ring, const ReactorMessage& message,
+    bool* notify)
+{
+  unsigned int head = ring->head;
+  if (head - ring->tail >= ring->capacity)
+    {
+      *notify = false;
+      return false;
+    }
+
+  ring->messages[head & (ring->capacity - 1)] = message;
+  // slot must be visible before consumer sees new head.
+  __sync_synchronize();
+  ring->head = head + 1;
+  __sync_synchronize();
+  *notify = __sync_bool_compare_and_swap(&ring->doorbell, 0, 1);
+  return true;
+}
+
+bool
+ilixi::messageRingPop(MessageRing* ring, ReactorMessage* message)
+{
+  unsigned int tail = ring->tail;
+  if (tail == ring->head)
+    return false;
+
+  __sync_synchronize();
+  *message = ring->messages[tail & (ring->capacity - 1)];
+  // slot must be read before producer is allowed to reuse it.
+  __sync_synchronize();
+  ring->tail = tail + 1;
+  return true;
+}
+
+bool
+ilixi::messageRingRelease(MessageRing* ring)
+{
+  ring->doorbell = 0;
+  __sync_synchronize();
+  if (ring->tail == ring->head)
+    return true;
+  // a producer which pushed before doorbell was cleared did not notify; take
+  // the doorbell back unless another producer push has already done so.
+  return !__sync_bool_compare_and_swap(&ring->doorbell, 0, 1);
+}
+
+void
+ilixi::messageRingAcknowledge(MessageRing* ring, unsigned int fence)
+{
+  // drained tail must be visible before producer pushes again.
+  __sync_synchronize();
+  ring->fence = fence;
+  __sync_synchronize();
+}
+
+bool
+ilixi::messageRingFenced(MessageRing* ring, unsigned int fence)
+{
+  __sync_synchronize();
+  return ring->fence == fence;
+}
+
+void
+ilixi::messageRingRetire(MessageRing** list, MessageRing* ring)
+{
+  MessageRing* head;
+  do
+    {
+      head = *list;
+      ring->next = head;
+    }
+  while (!__sync_bool_compare_and_swap(list, head, ring));
+}
+
+MessageRing*
+ilixi::messageRingTakeRetired(MessageRing** list, unsigned int owner)
+{
+  // producers only push, so consumer can take whole list and put back rings
+  // of other owners.
+  MessageRing* ring = __sync_lock_test_and_set(list, (MessageRing*) NULL);
+  MessageRing* found = NULL;
+  while (ring)
+    {
+      MessageRing* next = ring->next;
+      if (!found && ring->owner == owner)
+        {
+          found = ring;
+          found->next = NULL;
+        }
+      else
+        messageRingRetire(list, ring);
+      ring = next;
+    }
+  return found;
+}
@@ -0,0 +1,138 @@
+/*
+ Copyright 2010, 2011 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ILIXI_MESSAGERING_H_
+#define ILIXI_MESSAGERING_H_
+
+#include "core/IFusion.h"
+
+namespace ilixi
+{
+  //! Single producer, single consumer message queue inside shared memory.
+  /*!
+   * Each application owns a ring inside ilixiPool which carries its messages
+   * to Maestro. Producer and consumer never lock; indices are published using
+   * memory barriers. A doorbell flag makes sure consumer is woken up only
+   * once per batch: the producer which finds the flag cleared rings the
+   * doorbell (e.g. dispatches a RingDoorbell message over reactor) and all
+   * messages pushed until consumer drains the ring share that wakeup.
+   *
+   * If ring is full, producer sends over reactor instead and keeps doing so
+   * until consumer acknowledges a fence sent after the last of those
+   * messages, see messageRingAcknowledge().
+   *
+   * Only one thread may push at a time; AppBase serialises its producers.
+   * A producer never frees its ring, it hands the ring over to consumer
+   * using messageRingRetire() so that queued messages are not lost.
+   */
+  struct MessageRing
+  {
+    //! Index of next slot to write, modified by producer only.
+    volatile unsigned int head;
+    char headPadding[60];
+    //! Index of next slot to read, modified by consumer only.
+    volatile unsigned int tail;
+    //! Non-zero if consumer has been notified and has not drained ring yet.
+    volatile int doorbell;
+    //! Last fence acknowledged by consumer.
+    volatile unsigned int fence;
+    //! Number of slots, a power of two.
+    unsigned int capacity;
+    //! FusionID of producer.
+    unsigned int owner;
+    //! Next ring in list of retired rings.
+    MessageRing* next;
+    char tailPadding[32];
+    //! Message slots, capacity elements.
+    ReactorMessage messages[1];
+  };
+
+  /*!
+   * Returns number of bytes required for a ring with given capacity.
+   */
+  unsigned int
+  messageRingSize(unsigned int capacity);
+
+  /*!
+   * Initialises ring in already allocated memory. Capacity is rounded down to
+   * a power of two.
+   */
+  void
+  messageRingInit(MessageRing* ring, unsigned int capacity,
+      unsigned int owner = 0);
+
+  /*!
+   * Pushes a message to ring. Returns false if ring is full.
+   *
+   * @param ring message ring.
+   * @param message message to copy.
+   * @param notify set to true if caller must ring the doorbell.
+   */
+  bool
+  messageRingPush(MessageRing* ring, const ReactorMessage& message,
+      bool* notify);
+
+  /*!
+   * Pops a message from ring. Returns false if ring is empty.
+   */
+  bool
+  messageRingPop(MessageRing* ring, ReactorMessage* message);
+
+  /*!
+   * Called by consumer after ring is drained. Clears doorbell and returns
+   * true if consumer can wait for next doorbell, false if new messages
+   * arrived meanwhile and ring should be drained again.
+   */
+  bool
+  messageRingRelease(MessageRing* ring);
+
+  /*!
+   * Called by consumer once it handled a fence message and drained ring.
+   * Messages producer sent over reactor before the fence are handled by
+   * then, so producer may push to ring again.
+   */
+  void
+  messageRingAcknowledge(MessageRing* ring, unsigned int fence);
+
+  /*!
+   * Returns true if consumer has acknowledged given fence.
+   */
+  bool
+  messageRingFenced(MessageRing* ring, unsigned int fence);
+
+  /*!
+   * Adds ring to list of retired rings. Called by producer once it will not
+   * push anymore; consumer drains and frees the ring afterwards.
+   */
+  void
+  messageRingRetire(MessageRing** list, MessageRing* ring);
+
+  /*!
+   * Removes retired ring of owner from list and returns it, NULL if there is
+   * none. Only consumer may call this.
+   */
+  MessageRing*
+  messageRingTakeRetired(MessageRing** list, unsigned int owner);
+}
+
+#endif /* ILIXI_MESSAGERING_H_ */
@@ -0,0 +1,182 @@
+/*
+ Copyright 2010, 2011 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "core/OSKBuffer.h"
+#include <string.h>
+
+using namespace ilixi;
+
+namespace
+{
+  // Fills next slot in log and publishes it.
+  unsigned int
+  logEdit(OSKBuffer* buffer, OSKEditType type, unsigned int position,
+      const char* text, unsigned int length)
+  {
+    unsigned int sequence = buffer->sequence + 1;
+    OSKEdit* edit = &buffer->edits[sequence & (OSK_EDIT_LOG_SIZE - 1)];
+    edit->sequence = 0;
+    __sync_synchronize();
+    edit->type = type;
+    edit->position = position;
+    edit->length = length;
+    if (type == OSKInsert)
+      memcpy(edit->text, text, length);
+    __sync_synchronize();
+    edit->sequence = sequence;
+    __sync_synchronize();
+    buffer->sequence = sequence;
+    return sequence;
+  }
+
+  // text and sequence are modified together inside beginText/endText so that
+  // oskBufferText() returns a matching pair.
+  inline void
+  beginText(OSKBuffer* buffer)
+  {
+    buffer->textSequence++;
+    __sync_synchronize();
+  }
+
+  inline void
+  endText(OSKBuffer* buffer)
+  {
+    __sync_synchronize();
+    buffer->textSequence++;
+  }
+}
+
+unsigned int
+ilixi::oskBufferSize(unsigned int capacity)
+{
+  return sizeof(OSKBuffer) + capacity;
+}
+
+void
+ilixi::oskBufferInit(OSKBuffer* buffer, unsigned int capacity)
+{
+  memset(buffer, 0, sizeof(OSKBuffer));
+  buffer->capacity = capacity ? capacity : 1;
+  buffer->text[0] = 0;
+  __sync_synchronize();
+}
+
+unsigned int
+ilixi::oskBufferReset(OSKBuffer* buffer, const char* text, unsigned int length)
+{
+  if (length >= buffer->capacity)
+    length = buffer->capacity - 1;
+
+  beginText(buffer);
+  memcpy(buffer->text, text, length);
+  buffer->text[length] = 0;
+  buffer->length = length;
+  unsigned int sequence = logEdit(buffer, OSKReset, 0, NULL, length);
+  endText(buffer);
+  return sequence;
+}
+
+bool
+ilixi::oskBufferInsert(OSKBuffer* buffer, unsigned int position,
+    const char* text, unsigned int length)
+{
+  if (position > buffer->length || buffer->length + length
+      >= buffer->capacity)
+    return false;
+
+  while (length)
+    {
+      // do not split UTF-8 sequences so that each edit is valid text.
+      unsigned int chunk = length;
+      if (chunk > OSK_EDIT_TEXT_SIZE)
+        {
+          chunk = OSK_EDIT_TEXT_SIZE;
+          while (chunk > 1 && (text[chunk] & 0xC0) == 0x80)
+            --chunk;
+        }
+
+      beginText(buffer);
+      memmove(buffer->text + position + chunk, buffer->text + position,
+          buffer->length - position + 1);
+      memcpy(buffer->text + position, text, chunk);
+      buffer->length += chunk;
+      logEdit(buffer, OSKInsert, position, text, chunk);
+      endText(buffer);
+
+      position += chunk;
+      text += chunk;
+      length -= chunk;
+    }
+  return true;
+}
+
+bool
+ilixi::oskBufferErase(OSKBuffer* buffer, unsigned int position,
+    unsigned int length)
+{
+  if (position + length > buffer->length)
+    return false;
+
+  beginText(buffer);
+  memmove(buffer->text + position, buffer->text + position + length,
+      buffer->length - position - length + 1);
+  buffer->length -= length;
+  logEdit(buffer, OSKErase, position, NULL, length);
+  endText(buffer);
+  return true;
+}
+
+bool
+ilixi::oskBufferRead(OSKBuffer* buffer, unsigned int sequence, OSKEdit* edit)
+{
+  OSKEdit* slot = &buffer->edits[sequence & (OSK_EDIT_LOG_SIZE - 1)];
+  if (slot->sequence != sequence)
+    return false;
+  __sync_synchronize();
+  edit->type = slot->type;
+  edit->position = slot->position;
+  edit->length = slot->length;
+  memcpy(edit->text, slot->text, OSK_EDIT_TEXT_SIZE);
+  __sync_synchronize();
+  // slot is valid only if it was not reused while copying.
+  edit->sequence = slot->sequence;
+  return edit->sequence == sequence;
+}
+
+unsigned int
+ilixi::oskBufferText(OSKBuffer* buffer, std::string* text)
+{
+  unsigned int textSequence;
+  unsigned int sequence;
+  do
+    {
+      while ((textSequence = buffer->textSequence) & 1)
+        ;
+      __sync_synchronize();
+      sequence = buffer->sequence;
+      text->assign(buffer->text, buffer->length);
+      __sync_synchronize();
+    }
+  while (buffer->textSequence != textSequence);
+  return sequence;
+}
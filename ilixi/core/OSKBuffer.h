@@ -0,0 +1,136 @@
+/*
+ Copyright 2010, 2011 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ILIXI_OSKBUFFER_H_
+#define ILIXI_OSKBUFFER_H_
+
+#include "core/IFusion.h"
+#include <string>
+
+namespace ilixi
+{
+  //! Maximum number of bytes inserted by a single edit.
+  const unsigned int OSK_EDIT_TEXT_SIZE = 16;
+  //! Number of edits kept in OSKBuffer, a power of two.
+  const unsigned int OSK_EDIT_LOG_SIZE = 32;
+
+  /*!
+   * This enum specifies the type of an OSKEdit.
+   */
+  enum OSKEditType
+  {
+    OSKReset, //!< Whole text is replaced, read text from buffer.
+    OSKInsert, //!< Text is inserted at position.
+    OSKErase
+  //!< Length bytes are erased at position.
+  };
+
+  //! A single modification of OSK text.
+  struct OSKEdit
+  {
+    //! Sequence number of edit, 0 if slot is being written.
+    volatile unsigned int sequence;
+    //! Type of edit.
+    OSKEditType type;
+    //! Byte offset of edit.
+    unsigned int position;
+    //! Number of bytes inserted or erased.
+    unsigned int length;
+    //! Inserted bytes, not null terminated.
+    char text[OSK_EDIT_TEXT_SIZE];
+  };
+
+  //! OSK text inside shared memory with a log of recent edits.
+  /*!
+   * The focused application and OSK take turns to write text: application
+   * resets text as OSK is shown, OSK then logs an insert or erase for each
+   * key press. Readers apply edits in sequence order to their own copy, so
+   * per key press cost does not grow with text length. If a reader falls
+   * behind by more than OSK_EDIT_LOG_SIZE edits, it copies whole text.
+   *
+   * There is a single writer at a time; readers never lock.
+   */
+  struct OSKBuffer
+  {
+    //! Sequence number of last edit.
+    volatile unsigned int sequence;
+    //! Odd while text is modified.
+    volatile unsigned int textSequence;
+    //! Size of text in bytes including terminating null.
+    unsigned int capacity;
+    //! Length of text in bytes.
+    unsigned int length;
+    //! Recent edits indexed by sequence.
+    OSKEdit edits[OSK_EDIT_LOG_SIZE];
+    //! Null terminated text, capacity bytes.
+    char text[1];
+  };
+
+  /*!
+   * Returns number of bytes required for a buffer with given capacity.
+   */
+  unsigned int
+  oskBufferSize(unsigned int capacity);
+
+  /*!
+   * Initialises an empty buffer in already allocated memory.
+   */
+  void
+  oskBufferInit(OSKBuffer* buffer, unsigned int capacity);
+
+  /*!
+   * Replaces whole text, truncating it to capacity. Returns new sequence.
+   */
+  unsigned int
+  oskBufferReset(OSKBuffer* buffer, const char* text, unsigned int length);
+
+  /*!
+   * Inserts text at position. Text longer than OSK_EDIT_TEXT_SIZE is logged
+   * as several edits. Returns false if position is out of range or text does
+   * not fit.
+   */
+  bool
+  oskBufferInsert(OSKBuffer* buffer, unsigned int position, const char* text,
+      unsigned int length);
+
+  /*!
+   * Erases length bytes at position. Returns false if range is invalid.
+   */
+  bool
+  oskBufferErase(OSKBuffer* buffer, unsigned int position, unsigned int length);
+
+  /*!
+   * Copies edit with given sequence. Returns false if edit is no longer in
+   * log and reader should resynchronise using oskBufferText().
+   */
+  bool
+  oskBufferRead(OSKBuffer* buffer, unsigned int sequence, OSKEdit* edit);
+
+  /*!
+   * Copies whole text and returns sequence of last edit it reflects.
+   */
+  unsigned int
+  oskBufferText(OSKBuffer* buffer, std::string* text);
+}
+
+#endif /* ILIXI_OSKBUFFER_H_ */
@@ -0,0 +1,154 @@
+/*
+ Copyright 2010, 2011 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "core/PerfStats.h"
+#include "core/Trace.h"
+#include <pthread.h>
+#include <string.h>
+#include <algorithm>
+#include <map>
+
+using namespace ilixi;
+
+volatile int ilixi::perfStatsEnabled = 0;
+volatile int ilixi::perfFlashEnabled = 0;
+volatile int ilixi::perfStatsPaused = 0;
+
+namespace
+{
+  //! Number of frame timestamps kept for measuring frame rate.
+  const unsigned int FrameRingSize = 256;
+
+  typedef std::map<const void*, PerfWidgetCost> CostMap;
+
+  pthread_mutex_t statsLock = PTHREAD_MUTEX_INITIALIZER;
+  CostMap costs;
+  long long frameEnds[FrameRingSize];
+  unsigned int frameCount = 0;
+  unsigned int histogram[PerfHistogramBuckets];
+
+  bool
+  compareCost(const PerfWidgetCost& a, const PerfWidgetCost& b)
+  {
+    return a.time > b.time;
+  }
+}
+
+void
+ilixi::perfStatsEnable(bool enable)
+{
+  pthread_mutex_lock(&statsLock);
+  if (enable && !perfStatsEnabled)
+    {
+      costs.clear();
+      frameCount = 0;
+      memset(histogram, 0, sizeof(histogram));
+    }
+  perfStatsEnabled = enable;
+  pthread_mutex_unlock(&statsLock);
+}
+
+void
+ilixi::perfFrame(long long duration)
+{
+  if (perfStatsPaused)
+    return;
+  unsigned int ms = duration / 1000000;
+  unsigned int bucket = 0;
+  while (bucket < PerfHistogramBuckets - 1
+      && ms >= PerfHistogramBounds[bucket])
+    ++bucket;
+
+  pthread_mutex_lock(&statsLock);
+  frameEnds[frameCount % FrameRingSize] = traceNow();
+  ++frameCount;
+  ++histogram[bucket];
+  pthread_mutex_unlock(&statsLock);
+}
+
+void
+ilixi::perfCompose(const void* widget, const char* type, long long duration)
+{
+  if (perfStatsPaused)
+    return;
+  pthread_mutex_lock(&statsLock);
+  PerfWidgetCost& cost = costs[widget];
+  cost.widget = widget;
+  cost.type = type;
+  cost.time += duration;
+  cost.calls++;
+  pthread_mutex_unlock(&statsLock);
+}
+
+void
+ilixi::perfForget(const void* widget)
+{
+  pthread_mutex_lock(&statsLock);
+  costs.erase(widget);
+  pthread_mutex_unlock(&statsLock);
+}
+
+float
+ilixi::perfFPS()
+{
+  long long since = traceNow() - 1000000000LL;
+  unsigned int frames = 0;
+  pthread_mutex_lock(&statsLock);
+  unsigned int kept = std::min(frameCount, FrameRingSize);
+  while (frames < kept
+      && frameEnds[(frameCount - frames - 1) % FrameRingSize] > since)
+    ++frames;
+  pthread_mutex_unlock(&statsLock);
+  return frames;
+}
+
+unsigned int
+ilixi::perfHistogram(unsigned int* buckets)
+{
+  pthread_mutex_lock(&statsLock);
+  memcpy(buckets, histogram, sizeof(histogram));
+  unsigned int count = frameCount;
+  pthread_mutex_unlock(&statsLock);
+  return count;
+}
+
+unsigned int
+ilixi::perfTopWidgets(PerfWidgetCost* top, unsigned int n)
+{
+  if (!n)
+    return 0;
+  unsigned int count = 0;
+  pthread_mutex_lock(&statsLock);
+  for (CostMap::const_iterator it = costs.begin(); it != costs.end(); ++it)
+    {
+      if (count < n)
+        top[count++] = it->second;
+      else if (it->second.time > top[n - 1].time)
+        top[n - 1] = it->second;
+      else
+        continue;
+      std::sort(top, top + count, compareCost);
+    }
+  pthread_mutex_unlock(&statsLock);
+  return count;
+}
@@ -0,0 +1,103 @@
+/*
+ Copyright 2010, 2011 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ILIXI_PERFSTATS_H_
+#define ILIXI_PERFSTATS_H_
+
+namespace ilixi
+{
+  //! Set while frame and compose timings are collected.
+  extern volatile int perfStatsEnabled;
+
+  //! Set while damaged regions are flashed as they are repainted.
+  extern volatile int perfFlashEnabled;
+
+  //! Set while timings are ignored, e.g. while painting performance HUD.
+  extern volatile int perfStatsPaused;
+
+  //! Upper bounds of frame time histogram buckets in milliseconds.
+  const unsigned int PerfHistogramBounds[] =
+    { 4, 8, 16, 33, 50, 100, 200 };
+
+  //! Number of frame time histogram buckets, last one is unbounded.
+  const unsigned int PerfHistogramBuckets = 8;
+
+  //! Cumulative compose cost of a widget.
+  struct PerfWidgetCost
+  {
+    //! Widget, only used for identification.
+    const void* widget;
+    //! Mangled name of widget's dynamic type.
+    const char* type;
+    //! Total time spent in compose() in nanoseconds.
+    long long time;
+    //! Number of compose() calls.
+    unsigned int calls;
+  };
+
+  /*!
+   * Starts or stops collecting timings. Starting clears previous timings.
+   */
+  void
+  perfStatsEnable(bool enable);
+
+  /*!
+   * Records a painted frame which took duration nanoseconds.
+   */
+  void
+  perfFrame(long long duration);
+
+  /*!
+   * Records a compose() call of widget.
+   */
+  void
+  perfCompose(const void* widget, const char* type, long long duration);
+
+  /*!
+   * Removes widget, called as widget is destroyed.
+   */
+  void
+  perfForget(const void* widget);
+
+  /*!
+   * Returns number of frames painted during last second.
+   */
+  float
+  perfFPS();
+
+  /*!
+   * Returns total number of frames since timings were enabled and fills
+   * buckets with counts of frames per histogram bucket.
+   */
+  unsigned int
+  perfHistogram(unsigned int* buckets);
+
+  /*!
+   * Fills costs with the n widgets which have the highest compose time and
+   * returns their number.
+   */
+  unsigned int
+  perfTopWidgets(PerfWidgetCost* costs, unsigned int n);
+}
+
+#endif /* ILIXI_PERFSTATS_H_ */
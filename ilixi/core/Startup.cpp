@@ -0,0 +1,115 @@
+/*
+ Copyright 2010, 2011 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "core/Startup.h"
+#include <time.h>
+#include <string.h>
+
+using namespace ilixi;
+
+namespace
+{
+  StartupRecord localRecord;
+  StartupRecord* current = &localRecord;
+  long long imageBegin = 0;
+
+  // origin is set as libilixi is loaded.
+  struct StartupOrigin
+  {
+    StartupOrigin()
+    {
+      startupReset();
+    }
+  } startupOrigin;
+}
+
+long long
+ilixi::startupNow()
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1000000LL + now.tv_nsec / 1000;
+}
+
+void
+ilixi::startupReset()
+{
+  memset(current, 0, sizeof(StartupRecord));
+  current->origin = startupNow();
+}
+
+void
+ilixi::startupBegin(StartupPhase phase)
+{
+  long long now = startupNow() - current->origin;
+  if (phase == StartupImages)
+    {
+      imageBegin = now;
+      if (!current->imageCount)
+        current->begin[phase] = now;
+    }
+  else if (!current->begin[phase] && !current->end[phase])
+    current->begin[phase] = now;
+}
+
+void
+ilixi::startupEnd(StartupPhase phase)
+{
+  long long now = startupNow() - current->origin;
+  if (phase == StartupImages)
+    {
+      current->imageTime += now - imageBegin;
+      current->imageCount++;
+      current->end[phase] = now;
+    }
+  else if (!current->end[phase])
+    // mark a non-zero end, so that a phase is never recorded twice.
+    current->end[phase] = now > current->begin[phase] ? now
+        : current->begin[phase] + 1;
+}
+
+void
+ilixi::startupPublish(StartupRecord* record)
+{
+  if (!record)
+    record = &localRecord;
+  if (record != current)
+    memcpy(record, current, sizeof(StartupRecord));
+  current = record;
+}
+
+const StartupRecord*
+ilixi::startupRecord()
+{
+  return current;
+}
+
+const char*
+ilixi::startupPhaseName(StartupPhase phase)
+{
+  static const char* names[] =
+    { "Fusion", "DirectFB", "Designer", "Images", "Layout", "Paint", "Flip" };
+  if (phase < StartupPhaseCount)
+    return names[phase];
+  return "";
+}
@@ -0,0 +1,111 @@
+/*
+ Copyright 2010, 2011 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ILIXI_STARTUP_H_
+#define ILIXI_STARTUP_H_
+
+namespace ilixi
+{
+  /*!
+   * This enum specifies the phases of application startup which are timed.
+   */
+  enum StartupPhase
+  {
+    StartupFusion, //!< AppBase::joinFusion().
+    StartupDirectFB, //!< Window::initDFB().
+    StartupDesigner, //!< Designer construction and stylesheet parsing.
+    StartupImages, //!< Image decoding, accumulated over all images.
+    StartupLayout, //!< First tile() of a layout.
+    StartupPaint, //!< First paint of application window.
+    StartupFlip, //!< First flip of application window.
+    StartupPhaseCount
+  //!< Number of phases.
+  };
+
+  //! Startup timestamps of an application.
+  /*!
+   * Timestamps are microseconds relative to origin, which is the time
+   * libilixi is loaded or, for applications launched by Zygote, the time
+   * they are forked. A phase which is not reached yet has an end of 0.
+   */
+  struct StartupRecord
+  {
+    //! CLOCK_MONOTONIC time of origin in microseconds.
+    long long origin;
+    //! Start of each phase.
+    long long begin[StartupPhaseCount];
+    //! End of each phase.
+    long long end[StartupPhaseCount];
+    //! Total time spent decoding images.
+    long long imageTime;
+    //! Number of images decoded.
+    unsigned int imageCount;
+  };
+
+  /*!
+   * Returns CLOCK_MONOTONIC time in microseconds.
+   */
+  long long
+  startupNow();
+
+  /*!
+   * Clears all timestamps and sets origin to now.
+   */
+  void
+  startupReset();
+
+  /*!
+   * Marks start of phase. Only first occurrence is recorded, except for
+   * StartupImages.
+   */
+  void
+  startupBegin(StartupPhase phase);
+
+  /*!
+   * Marks end of phase.
+   */
+  void
+  startupEnd(StartupPhase phase);
+
+  /*!
+   * Copies timestamps recorded so far to record and records subsequent
+   * timestamps there, e.g. inside shared memory. If record is NULL,
+   * timestamps are copied back to process memory.
+   */
+  void
+  startupPublish(StartupRecord* record);
+
+  /*!
+   * Returns timestamps of this process.
+   */
+  const StartupRecord*
+  startupRecord();
+
+  /*!
+   * Returns a short name for phase.
+   */
+  const char*
+  startupPhaseName(StartupPhase phase);
+}
+
+#endif /* ILIXI_STARTUP_H_ */
@@ -30,7 +30,7 @@
 using namespace ilixi;
 
 Thread::Thread() :
-  _running(false), _code(0), _stackSize(0)
+  _running(false), _joinable(false), _code(0), _stackSize(0)
 {
   pthread_mutex_init(&_runMutex, NULL);
 }
@@ -39,6 +39,8 @@ Thread::~Thread()
 {
   if (_running)
     cancel();
+  else if (_joinable)
+    join();
   pthread_mutex_destroy(&_runMutex);
 }
 
@@ -47,6 +49,10 @@ Thread::start()
 {
   if (!_running)
     {
+      // reap previous run, otherwise its pthread and stack leak.
+      if (_joinable)
+        join();
+
       int rc = 0;
       pthread_attr_t attr;
       pthread_attr_t *attrp;
@@ -80,14 +86,24 @@ Thread::start()
             }
         }
 
+      // mark as running before thread is scheduled, so that an early join()
+      // or cancel() does not miss it.
+      pthread_mutex_lock(&_runMutex);
+      _running = true;
+      pthread_mutex_unlock(&_runMutex);
+
       rc = pthread_create(&_pThread, &attr, Thread::wrapper,
           reinterpret_cast<void*> (this));
 
       if (rc != 0)
         {
+          pthread_mutex_lock(&_runMutex);
+          _running = false;
+          pthread_mutex_unlock(&_runMutex);
           ILOG_ERROR("Unable to create thread: %d", rc);
           return false;
         }
+      _joinable = true;
 
       if (attrp != NULL)
         {
@@ -103,11 +119,14 @@ Thread::start()
 bool
 Thread::join()
 {
-  if (_running)
+  // _running is cleared by executeRun() once run() returns, so a finished
+  // thread still has to be joined.
+  if (_joinable)
     {
       void *status = NULL;
       int rc = 0;
       rc = pthread_join(_pThread, &status);
+      _joinable = false;
       pthread_mutex_lock(&_runMutex);
       _running = false;
       pthread_mutex_unlock(&_runMutex);
@@ -147,6 +166,7 @@ Thread::cancel()
         ILOG_ERROR("pthread_cancel: %d", rc);
 
       pthread_join(_pThread, &status);
+      _joinable = false;
       if (status != PTHREAD_CANCELED)
         {
           ILOG_ERROR("Thread returned unexpected result!");
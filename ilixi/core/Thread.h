@@ -103,6 +103,8 @@ namespace ilixi
   private:
     //! This property specifies whether thread is running.
     bool _running;
+    //! This property specifies whether thread was created and is not yet joined.
+    bool _joinable;
     //! This property stores the exit code.
     int _code;
     //! Stack size for thread.
@@ -0,0 +1,289 @@
+/*
+ Copyright 2010, 2011 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "core/Trace.h"
+#include "core/Logger.h"
+#include <cxxabi.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+using namespace ilixi;
+
+volatile int ilixi::traceEnabled = 0;
+
+namespace
+{
+  //! Number of events kept per thread, oldest events are overwritten.
+  const unsigned int TraceBufferSize = 32768;
+
+  struct TraceEvent
+  {
+    const char* name;
+    const char* arg;
+    bool mangled;
+    long long begin;
+    long long end;
+  };
+
+  struct TraceBuffer
+  {
+    //! Number of events recorded, index of next event modulo buffer size.
+    volatile unsigned int count;
+    //! Events belong to a previous recording if this is not traceGeneration.
+    volatile unsigned int generation;
+    int tid;
+    TraceBuffer* next;
+    TraceEvent events[TraceBufferSize];
+  };
+
+  pthread_mutex_t buffersLock = PTHREAD_MUTEX_INITIALIZER;
+  TraceBuffer* buffers = NULL;
+  int bufferCount = 0;
+  __thread TraceBuffer* threadBuffer = NULL;
+  //! Incremented to discard recorded events, buffers are reset by owners.
+  volatile unsigned int traceGeneration = 0;
+
+  char tracePath[256];
+  bool continuous = false;
+  volatile sig_atomic_t dumpRequested = 0;
+
+  TraceBuffer*
+  createBuffer()
+  {
+    TraceBuffer* buffer = (TraceBuffer*) calloc(1, sizeof(TraceBuffer));
+    if (!buffer)
+      return NULL;
+    pthread_mutex_lock(&buffersLock);
+    buffer->tid = ++bufferCount;
+    buffer->generation = traceGeneration;
+    buffer->next = buffers;
+    buffers = buffer;
+    pthread_mutex_unlock(&buffersLock);
+    return buffer;
+  }
+
+  void
+  sigusr2Handler(int)
+  {
+    dumpRequested = 1;
+  }
+
+  void
+  dumpAtExit()
+  {
+    if (continuous)
+      traceDump(tracePath);
+  }
+
+  // Writes s as a JSON string.
+  void
+  writeString(FILE* file, const char* s)
+  {
+    fputc('"', file);
+    for (; *s; ++s)
+      {
+        if (*s == '"' || *s == '\\')
+          fputc('\\', file);
+        if ((unsigned char) *s >= 0x20)
+          fputc(*s, file);
+      }
+    fputc('"', file);
+  }
+}
+
+long long
+ilixi::traceNow()
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+void
+ilixi::traceInit()
+{
+  static bool initialised = false;
+  if (initialised)
+    return;
+  initialised = true;
+
+  const char* path = getenv("ILIXI_TRACE");
+  if (path && *path)
+    {
+      int len = strlen(path);
+      if (len > 5 && !strcmp(path + len - 5, ".json"))
+        len -= 5;
+      snprintf(tracePath, sizeof(tracePath), "%.*s-%d.json", len, path,
+          getpid());
+      continuous = true;
+      atexit(dumpAtExit);
+      traceStart();
+    }
+  else
+    snprintf(tracePath, sizeof(tracePath), "/tmp/ilixi-trace-%d.json",
+        getpid());
+
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = sigusr2Handler;
+  sigemptyset(&action.sa_mask);
+  action.sa_flags = SA_RESTART;
+  sigaction(SIGUSR2, &action, NULL);
+}
+
+void
+ilixi::traceStart()
+{
+  // Preallocate buffer of calling thread, others are created as they record.
+  if (!threadBuffer)
+    threadBuffer = createBuffer();
+  __sync_synchronize();
+  traceEnabled = 1;
+  ILOG_NOTICE("Trace recording started.");
+}
+
+void
+ilixi::traceStop()
+{
+  traceEnabled = 0;
+  __sync_synchronize();
+  ILOG_NOTICE("Trace recording stopped.");
+}
+
+void
+ilixi::traceRecord(const char* name, const char* arg, bool mangled,
+    long long begin, long long end)
+{
+  TraceBuffer* buffer = threadBuffer;
+  if (!buffer)
+    {
+      buffer = threadBuffer = createBuffer();
+      if (!buffer)
+        return;
+    }
+  if (buffer->generation != traceGeneration)
+    {
+      buffer->count = 0;
+      buffer->generation = traceGeneration;
+    }
+  TraceEvent* event = &buffer->events[buffer->count % TraceBufferSize];
+  event->name = name;
+  event->arg = arg;
+  event->mangled = mangled;
+  event->begin = begin;
+  event->end = end;
+  __sync_synchronize();
+  buffer->count = buffer->count + 1;
+}
+
+bool
+ilixi::traceDump(const char* path)
+{
+  FILE* file = fopen(path, "w");
+  if (!file)
+    {
+      ILOG_ERROR("Cannot open trace file %s", path);
+      return false;
+    }
+
+  // Events recorded by other threads while writing may be torn, so recording
+  // is paused.
+  int enabled = traceEnabled;
+  traceEnabled = 0;
+  __sync_synchronize();
+
+  int pid = getpid();
+  unsigned int written = 0;
+  fputs("{\"traceEvents\":[", file);
+  pthread_mutex_lock(&buffersLock);
+  for (TraceBuffer* buffer = buffers; buffer; buffer = buffer->next)
+    {
+      if (buffer->generation != traceGeneration)
+        continue;
+      unsigned int count = buffer->count;
+      unsigned int first =
+          count > TraceBufferSize ? count - TraceBufferSize : 0;
+      for (unsigned int i = first; i < count; ++i)
+        {
+          const TraceEvent& event = buffer->events[i % TraceBufferSize];
+          fprintf(file, "%s\n{\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"name\":",
+              written++ ? "," : "", pid, buffer->tid);
+          writeString(file, event.name);
+          fprintf(file, ",\"ts\":%lld.%03lld,\"dur\":%lld.%03lld",
+              event.begin / 1000, event.begin % 1000,
+              (event.end - event.begin) / 1000,
+              (event.end - event.begin) % 1000);
+          if (event.arg)
+            {
+              char* demangled = NULL;
+              if (event.mangled)
+                {
+                  int status;
+                  demangled = abi::__cxa_demangle(event.arg, NULL, NULL,
+                      &status);
+                }
+              fputs(",\"args\":{\"class\":", file);
+              writeString(file, demangled ? demangled : event.arg);
+              fputc('}', file);
+              free(demangled);
+            }
+          fputc('}', file);
+        }
+    }
+  pthread_mutex_unlock(&buffersLock);
+  fputs("\n],\"displayTimeUnit\":\"ms\"}\n", file);
+  bool ok = !ferror(file);
+  fclose(file);
+
+  traceEnabled = enabled;
+  if (ok)
+    ILOG_NOTICE("Wrote %u trace events to %s", written, path);
+  else
+    ILOG_ERROR("Error writing trace file %s", path);
+  return ok;
+}
+
+void
+ilixi::tracePoll()
+{
+  if (!dumpRequested)
+    return;
+  dumpRequested = 0;
+  if (continuous)
+    traceDump(tracePath);
+  else if (traceEnabled)
+    {
+      traceStop();
+      traceDump(tracePath);
+      // Next recording starts from an empty trace. Writers may still be
+      // recording, so each buffer is reset by its owner on next record.
+      __sync_fetch_and_add(&traceGeneration, 1);
+    }
+  else
+    traceStart();
+}
@@ -0,0 +1,120 @@
+/*
+ Copyright 2010, 2011 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ILIXI_TRACE_H_
+#define ILIXI_TRACE_H_
+
+#include <typeinfo>
+
+namespace ilixi
+{
+  //! Set while trace events are recorded.
+  extern volatile int traceEnabled;
+
+  /*!
+   * Returns CLOCK_MONOTONIC time in nanoseconds.
+   */
+  long long
+  traceNow();
+
+  /*!
+   * Reads ILIXI_TRACE environment variable and installs SIGUSR2 handler.
+   *
+   * If ILIXI_TRACE is set to a file name, recording starts immediately and
+   * trace is written at exit and each time SIGUSR2 is received. Process id
+   * is inserted before .json extension, e.g. /tmp/app.json is written to
+   * /tmp/app-<pid>.json, so processes do not overwrite each other.
+   * Otherwise, SIGUSR2 toggles recording and trace is written to
+   * /tmp/ilixi-trace-<pid>.json when recording stops.
+   */
+  void
+  traceInit();
+
+  /*!
+   * Starts recording trace events into per-thread buffers.
+   */
+  void
+  traceStart();
+
+  /*!
+   * Stops recording trace events.
+   */
+  void
+  traceStop();
+
+  /*!
+   * Writes recorded events in Chrome trace event format to path. Trace can be
+   * loaded into chrome://tracing or Perfetto. Returns false on error.
+   */
+  bool
+  traceDump(const char* path);
+
+  /*!
+   * Performs a dump requested by SIGUSR2. Called from event loop.
+   */
+  void
+  tracePoll();
+
+  /*!
+   * Records a complete event. Name and arg must be string literals or
+   * otherwise outlive the trace. If mangled is true, arg is a type name
+   * from std::type_info and is demangled when written.
+   */
+  void
+  traceRecord(const char* name, const char* arg, bool mangled,
+      long long begin, long long end);
+
+  //! Records duration of its scope as a trace event.
+  class TraceScope
+  {
+  public:
+    TraceScope(const char* name, const char* arg = 0, bool mangled = false) :
+        _name(name), _arg(arg), _mangled(mangled), _begin(
+            traceEnabled ? traceNow() : 0)
+    {
+    }
+
+    ~TraceScope()
+    {
+      if (_begin && traceEnabled)
+        traceRecord(_name, _arg, _mangled, _begin, traceNow());
+    }
+
+  private:
+    const char* _name;
+    const char* _arg;
+    bool _mangled;
+    long long _begin;
+  };
+}
+
+//! Traces enclosing scope.
+#define ILIXI_TRACE(_name) \
+  ilixi::TraceScope _ilixi_trace_scope(_name)
+
+//! Traces enclosing scope with dynamic type of object as argument.
+#define ILIXI_TRACE_TYPE(_name, _object) \
+  ilixi::TraceScope _ilixi_trace_scope(_name, \
+      ilixi::traceEnabled ? typeid(_object).name() : 0, true)
+
+#endif /* ILIXI_TRACE_H_ */
@@ -26,12 +26,13 @@
 #include "ui/Widget.h"
 #include "ui/TextLayout.h"
 #include "core/Logger.h"
+#include "core/OSKBuffer.h"
 
 using namespace ilixi;
 
 UIManager::UIManager(Window* root) :
   _rootWindow(root), _focusedWidget(0), _exposedWidget(0), _grabbedWidget(0),
-      _oskWidget(0)
+      _oskWidget(0), _oskSequence(0), _first(NULL), _focusFirst(NULL)
 {
 }
 
@@ -72,7 +73,17 @@ UIManager::oskWidget() const
 void
 UIManager::reset()
 {
-  widgets.clear();
+  Widget* widget = _first;
+  while (widget)
+    {
+      Widget* next = widget->_uiNext;
+      widget->_uiPrev = widget->_uiNext = NULL;
+      widget->_focusPrev = widget->_focusNext = NULL;
+      widget->_registeredIn = NULL;
+      widget = next;
+    }
+  _first = NULL;
+  _focusFirst = NULL;
   _focusedWidget = 0;
   _exposedWidget = 0;
 }
@@ -82,9 +93,23 @@ UIManager::addWidget(Widget* widget)
 {
   if (!widget)
     return;
-  widgets.push_back(widget);
-  // FIXME no focused widget at start?
-  //  setFocusedWidget(widget);
+
+  Widget* previous = NULL;
+  if (widget->_parent)
+    {
+      Widget::WidgetList& siblings = widget->_parent->_children;
+      for (Widget::WidgetListReverseIterator it = siblings.rbegin(); it
+          != siblings.rend(); ++it)
+        {
+          if (*it == widget)
+            {
+              if (++it != siblings.rend())
+                previous = *it;
+              break;
+            }
+        }
+    }
+  insertWidget(widget, previous);
 }
 
 void
@@ -93,14 +118,28 @@ UIManager::removeWidget(Widget* widget)
   if (!widget)
     return;
 
-  for (widgetListIterator it = widgets.begin(); it != widgets.end(); ++it)
-    {
-      if ((Widget*) *it == widget)
-        {
-          widgets.erase(it);
-          break;
-        }
-    }
+  if (widget->_registeredIn)
+    widget->_registeredIn->unlinkWidget(widget);
+
+  if (_focusedWidget == widget)
+    _focusedWidget = NULL;
+  if (_exposedWidget == widget)
+    _exposedWidget = NULL;
+  if (_grabbedWidget == widget)
+    _grabbedWidget = NULL;
+  if (_oskWidget == widget)
+    _oskWidget = NULL;
+}
+
+void
+UIManager::updateFocusChain(Widget* widget)
+{
+  if (!widget)
+    return;
+  Widget* parent = widget->_parent;
+  Widget* anchor = focusAnchor(widget);
+  syncFocus(widget, !parent || (parent->visible() && parent->enabled()),
+      anchor);
 }
 
 bool
@@ -132,8 +171,8 @@ UIManager::setExposedWidget(Widget* widget, const PointerEvent& pointerEvent)
 bool
 UIManager::setFocusedWidget(Widget* widget)
 {
-  if (widget == _focusedWidget || widget == NULL
-      || !(widget->acceptsKeyInput()))
+  if (widget == _focusedWidget || widget == NULL || widget->_registeredIn
+      != this || !widget->_focusNext)
     return false;
 
   if (_focusedWidget)
@@ -174,57 +213,233 @@ UIManager::setOSKWidget(Widget* widget)
     {
       _oskWidget = tw;
       AppBase::appInstance->setOSKText(tw->text());
+      _oskSequence = AppBase::appInstance->maestroObject->OSK->sequence;
       AppBase::appInstance->callMaestro(OSKEvent, Visible);
     }
   return true;
 }
 
 void
-UIManager::selectNext(bool found, bool iter)
+UIManager::selectNext()
 {
-  for (widgetListIterator it = widgets.begin(); it != widgets.end(); ++it)
+  Widget* next = NULL;
+  if (_focusedWidget && _focusedWidget->_focusNext)
+    next = _focusedWidget->_focusNext;
+  else
     {
-      if (found && setFocusedWidget(*it))
-        return;
+      // focused widget left the chain, continue from its position in list.
+      if (_focusedWidget && _focusedWidget->_registeredIn == this)
+        for (Widget* w = _focusedWidget->_uiNext; w; w = w->_uiNext)
+          if (w->_focusNext)
+            {
+              next = w;
+              break;
+            }
+      if (!next)
+        next = _focusFirst;
+    }
+
+  if (next)
+    setFocusedWidget(next);
+}
 
-      if (*it == _focusedWidget)
-        found = true;
+void
+UIManager::selectPrevious()
+{
+  Widget* previous = NULL;
+  if (_focusedWidget && _focusedWidget->_focusPrev)
+    previous = _focusedWidget->_focusPrev;
+  else
+    {
+      if (_focusedWidget && _focusedWidget->_registeredIn == this)
+        for (Widget* w = _focusedWidget->_uiPrev; w; w = w->_uiPrev)
+          if (w->_focusNext)
+            {
+              previous = w;
+              break;
+            }
+      if (!previous && _focusFirst)
+        previous = _focusFirst->_focusPrev;
     }
 
-  if (iter)
-    return;
+  if (previous)
+    setFocusedWidget(previous);
+}
 
-  selectNext(true, true);
+void
+UIManager::applyOSKEdits(bool finished)
+{
+  TextLayout* tw = dynamic_cast<TextLayout*> (_oskWidget);
+  if (tw)
+    {
+      OSKBuffer* buffer = AppBase::appInstance->maestroObject->OSK;
+      OSKEdit edit;
+      while (_oskSequence != buffer->sequence)
+        {
+          if (!oskBufferRead(buffer, _oskSequence + 1, &edit) || edit.type
+              == OSKReset)
+            {
+              // fell behind log, copy whole text.
+              std::string text;
+              _oskSequence = oskBufferText(buffer, &text);
+              tw->setText(text);
+              break;
+            }
+          if (edit.type == OSKInsert)
+            tw->insertText(edit.position, std::string(edit.text, edit.length));
+          else
+            tw->eraseText(edit.position, edit.length);
+          _oskSequence = edit.sequence;
+        }
+    }
+  if (finished)
+    _oskWidget = NULL;
 }
 
 void
-UIManager::selectPrevious(bool found, bool iter)
+UIManager::insertWidget(Widget* widget, Widget* previous)
 {
-  for (widgetListReverseIterator it = widgets.rbegin(); it != widgets.rend(); ++it)
+  if (!widget)
+    return;
+
+  // a widget is listed after its parent, so parent must be listed first.
+  Widget* parent = widget->_parent;
+  if (parent && parent->_registeredIn != this && !(parent->_surfaceDesc
+      & RootWindow))
+    return;
+
+  if (widget->_registeredIn)
+    widget->_registeredIn->unlinkWidget(widget);
+
+  Widget* after = NULL;
+  if (previous && previous->_registeredIn == this)
     {
-      if (found && setFocusedWidget(*it))
-        return;
+      after = previous;
+      while (!after->_children.empty() && after->_children.back()->_registeredIn
+          == this)
+        after = after->_children.back();
+    }
+  else if (parent && parent->_registeredIn == this)
+    after = parent;
+
+  widget->_uiPrev = after;
+  widget->_uiNext = after ? after->_uiNext : _first;
+  if (widget->_uiNext)
+    widget->_uiNext->_uiPrev = widget;
+  if (after)
+    after->_uiNext = widget;
+  else
+    _first = widget;
+  widget->_registeredIn = this;
+
+  if (widget->acceptsKeyInput())
+    linkFocus(widget, focusAnchor(widget));
+}
+
+void
+UIManager::unlinkWidget(Widget* widget)
+{
+  unlinkFocus(widget);
 
-      if (*it == _focusedWidget)
-        found = true;
+  if (widget->_uiPrev)
+    widget->_uiPrev->_uiNext = widget->_uiNext;
+  else
+    _first = widget->_uiNext;
+  if (widget->_uiNext)
+    widget->_uiNext->_uiPrev = widget->_uiPrev;
+
+  widget->_uiPrev = widget->_uiNext = NULL;
+  widget->_registeredIn = NULL;
+}
+
+void
+UIManager::relinkChildren(Widget* parent)
+{
+  Widget* previous = NULL;
+  for (Widget::WidgetListIterator it = parent->_children.begin(); it
+      != parent->_children.end(); ++it)
+    {
+      if ((*it)->_registeredIn != this)
+        continue;
+      relinkSubtree(*it, previous);
+      previous = *it;
     }
+}
 
-  if (iter)
-    return;
+void
+UIManager::relinkSubtree(Widget* widget, Widget* previous)
+{
+  // pre-order, so parent and previous siblings are already in place.
+  insertWidget(widget, previous);
+  relinkChildren(widget);
+}
 
-  selectPrevious(true, true);
+Widget*
+UIManager::focusAnchor(Widget* widget) const
+{
+  Widget* anchor = widget->_uiPrev;
+  while (anchor && !anchor->_focusNext)
+    anchor = anchor->_uiPrev;
+  return anchor;
 }
 
 void
-UIManager::setOSKWidgetText(char* text)
+UIManager::linkFocus(Widget* widget, Widget* anchor)
 {
-  if (_oskWidget)
+  if (anchor)
     {
-      TextLayout* tw = dynamic_cast<TextLayout*> (_focusedWidget);
-      if (tw)
-        {
-          tw->setText(text);
-          _oskWidget = NULL;
-        }
+      widget->_focusPrev = anchor;
+      widget->_focusNext = anchor->_focusNext;
+    }
+  else if (_focusFirst)
+    {
+      widget->_focusPrev = _focusFirst->_focusPrev;
+      widget->_focusNext = _focusFirst;
+      _focusFirst = widget;
+    }
+  else
+    {
+      widget->_focusPrev = widget->_focusNext = widget;
+      _focusFirst = widget;
+      return;
+    }
+  widget->_focusPrev->_focusNext = widget;
+  widget->_focusNext->_focusPrev = widget;
+}
+
+void
+UIManager::unlinkFocus(Widget* widget)
+{
+  if (!widget->_focusNext)
+    return;
+
+  if (widget->_focusNext == widget)
+    _focusFirst = NULL;
+  else
+    {
+      widget->_focusPrev->_focusNext = widget->_focusNext;
+      widget->_focusNext->_focusPrev = widget->_focusPrev;
+      if (_focusFirst == widget)
+        _focusFirst = widget->_focusNext;
     }
+  widget->_focusPrev = widget->_focusNext = NULL;
+}
+
+void
+UIManager::syncFocus(Widget* widget, bool shown, Widget*& anchor)
+{
+  shown = shown && !(widget->_state & (DisabledState | InvisibleState));
+  bool focusable = shown && widget->_registeredIn == this
+      && (widget->_inputMethod & KeyInput);
+
+  if (focusable && !widget->_focusNext)
+    linkFocus(widget, anchor);
+  else if (!focusable && widget->_focusNext)
+    unlinkFocus(widget);
+  if (widget->_focusNext)
+    anchor = widget;
+
+  for (Widget::WidgetListIterator it = widget->_children.begin(); it
+      != widget->_children.end(); ++it)
+    syncFocus(*it, shown, anchor);
 }
@@ -23,7 +23,6 @@
 #ifndef ILIXI_FOCUSMANAGER_H_
 #define ILIXI_FOCUSMANAGER_H_
 
-#include <list>
 #include "types/Event.h"
 
 namespace ilixi
@@ -35,9 +34,15 @@ namespace ilixi
   //! Keeps track of focused and exposed widgets.
   /*!
    * This class is mainly used by window based widgets in order to forward key inputs inside application's main loop.
-   * Each widget that is placed inside a container within the window is added to an internal list.
+   * Each widget that is placed inside a container within the window is added to an internal list, in tree order.
    * This list is reconstructed every time window becomes visible. In addition, widget's use UIManager to create their
    * surfaces, i.e. a sub-surface of root window.
+   *
+   * List is intrusive, i.e. links are stored inside widgets, so adding or removing a widget does not allocate.
+   * Widgets which can accept key input are also linked in a circular focus chain, kept in tree order and updated
+   * as widgets are enabled, disabled, shown or hidden. Moving focus to next or previous widget is O(1). Linking a
+   * widget into focus chain walks back over preceding widgets which are not in focus chain, i.e. O(n) at worst;
+   * updateFocusChain() does this walk once and then updates the subtree in time linear to its size.
    */
   class UIManager
   {
@@ -91,17 +96,24 @@ namespace ilixi
     reset();
 
     /*!
-     * Adds widget to internal list.
+     * Adds widget to internal list, after its previous sibling and its children.
      */
     void
     addWidget(Widget* widget);
 
     /*!
-     * Removes widget from internal list.
+     * Removes widget from internal list and focus chain.
      */
     void
     removeWidget(Widget* widget);
 
+    /*!
+     * Adds or removes widget and its children to/from focus chain, depending on their
+     * visibility, enabled state and input method. Called by widget when these change.
+     */
+    void
+    updateFocusChain(Widget* widget);
+
     /*!
      * Sets widgets exposed flag and executes onEnter/onLeave methods of widgets.
      *
@@ -142,32 +154,27 @@ namespace ilixi
     setOSKWidget(Widget* widget);
 
     /*!
-     * Iterates internal list and selects next widget which is able to accept focus.
-     * <b> You should always use default arguments. </b>
-     *
-     * @param found
-     * @param iter
+     * Selects next widget in focus chain, wraps around at the end.
      */
     void
-    selectNext(bool found = false, bool iter = false);
+    selectNext();
 
     /*!
-     * Iterates internal list and selects previous widget which is able to accept focus.
-     * <b> You should always use default arguments. </b>
-     *
-     * @param found
-     * @param iter
+     * Selects previous widget in focus chain, wraps around at the beginning.
      */
     void
-    selectPrevious(bool found = false, bool iter = false);
+    selectPrevious();
 
+    /*!
+     * Applies edits made by OSK since last call to OSK widget.
+     *
+     * @param finished if true, OSK widget is released afterwards.
+     */
     void
-    setOSKWidgetText(char* text);
+    applyOSKEdits(bool finished);
 
   private:
-    typedef std::list<Widget*> widgetList;
-    typedef widgetList::iterator widgetListIterator;
-    typedef widgetList::reverse_iterator widgetListReverseIterator;
+    friend class Widget;
 
     //! Points to owner.
     Window* _rootWindow;
@@ -179,8 +186,50 @@ namespace ilixi
     Widget* _grabbedWidget;
     //! Widget that requested osk input.
     Widget* _oskWidget;
-    //! This vector holds widgets inside the layout.
-    widgetList widgets;
+    //! Sequence of last OSK edit applied to _oskWidget.
+    unsigned int _oskSequence;
+    //! First widget in internal list.
+    Widget* _first;
+    //! First widget in focus chain.
+    Widget* _focusFirst;
+
+    /*!
+     * Links widget into internal list after previous sibling and its children,
+     * or after its parent if previous is NULL.
+     */
+    void
+    insertWidget(Widget* widget, Widget* previous);
+
+    //! Unlinks widget from internal list and focus chain.
+    void
+    unlinkWidget(Widget* widget);
+
+    /*!
+     * Links children of parent and their descendants into internal list again, in their current order.
+     * Called by parent after its children are reordered.
+     */
+    void
+    relinkChildren(Widget* parent);
+
+    //! Links widget and its registered descendants after previous, see insertWidget().
+    void
+    relinkSubtree(Widget* widget, Widget* previous);
+
+    //! Returns closest widget in focus chain preceding widget in internal list, or NULL.
+    Widget*
+    focusAnchor(Widget* widget) const;
+
+    //! Links widget into focus chain after anchor, or at the beginning if anchor is NULL.
+    void
+    linkFocus(Widget* widget, Widget* anchor);
+
+    //! Unlinks widget from focus chain.
+    void
+    unlinkFocus(Widget* widget);
+
+    //! Updates focus chain for widget and its children, anchor is advanced in tree order.
+    void
+    syncFocus(Widget* widget, bool shown, Widget*& anchor);
   };
 }
 
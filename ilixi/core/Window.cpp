@@ -25,6 +25,9 @@
 #include "core/AppBase.h"
 #include "core/IFusion.h"
 #include "core/Logger.h"
+#include "core/Startup.h"
+#include "graphics/Surface.h"
+#include "graphics/SurfacePool.h"
 
 using namespace ilixi;
 
@@ -60,6 +63,19 @@ Window::DFBInterface()
   return _dfb;
 }
 
+IDirectFBDisplayLayer*
+Window::DFBLayer()
+{
+  return _layer;
+}
+
+void
+Window::setDFBInterface(IDirectFB* dfb)
+{
+  if (!_dfb)
+    _dfb = dfb;
+}
+
 IDirectFBSurface*
 Window::DFBSurface() const
 {
@@ -98,7 +114,7 @@ Window::showWindow(TransitionStyle style, int value1, int value2)
   pthread_mutex_lock(&_windowMutex);
 
   // detach parent window's event buffer
-  if (_parentWindow)
+  if (_parentWindow && _window)
     _parentWindow->_window->DetachEventBuffer(_window, _buffer);
 
   if (_activeWindow)
@@ -110,6 +126,13 @@ Window::showWindow(TransitionStyle style, int value1, int value2)
   _activeWindow = this;
   _activeWindow->_windowUIManager->selectNext();
 
+  // headless windows are not managed by a window manager.
+  if (!_window)
+    {
+      pthread_mutex_unlock(&_windowMutex);
+      return;
+    }
+
   // make visible
   _window->RaiseToTop(_window);
 
@@ -161,6 +184,15 @@ Window::hideWindow(TransitionStyle style, int value1, int value2)
 {
   pthread_mutex_lock(&_windowMutex);
 
+  if (!_window)
+    {
+      if (_parentWindow)
+        _activeWindow = _parentWindow;
+      _windowUIManager->setExposedWidget(0, PointerEvent(PointerMotion, 0, 0));
+      pthread_mutex_unlock(&_windowMutex);
+      return;
+    }
+
   // detach event buffer
   _window->DetachEventBuffer(_window, _buffer);
   _buffer->Reset(_buffer);
@@ -219,10 +251,11 @@ Window::closeWindow()
 {
   pthread_mutex_lock(&_windowMutex);
 
-  _window->Close(_window);
+  if (_window)
+    _window->Close(_window);
 
   // attach parent window's event buffer
-  if (_parentWindow)
+  if (_parentWindow && _window)
     {
       _activeWindow = _parentWindow;
       _parentWindow->_window->AttachEventBuffer(_window, _buffer);
@@ -235,25 +268,29 @@ Window::closeWindow()
 void
 Window::moveWindowTo(int x, int y)
 {
-  _window->MoveTo(_window, x, y);
+  if (_window)
+    _window->MoveTo(_window, x, y);
 }
 
 void
 Window::resizeWindow(int width, int height)
 {
-  _window->Resize(_window, width, height);
+  if (_window)
+    _window->Resize(_window, width, height);
 }
 
 void
 Window::setBounds(int x, int y, int width, int height)
 {
-  _window->SetBounds(_window, x, y, width, height);
+  if (_window)
+    _window->SetBounds(_window, x, y, width, height);
 }
 
 void
 Window::setRotation(int rotation)
 {
-  _window->SetRotation(_window, rotation);
+  if (_window)
+    _window->SetRotation(_window, rotation);
 }
 
 void
@@ -262,11 +299,29 @@ Window::initDFB(int argc, char **argv)
   ILOG_DEBUG( "Initialising DirectFB interface...");
   if (!_dfb)
     {
+      startupBegin(StartupDirectFB);
       DFBCHECK(DirectFBInit(&argc, &argv));
       DirectFBCreate(&_dfb);
-      DFBCHECK(_dfb->GetDisplayLayer(_dfb, DLID_PRIMARY, &_layer));
-      _layer->GetConfiguration(_layer, &_layerConfig);
+      if (AppBase::headless())
+        {
+          // Layer is not used, its size is taken from ILIXI_HEADLESS.
+          _layerConfig.flags = (DFBDisplayLayerConfigFlags) (DLCONF_WIDTH
+              | DLCONF_HEIGHT | DLCONF_PIXELFORMAT);
+          _layerConfig.width = 800;
+          _layerConfig.height = 480;
+          _layerConfig.pixelformat = _pixelFormat;
+          sscanf(getenv("ILIXI_HEADLESS"), "%dx%d", &_layerConfig.width,
+              &_layerConfig.height);
+          ILOG_INFO("Headless layer is %dx%d.", _layerConfig.width,
+              _layerConfig.height);
+        }
+      else
+        {
+          DFBCHECK(_dfb->GetDisplayLayer(_dfb, DLID_PRIMARY, &_layer));
+          _layer->GetConfiguration(_layer, &_layerConfig);
+        }
       DFBCHECK(_dfb->CreateEventBuffer(_dfb, &_buffer));
+      startupEnd(StartupDirectFB);
       ILOG_DEBUG("DirectFB interface is ready.");
     }
 }
@@ -280,6 +335,12 @@ Window::initDFBWindow(int x, int y, int w, int h, bool dialog)
       exit( EXIT_FAILURE);
     }
 
+  if (AppBase::headless())
+    {
+      initHeadlessWindow(x, y, w, h);
+      return;
+    }
+
   if (_window && dialog)
     {
       _window->SetBounds(_window, x, y, w, h);
@@ -340,18 +401,84 @@ Window::initDFBWindow(int x, int y, int w, int h, bool dialog)
     }
 }
 
+void
+Window::initHeadlessWindow(int x, int y, int w, int h)
+{
+  w = w ? w : _layerConfig.width;
+  h = h ? h : _layerConfig.height
+      - AppBase::appInstance->getStatusBarHeight();
+  if (_windowSurface && _windowDesc.width == w && _windowDesc.height == h)
+    {
+      _windowUIManager->reset();
+      return;
+    }
+
+  ILOG_DEBUG("Initialising headless window surface %dx%d...", w, h);
+  if (_windowSurface)
+    _windowSurface->Release(_windowSurface);
+  else
+    {
+      static DFBWindowID headlessID = 0;
+      _parentWindow = _activeWindow;
+      pthread_mutex_lock(&_windowMutex);
+      _DFBwindowID = ++headlessID;
+      _windowCount++;
+      _windowID = _windowList.size();
+      _windowList.push_back(this);
+      pthread_mutex_unlock(&_windowMutex);
+    }
+
+  _windowDesc.flags = (DFBWindowDescriptionFlags) (DWDESC_POSX | DWDESC_POSY
+      | DWDESC_WIDTH | DWDESC_HEIGHT | DWDESC_PIXELFORMAT);
+  _windowDesc.posx = x;
+  _windowDesc.posy = y < 0 ? AppBase::appInstance->getStatusBarHeight() : y;
+  _windowDesc.width = w;
+  _windowDesc.height = h;
+  _windowDesc.pixelformat = _pixelFormat;
+
+  DFBSurfaceDescription desc;
+  desc.flags = (DFBSurfaceDescriptionFlags) (DSDESC_WIDTH | DSDESC_HEIGHT
+      | DSDESC_PIXELFORMAT | DSDESC_CAPS);
+  desc.width = w;
+  desc.height = h;
+  desc.pixelformat = _pixelFormat;
+  desc.caps = (DFBSurfaceCapabilities) (DSCAPS_SYSTEMONLY
+      | DSCAPS_PREMULTIPLIED | (_doubleBuffered ? DSCAPS_DOUBLE : DSCAPS_NONE));
+  DFBCHECK(_dfb->CreateSurface(_dfb, &desc, &_windowSurface));
+  _windowSurface->Clear(_windowSurface, 0, 0, 0, 0);
+  _windowUIManager->reset();
+}
+
+bool
+Window::dumpWindow(const char* directory, const char* prefix) const
+{
+  if (!_windowSurface)
+    return false;
+  DFBResult ret = _windowSurface->Dump(_windowSurface, directory, prefix);
+  if (ret)
+    {
+      ILOG_ERROR("Cannot dump window surface to %s: %d", directory, ret);
+      return false;
+    }
+  return true;
+}
+
 void
 Window::releaseWindow()
 {
-  if (_window)
+  if (_window || _windowSurface)
     {
       ILOG_DEBUG( "Releasing DirectFB window interfaces...");
-      _windowSurface->Release(_windowSurface);
+      if (_windowSurface)
+        _windowSurface->Release(_windowSurface);
       _windowSurface = NULL;
-      _window->Close(_window);
-      _window->Destroy(_window);
-      _window->Release(_window);
-      _window = NULL;
+      if (_window)
+        {
+          _window->Close(_window);
+          _window->Destroy(_window);
+          _window->Release(_window);
+          _window = NULL;
+        }
       pthread_mutex_lock(&_windowMutex);
       _windowCount--;
       for (windowListIterator it = _windowList.begin(); it != _windowList.end(); ++it)
@@ -367,6 +494,30 @@ Window::releaseWindow()
     }
 }
 
+unsigned int
+Window::releaseWindowSurface()
+{
+  if (!_window || !_windowSurface)
+    return 0;
+  unsigned int bytes = Surface::memoryUsage(_windowSurface);
+  _windowSurface->Release(_windowSurface);
+  _windowSurface = NULL;
+  _window->ResizeSurface(_window, 1, 1);
+  ILOG_DEBUG("Window surface is released.");
+  return bytes;
+}
+
+void
+Window::restoreWindowSurface()
+{
+  if (_window && !_windowSurface)
+    {
+      _window->ResizeSurface(_window, _windowDesc.width, _windowDesc.height);
+      _window->GetSurface(_window, &_windowSurface);
+      ILOG_DEBUG("Window surface is restored.");
+    }
+}
+
 bool
 Window::handleWindowEvent(const DFBWindowEvent& event)
 {
@@ -386,9 +537,12 @@ Window::releaseDFB()
   if (_dfb)
     {
       ILOG_DEBUG("Releasing DirectFB interfaces...");
+      surfacePoolTrim(true);
       _buffer->Release(_buffer);
       ILOG_DEBUG("Releasing layer...");
-      _layer->Release(_layer);
+      if (_layer)
+        _layer->Release(_layer);
+      _layer = NULL;
       _dfb->Release(_dfb);
       _dfb = NULL;
       _activeWindow = NULL;
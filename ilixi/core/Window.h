@@ -25,6 +25,7 @@
 #define ILIXI_WINDOW_H_
 
 #include <directfb.h>
+#include <list>
 #include "core/Thread.h"
 #include "core/UIManager.h"
 
@@ -63,6 +64,19 @@ namespace ilixi
     static IDirectFB*
     DFBInterface();
 
+    /*!
+     * Sets DirectFB interface for processes which do not create windows,
+     * e.g. Maestro decoding theme images. Does nothing if already set.
+     */
+    static void
+    setDFBInterface(IDirectFB* dfb);
+
+    /*!
+     * Returns primary display layer, or NULL if no window was created.
+     */
+    static IDirectFBDisplayLayer*
+    DFBLayer();
+
     /*!
      * Returns DirectFB window interface.
      */
@@ -121,6 +135,16 @@ namespace ilixi
     void
     setRotation(int rotation);
 
+    /*!
+     * Writes window surface to directory as prefix_NNNN.ppm, with alpha
+     * channel in a separate .pgm file. This is useful for comparing pixels
+     * rendered in headless mode, see AppBase::headless().
+     *
+     * @return false if window has no surface or writing fails.
+     */
+    bool
+    dumpWindow(const char* directory, const char* prefix) const;
+
   protected:
     DFBWindowDescription _windowDesc;
 
@@ -167,12 +191,32 @@ namespace ilixi
     initDFBWindow(int x = 0, int y = -1, int w = 0, int h = 0,
         bool dialog = false);
 
+    /*!
+     * Creates or resizes a system memory surface for window in headless
+     * mode. Window has no DirectFB window interface and receives no input.
+     */
+    void
+    initHeadlessWindow(int x, int y, int w, int h);
+
     /*!
      * Release DirectFB window interfaces.
      */
     void
     releaseWindow();
 
+    /*!
+     * Shrinks window surface to a single pixel in order to free its buffers
+     * while window is hidden. Returns number of bytes freed.
+     */
+    unsigned int
+    releaseWindowSurface();
+
+    /*!
+     * Resizes window surface back to window size if it was released.
+     */
+    void
+    restoreWindowSurface();
+
     /*!
      * Behaviour is dependant on incoming event type. Key events are sent to focused widget.
      * Pointer events are consumed by the widget which contains the event coordinates. If two or more
@@ -0,0 +1,258 @@
+/*
+ Copyright 2010, 2011 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "core/Zygote.h"
+#include "core/Logger.h"
+#include "core/Startup.h"
+#include "ilixiConfig.h"
+#include <pango/pangocairo.h>
+#include <libxml/parser.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <sys/prctl.h>
+#include <dlfcn.h>
+#include <signal.h>
+#include <unistd.h>
+#include <limits.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <libgen.h>
+
+using namespace ilixi;
+
+namespace
+{
+  // Abstract socket name, leading null is added by zygoteAddress().
+  const char zygoteName[] = "ilixi-zygote";
+
+  socklen_t
+  zygoteAddress(sockaddr_un* address)
+  {
+    memset(address, 0, sizeof(sockaddr_un));
+    address->sun_family = AF_UNIX;
+    memcpy(address->sun_path + 1, zygoteName, sizeof(zygoteName) - 1);
+    return offsetof(sockaddr_un, sun_path) + sizeof(zygoteName);
+  }
+}
+
+Zygote::Zygote() :
+  _pid(-1), _socket(-1)
+{
+}
+
+Zygote::~Zygote()
+{
+  stop();
+}
+
+bool
+Zygote::start(char* const preload[])
+{
+  if (_pid > 0)
+    return true;
+
+  // bind in parent, so that launch() succeeds as soon as start() returns.
+  _socket = socket(AF_UNIX, SOCK_STREAM, 0);
+  sockaddr_un address;
+  socklen_t length = zygoteAddress(&address);
+  if (_socket < 0 || bind(_socket, (sockaddr*) &address, length) < 0
+      || listen(_socket, 8) < 0)
+    {
+      ILOG_ERROR("Unable to create zygote socket!");
+      if (_socket >= 0)
+        close(_socket);
+      _socket = -1;
+      return false;
+    }
+
+  _pid = ::fork();
+  if (_pid < 0)
+    {
+      ILOG_ERROR("Unable to fork zygote!");
+      close(_socket);
+      _socket = -1;
+      return false;
+    }
+  else if (_pid == 0)
+    {
+      run(preload);
+      _exit(EXIT_SUCCESS);
+    }
+
+  close(_socket);
+  _socket = -1;
+  ILOG_DEBUG("Zygote (%d) is running...", _pid);
+  return true;
+}
+
+void
+Zygote::stop()
+{
+  if (_pid > 0)
+    {
+      kill(_pid, SIGTERM);
+      waitpid(_pid, NULL, 0);
+      _pid = -1;
+    }
+}
+
+pid_t
+Zygote::pid() const
+{
+  return _pid;
+}
+
+pid_t
+Zygote::launch(const char* path)
+{
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0)
+    return -1;
+
+  sockaddr_un address;
+  socklen_t length = zygoteAddress(&address);
+  pid_t child = -1;
+  if (connect(fd, (sockaddr*) &address, length) == 0)
+    {
+      if (write(fd, path, strlen(path) + 1) == (ssize_t) strlen(path) + 1)
+        {
+          if (read(fd, &child, sizeof(child)) != sizeof(child))
+            child = -1;
+        }
+    }
+  close(fd);
+  return child;
+}
+
+void
+Zygote::run(char* const preload[])
+{
+  // exit with Maestro; launched applications are reaped automatically.
+  prctl(PR_SET_PDEATHSIG, SIGTERM);
+  signal(SIGCHLD, SIG_IGN);
+
+  // initialise libraries whose state survives fork().
+  xmlInitParser();
+  PangoFontMap* fontMap = pango_cairo_font_map_get_default();
+  PangoContext* context = pango_font_map_create_context(fontMap);
+  PangoFontDescription* description = pango_font_description_from_string(
+      "sans 10");
+  // font is kept loaded so that fontconfig caches remain populated.
+  pango_context_load_font(context, description);
+  pango_font_description_free(description);
+
+  if (preload)
+    for (int i = 0; preload[i]; ++i)
+      entry(preload[i]);
+
+  ILOG_NOTICE("Zygote (pid: %d) is ready.", getpid());
+  while (1)
+    {
+      int client = accept(_socket, NULL, NULL);
+      if (client < 0)
+        continue;
+
+      // only serve processes of the same user.
+      ucred credentials;
+      socklen_t size = sizeof(credentials);
+      if (getsockopt(client, SOL_SOCKET, SO_PEERCRED, &credentials, &size)
+          != 0 || credentials.uid != getuid())
+        {
+          ILOG_ERROR("Zygote request from unauthorised process!");
+          close(client);
+          continue;
+        }
+
+      char path[PATH_MAX];
+      unsigned int length = 0;
+      while (length < sizeof(path) && read(client, path + length, 1) == 1)
+        if (path[length++] == 0)
+          break;
+
+      pid_t child = -1;
+      if (length && path[length - 1] == 0)
+        child = fork(path, client);
+      write(client, &child, sizeof(child));
+      close(client);
+    }
+}
+
+ZygoteEntry
+Zygote::entry(const char* path)
+{
+  std::map<std::string, ZygoteEntry>::iterator it = _entries.find(path);
+  if (it != _entries.end())
+    return it->second;
+
+  char* name = strdup(path);
+  std::string module = std::string(ILIXI_MODULEDIR) + basename(name) + ".so";
+  free(name);
+
+  ZygoteEntry main = NULL;
+  void* handle = dlopen(module.c_str(), RTLD_NOW | RTLD_GLOBAL);
+  if (handle)
+    {
+      main = (ZygoteEntry) dlsym(handle, "ilixi_main");
+      if (!main)
+        ILOG_ERROR("%s has no ilixi_main!", module.c_str());
+    }
+  else
+    ILOG_DEBUG("Zygote can not load %s: %s", module.c_str(), dlerror());
+
+  // negative results are cached too, so that missing modules are probed once.
+  _entries[path] = main;
+  return main;
+}
+
+pid_t
+Zygote::fork(const char* path, int client)
+{
+  ZygoteEntry main = entry(path);
+  if (!main)
+    return -1;
+
+  // child must not inherit and flush zygote's buffered output.
+  fflush(NULL);
+  pid_t child = ::fork();
+  if (child == 0)
+    {
+      startupReset();
+      close(_socket);
+      close(client);
+      signal(SIGCHLD, SIG_DFL);
+      prctl(PR_SET_PDEATHSIG, 0);
+
+      char* argv[] =
+        { strdup(path), NULL };
+      int code = main(1, argv);
+      // application has cleaned up when main returns, atexit handlers
+      // registered by zygote must not run in child.
+      fflush(NULL);
+      _exit(code);
+    }
+  else if (child < 0)
+    ILOG_ERROR("Zygote can not fork %s!", path);
+  return child;
+}
@@ -0,0 +1,126 @@
+/*
+ Copyright 2010, 2011 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ILIXI_ZYGOTE_H_
+#define ILIXI_ZYGOTE_H_
+
+#include <sys/types.h>
+#include <string>
+#include <map>
+
+namespace ilixi
+{
+  //! Entry point exported by application modules as "ilixi_main".
+  typedef int
+  (*ZygoteEntry)(int argc, char* argv[]);
+
+  //! Launches applications by forking a pre-initialised process.
+  /*!
+   * Maestro forks a zygote before it connects to DirectFB and fusion. The
+   * zygote loads shared libraries, fontconfig and pango font maps and
+   * application modules once; each launch request is then served by a fork()
+   * which runs the module's ilixi_main() with these pages already mapped and
+   * relocated.
+   *
+   * An application module is the application built as a loadable module
+   * named after its executable, e.g. ILIXI_MODULEDIR"ilixi_home.so", exporting
+   * ZygoteEntry ilixi_main. DirectFB and fusion connections can not be shared
+   * across fork(), so applications still create their own.
+   *
+   * Applications are launched using launch(). If there is no zygote or no
+   * module for a path, callers should fall back to posix_spawn().
+   *
+   * Since DirectFB, fusion and designer are initialised by each application
+   * after fork(), gain over posix_spawn() is limited to loading and
+   * relocation. Maestro starts zygote only if ZYGOTE is enabled in
+   * maestro.conf.
+   */
+  class Zygote
+  {
+  public:
+    /*!
+     * Constructor.
+     */
+    Zygote();
+
+    /*!
+     * Destructor, stops zygote.
+     */
+    ~Zygote();
+
+    /*!
+     * Forks zygote process. Must be called before caller opens any DirectFB
+     * or fusion connections.
+     *
+     * @param preload NULL terminated list of application paths whose
+     * modules are loaded in advance.
+     * @return true if zygote is running.
+     */
+    bool
+    start(char* const preload[] = NULL);
+
+    /*!
+     * Terminates zygote. Launched applications keep running.
+     */
+    void
+    stop();
+
+    /*!
+     * Returns pid of zygote or -1 if it is not running.
+     */
+    pid_t
+    pid() const;
+
+    /*!
+     * Asks running zygote to launch application at path.
+     *
+     * @return pid of application, or -1 if zygote is not running or there
+     * is no module for path.
+     */
+    static pid_t
+    launch(const char* path);
+
+  private:
+    //! pid of zygote process.
+    pid_t _pid;
+    //! Listening socket, valid inside zygote only.
+    int _socket;
+    //! Entry points of loaded modules by application path.
+    std::map<std::string, ZygoteEntry> _entries;
+
+    //! Loads runtime and preloaded modules, then serves requests.
+    void
+    run(char* const preload[]);
+
+    //! Loads module for path if needed. Returns NULL if there is none.
+    ZygoteEntry
+    entry(const char* path);
+
+    //! Forks application for path and returns its pid. Zygote sockets,
+    //! including client connection, are closed in application.
+    pid_t
+    fork(const char* path, int client);
+  };
+}
+
+#endif /* ILIXI_ZYGOTE_H_ */
@@ -0,0 +1,371 @@
+/*
+ Copyright 2010, 2011 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "graphics/ColorConversion.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define ILIXI_YUV_SSE2
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define ILIXI_YUV_NEON
+#endif
+
+using namespace ilixi;
+
+// BT.601 studio swing coefficients scaled by 64, small enough for 16 bit lanes.
+enum
+{
+  CoeffY = 74, CoeffRV = 102, CoeffGU = 25, CoeffGV = 52, CoeffBU = 129
+};
+
+static inline unsigned char
+clamp(int value)
+{
+  if (value < 0)
+    return 0;
+  if (value > 255)
+    return 255;
+  return value;
+}
+
+static inline short
+saturate(int value)
+{
+  if (value < -32768)
+    return -32768;
+  if (value > 32767)
+    return 32767;
+  return value;
+}
+
+// Mirrors saturating 16 bit arithmetic of SIMD paths.
+static inline void
+writePixel(unsigned char* dst, int y, int u, int v)
+{
+  short yc = (y - 16) * CoeffY;
+  short d = u - 128;
+  short e = v - 128;
+  short r = saturate(saturate(yc + e * CoeffRV) + 32);
+  short g = saturate(saturate(saturate(yc - d * CoeffGU) - e * CoeffGV) + 32);
+  short b = saturate(saturate(yc + d * CoeffBU) + 32);
+  dst[0] = clamp(b >> 6);
+  dst[1] = clamp(g >> 6);
+  dst[2] = clamp(r >> 6);
+  dst[3] = 0xFF;
+}
+
+static void
+convertI420Rows(const unsigned char* y, int yPitch, const unsigned char* u,
+    const unsigned char* v, int uvPitch, unsigned char* dst, int dstPitch,
+    int from, int width, int height)
+{
+  for (int row = 0; row < height; ++row)
+    {
+      const unsigned char* yRow = y + row * yPitch;
+      const unsigned char* uRow = u + (row / 2) * uvPitch;
+      const unsigned char* vRow = v + (row / 2) * uvPitch;
+      unsigned char* dRow = dst + row * dstPitch;
+      for (int x = from; x < width; ++x)
+        writePixel(dRow + 4 * x, yRow[x], uRow[x / 2], vRow[x / 2]);
+    }
+}
+
+static void
+convertUYVYRows(const unsigned char* src, int srcPitch, unsigned char* dst,
+    int dstPitch, int from, int width, int height)
+{
+  for (int row = 0; row < height; ++row)
+    {
+      const unsigned char* sRow = src + row * srcPitch;
+      unsigned char* dRow = dst + row * dstPitch;
+      for (int x = from; x < width; ++x)
+        {
+          const unsigned char* pair = sRow + 4 * (x / 2);
+          writePixel(dRow + 4 * x, pair[1 + 2 * (x & 1)], pair[0], pair[2]);
+        }
+    }
+}
+
+#if defined(ILIXI_YUV_SSE2)
+
+// Converts 8 pixels, y/u/v hold 16 bit values with u and v already duplicated.
+static inline void
+convert8(__m128i y, __m128i u, __m128i v, unsigned char* dst)
+{
+  const __m128i round = _mm_set1_epi16(32);
+  __m128i yc = _mm_mullo_epi16(_mm_sub_epi16(y, _mm_set1_epi16(16)),
+      _mm_set1_epi16(CoeffY));
+  __m128i d = _mm_sub_epi16(u, _mm_set1_epi16(128));
+  __m128i e = _mm_sub_epi16(v, _mm_set1_epi16(128));
+
+  __m128i r = _mm_adds_epi16(yc, _mm_mullo_epi16(e, _mm_set1_epi16(CoeffRV)));
+  __m128i g = _mm_subs_epi16(yc, _mm_mullo_epi16(d, _mm_set1_epi16(CoeffGU)));
+  g = _mm_subs_epi16(g, _mm_mullo_epi16(e, _mm_set1_epi16(CoeffGV)));
+  __m128i b = _mm_adds_epi16(yc, _mm_mullo_epi16(d, _mm_set1_epi16(CoeffBU)));
+
+  r = _mm_srai_epi16(_mm_adds_epi16(r, round), 6);
+  g = _mm_srai_epi16(_mm_adds_epi16(g, round), 6);
+  b = _mm_srai_epi16(_mm_adds_epi16(b, round), 6);
+
+  __m128i r8 = _mm_packus_epi16(r, r);
+  __m128i g8 = _mm_packus_epi16(g, g);
+  __m128i b8 = _mm_packus_epi16(b, b);
+  __m128i a8 = _mm_set1_epi8((char) 0xFF);
+
+  __m128i bg = _mm_unpacklo_epi8(b8, g8);
+  __m128i ra = _mm_unpacklo_epi8(r8, a8);
+  _mm_storeu_si128((__m128i*) dst, _mm_unpacklo_epi16(bg, ra));
+  _mm_storeu_si128((__m128i*) (dst + 16), _mm_unpackhi_epi16(bg, ra));
+}
+
+void
+ilixi::convertI420ToARGB(const unsigned char* y, int yPitch,
+    const unsigned char* u, const unsigned char* v, int uvPitch,
+    unsigned char* dst, int dstPitch, int width, int height)
+{
+  const __m128i zero = _mm_setzero_si128();
+  int simdWidth = width & ~7;
+  for (int row = 0; row < height; ++row)
+    {
+      const unsigned char* yRow = y + row * yPitch;
+      const unsigned char* uRow = u + (row / 2) * uvPitch;
+      const unsigned char* vRow = v + (row / 2) * uvPitch;
+      unsigned char* dRow = dst + row * dstPitch;
+      for (int x = 0; x < simdWidth; x += 8)
+        {
+          __m128i y16 = _mm_unpacklo_epi8(
+              _mm_loadl_epi64((const __m128i*) (yRow + x)), zero);
+          __m128i u16 = _mm_unpacklo_epi8(
+              _mm_cvtsi32_si128(*(const int*) (uRow + x / 2)), zero);
+          __m128i v16 = _mm_unpacklo_epi8(
+              _mm_cvtsi32_si128(*(const int*) (vRow + x / 2)), zero);
+          convert8(y16, _mm_unpacklo_epi16(u16, u16),
+              _mm_unpacklo_epi16(v16, v16), dRow + 4 * x);
+        }
+    }
+  if (simdWidth < width)
+    convertI420Rows(y, yPitch, u, v, uvPitch, dst, dstPitch, simdWidth, width,
+        height);
+}
+
+void
+ilixi::convertUYVYToARGB(const unsigned char* src, int srcPitch,
+    unsigned char* dst, int dstPitch, int width, int height)
+{
+  const __m128i lowBytes = _mm_set1_epi16(0x00FF);
+  int simdWidth = width & ~7;
+  for (int row = 0; row < height; ++row)
+    {
+      const unsigned char* sRow = src + row * srcPitch;
+      unsigned char* dRow = dst + row * dstPitch;
+      for (int x = 0; x < simdWidth; x += 8)
+        {
+          __m128i p = _mm_loadu_si128((const __m128i*) (sRow + 2 * x));
+          __m128i y16 = _mm_srli_epi16(p, 8);
+          __m128i uv = _mm_and_si128(p, lowBytes);
+          __m128i u16 = _mm_shufflehi_epi16(
+              _mm_shufflelo_epi16(uv, _MM_SHUFFLE(2, 2, 0, 0)),
+              _MM_SHUFFLE(2, 2, 0, 0));
+          __m128i v16 = _mm_shufflehi_epi16(
+              _mm_shufflelo_epi16(uv, _MM_SHUFFLE(3, 3, 1, 1)),
+              _MM_SHUFFLE(3, 3, 1, 1));
+          convert8(y16, u16, v16, dRow + 4 * x);
+        }
+    }
+  if (simdWidth < width)
+    convertUYVYRows(src, srcPitch, dst, dstPitch, simdWidth, width, height);
+}
+
+const char*
+ilixi::colorConversionPath()
+{
+  return "SSE2";
+}
+
+#elif defined(ILIXI_YUV_NEON)
+
+// Converts 8 pixels, y/u/v hold 16 bit values with u and v already duplicated.
+static inline uint8x8x4_t
+convert8(int16x8_t y, int16x8_t u, int16x8_t v)
+{
+  const int16x8_t round = vdupq_n_s16(32);
+  int16x8_t yc = vmulq_n_s16(vsubq_s16(y, vdupq_n_s16(16)), CoeffY);
+  int16x8_t d = vsubq_s16(u, vdupq_n_s16(128));
+  int16x8_t e = vsubq_s16(v, vdupq_n_s16(128));
+
+  int16x8_t r = vqaddq_s16(yc, vmulq_n_s16(e, CoeffRV));
+  int16x8_t g = vqsubq_s16(yc, vmulq_n_s16(d, CoeffGU));
+  g = vqsubq_s16(g, vmulq_n_s16(e, CoeffGV));
+  int16x8_t b = vqaddq_s16(yc, vmulq_n_s16(d, CoeffBU));
+
+  uint8x8x4_t pixels;
+  pixels.val[0] = vqmovun_s16(vshrq_n_s16(vqaddq_s16(b, round), 6));
+  pixels.val[1] = vqmovun_s16(vshrq_n_s16(vqaddq_s16(g, round), 6));
+  pixels.val[2] = vqmovun_s16(vshrq_n_s16(vqaddq_s16(r, round), 6));
+  pixels.val[3] = vdup_n_u8(0xFF);
+  return pixels;
+}
+
+static inline int16x8_t
+widen(uint8x8_t value)
+{
+  return vreinterpretq_s16_u16(vmovl_u8(value));
+}
+
+void
+ilixi::convertI420ToARGB(const unsigned char* y, int yPitch,
+    const unsigned char* u, const unsigned char* v, int uvPitch,
+    unsigned char* dst, int dstPitch, int width, int height)
+{
+  int simdWidth = width & ~15;
+  for (int row = 0; row < height; ++row)
+    {
+      const unsigned char* yRow = y + row * yPitch;
+      const unsigned char* uRow = u + (row / 2) * uvPitch;
+      const unsigned char* vRow = v + (row / 2) * uvPitch;
+      unsigned char* dRow = dst + row * dstPitch;
+      for (int x = 0; x < simdWidth; x += 16)
+        {
+          uint8x16_t y8 = vld1q_u8(yRow + x);
+          uint8x8_t u8 = vld1_u8(uRow + x / 2);
+          uint8x8_t v8 = vld1_u8(vRow + x / 2);
+          uint8x8x2_t uu = vzip_u8(u8, u8);
+          uint8x8x2_t vv = vzip_u8(v8, v8);
+          vst4_u8(dRow + 4 * x,
+              convert8(widen(vget_low_u8(y8)), widen(uu.val[0]),
+                  widen(vv.val[0])));
+          vst4_u8(dRow + 4 * x + 32,
+              convert8(widen(vget_high_u8(y8)), widen(uu.val[1]),
+                  widen(vv.val[1])));
+        }
+    }
+  if (simdWidth < width)
+    convertI420Rows(y, yPitch, u, v, uvPitch, dst, dstPitch, simdWidth, width,
+        height);
+}
+
+void
+ilixi::convertUYVYToARGB(const unsigned char* src, int srcPitch,
+    unsigned char* dst, int dstPitch, int width, int height)
+{
+  int simdWidth = width & ~15;
+  for (int row = 0; row < height; ++row)
+    {
+      const unsigned char* sRow = src + row * srcPitch;
+      unsigned char* dRow = dst + row * dstPitch;
+      for (int x = 0; x < simdWidth; x += 16)
+        {
+          // val[0] = U, val[1] = even Y, val[2] = V, val[3] = odd Y.
+          uint8x8x4_t p = vld4_u8(sRow + 2 * x);
+          int16x8_t u16 = widen(p.val[0]);
+          int16x8_t v16 = widen(p.val[2]);
+          uint8x8x4_t even = convert8(widen(p.val[1]), u16, v16);
+          uint8x8x4_t odd = convert8(widen(p.val[3]), u16, v16);
+          uint8x8x4_t lo, hi;
+          for (int c = 0; c < 4; ++c)
+            {
+              uint8x8x2_t z = vzip_u8(even.val[c], odd.val[c]);
+              lo.val[c] = z.val[0];
+              hi.val[c] = z.val[1];
+            }
+          vst4_u8(dRow + 4 * x, lo);
+          vst4_u8(dRow + 4 * x + 32, hi);
+        }
+    }
+  if (simdWidth < width)
+    convertUYVYRows(src, srcPitch, dst, dstPitch, simdWidth, width, height);
+}
+
+const char*
+ilixi::colorConversionPath()
+{
+  return "NEON";
+}
+
+#else
+
+void
+ilixi::convertI420ToARGB(const unsigned char* y, int yPitch,
+    const unsigned char* u, const unsigned char* v, int uvPitch,
+    unsigned char* dst, int dstPitch, int width, int height)
+{
+  convertI420Rows(y, yPitch, u, v, uvPitch, dst, dstPitch, 0, width, height);
+}
+
+void
+ilixi::convertUYVYToARGB(const unsigned char* src, int srcPitch,
+    unsigned char* dst, int dstPitch, int width, int height)
+{
+  convertUYVYRows(src, srcPitch, dst, dstPitch, 0, width, height);
+}
+
+const char*
+ilixi::colorConversionPath()
+{
+  return "scalar";
+}
+
+#endif
+
+void
+ilixi::convertI420ToARGBScalar(const unsigned char* y, int yPitch,
+    const unsigned char* u, const unsigned char* v, int uvPitch,
+    unsigned char* dst, int dstPitch, int width, int height)
+{
+  convertI420Rows(y, yPitch, u, v, uvPitch, dst, dstPitch, 0, width, height);
+}
+
+void
+ilixi::convertUYVYToARGBScalar(const unsigned char* src, int srcPitch,
+    unsigned char* dst, int dstPitch, int width, int height)
+{
+  convertUYVYRows(src, srcPitch, dst, dstPitch, 0, width, height);
+}
+
+bool
+ilixi::convertYUVToARGB(DFBSurfacePixelFormat format, const void* src,
+    int srcPitch, void* dst, int dstPitch, int width, int height)
+{
+  const unsigned char* s = (const unsigned char*) src;
+  unsigned char* d = (unsigned char*) dst;
+  const unsigned char* first = s + srcPitch * height;
+  const unsigned char* second = first + (srcPitch / 2) * ((height + 1) / 2);
+
+  switch (format)
+    {
+  case DSPF_I420:
+    convertI420ToARGB(s, srcPitch, first, second, srcPitch / 2, d, dstPitch,
+        width, height);
+    return true;
+  case DSPF_YV12:
+    convertI420ToARGB(s, srcPitch, second, first, srcPitch / 2, d, dstPitch,
+        width, height);
+    return true;
+  case DSPF_UYVY:
+    convertUYVYToARGB(s, srcPitch, d, dstPitch, width, height);
+    return true;
+  default:
+    return false;
+    }
+}
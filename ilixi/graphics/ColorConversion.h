@@ -0,0 +1,105 @@
+/*
+ Copyright 2010, 2011 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ILIXI_COLORCONVERSION_H_
+#define ILIXI_COLORCONVERSION_H_
+
+#include "directfb.h"
+
+namespace ilixi
+{
+  /*!
+   * Converts a planar 4:2:0 YUV image (I420 or YV12) to opaque ARGB.
+   *
+   * Conversion uses ITU-R BT.601 coefficients in 6 bit fixed point. Since
+   * output is opaque, it is also valid premultiplied ARGB. Uses SSE2 or NEON
+   * if available at compile time, scalar code otherwise.
+   *
+   * @param y luma plane.
+   * @param yPitch bytes per row of luma plane.
+   * @param u Cb plane, half width and height.
+   * @param v Cr plane, half width and height.
+   * @param uvPitch bytes per row of chroma planes.
+   * @param dst destination pixels.
+   * @param dstPitch bytes per row of destination.
+   * @param width image width in pixels.
+   * @param height image height in pixels.
+   */
+  void
+  convertI420ToARGB(const unsigned char* y, int yPitch, const unsigned char* u,
+      const unsigned char* v, int uvPitch, unsigned char* dst, int dstPitch,
+      int width, int height);
+
+  /*!
+   * Scalar reference for convertI420ToARGB(), produces identical output.
+   */
+  void
+  convertI420ToARGBScalar(const unsigned char* y, int yPitch,
+      const unsigned char* u, const unsigned char* v, int uvPitch,
+      unsigned char* dst, int dstPitch, int width, int height);
+
+  /*!
+   * Converts a packed 4:2:2 UYVY image to opaque ARGB.
+   *
+   * @param src source pixels.
+   * @param srcPitch bytes per row of source.
+   * @param dst destination pixels.
+   * @param dstPitch bytes per row of destination.
+   * @param width image width in pixels.
+   * @param height image height in pixels.
+   */
+  void
+  convertUYVYToARGB(const unsigned char* src, int srcPitch, unsigned char* dst,
+      int dstPitch, int width, int height);
+
+  /*!
+   * Scalar reference for convertUYVYToARGB(), produces identical output.
+   */
+  void
+  convertUYVYToARGBScalar(const unsigned char* src, int srcPitch,
+      unsigned char* dst, int dstPitch, int width, int height);
+
+  /*!
+   * Converts a locked YUV surface to ARGB. Returns false if format is not
+   * one of DSPF_I420, DSPF_YV12 or DSPF_UYVY.
+   *
+   * @param format pixel format of source.
+   * @param src pointer to locked source surface.
+   * @param srcPitch pitch of source surface.
+   * @param dst pointer to locked ARGB surface.
+   * @param dstPitch pitch of destination surface.
+   * @param width image width in pixels.
+   * @param height image height in pixels.
+   */
+  bool
+  convertYUVToARGB(DFBSurfacePixelFormat format, const void* src,
+      int srcPitch, void* dst, int dstPitch, int width, int height);
+
+  /*!
+   * Returns name of conversion code selected at compile time, e.g. "SSE2".
+   */
+  const char*
+  colorConversionPath();
+}
+
+#endif /* ILIXI_COLORCONVERSION_H_ */
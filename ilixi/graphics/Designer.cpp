@@ -34,12 +34,32 @@
 
 using namespace ilixi;
 
-Designer::Designer(const std::string& styleSheet)
+const Theme* Designer::_sharedTheme = NULL;
+
+Designer::Designer(const std::string& styleSheet) :
+  _arrowUp(NULL), _arrowDown(NULL), _arrowLeft(NULL), _arrowRight(NULL),
+      _checkEmpty(NULL), _checkPartial(NULL), _checkFull(NULL), _grid(NULL),
+      _plusSign(NULL), _minusSign(NULL), _dialog(NULL), _dialogCritical(NULL),
+      _dialogInfo(NULL), _dialogQuestion(NULL), _dialogWarning(NULL),
+      _defaultFont(NULL), _buttonFont(NULL), _titleFont(NULL),
+      _inputFont(NULL)
 {
   _borderWidth = 1;
   //setStyleSheet(styleSheet, DATADIR"/designer/");
 }
 
+Designer::Designer(const StyleTable& style, int borderWidth) :
+  _arrowUp(NULL), _arrowDown(NULL), _arrowLeft(NULL), _arrowRight(NULL),
+      _checkEmpty(NULL), _checkPartial(NULL), _checkFull(NULL), _grid(NULL),
+      _plusSign(NULL), _minusSign(NULL), _dialog(NULL), _dialogCritical(NULL),
+      _dialogInfo(NULL), _dialogQuestion(NULL), _dialogWarning(NULL),
+      _defaultFont(NULL), _buttonFont(NULL), _titleFont(NULL),
+      _inputFont(NULL)
+{
+  _borderWidth = borderWidth;
+  setStyleTable(style);
+}
+
 Designer::~Designer()
 {
   cleanStyleElements();
@@ -59,6 +79,14 @@ Designer::setStyleSheet(const std::string& styleSheet, const std::string& path)
 
   std::string styleFile = "";
   styleFile.append(path).append(styleSheet);
+  _styleFile = styleFile;
+
+  if (_sharedTheme && styleFile == _sharedTheme->styleSheet && importTheme(
+      _sharedTheme))
+    {
+      ILOG_INFO("Attached to shared theme.");
+      return;
+    }
 
   doc = xmlParseFile(styleFile.c_str());
 
@@ -106,6 +134,50 @@ Designer::setStyleSheet(const std::string& styleSheet, const std::string& path)
   ILOG_INFO("Parsed style file.");
 }
 
+void
+Designer::setStyleTable(const StyleTable& style)
+{
+  std::string path = style.path;
+  _styleFile = std::string(path).append(style.styleSheet);
+
+  if (_sharedTheme && _styleFile == _sharedTheme->styleSheet && importTheme(
+      _sharedTheme))
+    {
+      ILOG_INFO("Attached to shared theme.");
+      return;
+    }
+
+  for (unsigned int i = 0; i < style.colorCount; i++)
+    {
+      const StyleColor& c = style.colors[i];
+      Color color(c.red / 255.0, c.green / 255.0, c.blue / 255.0,
+          c.alpha / 255.0);
+      if (c.group)
+        (_palette.*(c.group)).*(c.groupColor) = color;
+      else
+        _palette.*(c.color) = color;
+    }
+
+  for (unsigned int i = 0; i < style.fontCount; i++)
+    {
+      const StyleFont& f = style.fonts[i];
+      Font** font = themeFont(f.type);
+      delete *font;
+      *font = new Font(f.family);
+      (*font)->setSize(f.size);
+      (*font)->setWeight(f.weight);
+    }
+
+  for (unsigned int i = 0; i < style.hintCount; i++)
+    setHint(style.hints[i].type, style.hints[i].value);
+
+  for (unsigned int i = 0; i < style.imageCount; i++)
+    loadThemeImage(style.images[i].type,
+        std::string(path).append(style.images[i].path));
+
+  ILOG_INFO("Loaded compiled style %s", _styleFile.c_str());
+}
+
 void
 Designer::cleanStyleElements()
 {
@@ -132,6 +204,260 @@ Designer::cleanStyleElements()
   delete _inputFont;
 }
 
+void
+Designer::exportTheme(Theme* theme)
+{
+  snprintf(theme->styleSheet, sizeof(theme->styleSheet), "%s",
+      _styleFile.c_str());
+  theme->palette = _palette;
+
+  for (int i = 0; i < ThemeHintCount; i++)
+    theme->hints[i] = hint((WidgetHint) i);
+
+  for (int i = 0; i < ThemeFontCount; i++)
+    {
+      Font* font = *themeFont((DesignerFontType) i);
+      theme->fonts[i][0] = 0;
+      if (font)
+        {
+          char* desc = font->toString();
+          snprintf(theme->fonts[i], sizeof(theme->fonts[i]), "%s", desc);
+          g_free(desc);
+        }
+    }
+
+  for (int i = 0; i < ThemeImageCount; i++)
+    {
+      Image* image = *themeImage((ThemeImageType) i);
+      ThemeImage* shared = &theme->images[i];
+      if (image)
+        {
+          shared->surfaceID = image->surfaceID();
+          shared->width = image->width();
+          shared->height = image->height();
+          snprintf(shared->path, sizeof(shared->path), "%s",
+              image->getImagePath().c_str());
+        }
+      else
+        {
+          shared->surfaceID = 0;
+          shared->path[0] = 0;
+        }
+    }
+  ILOG_INFO("Exported theme %s", theme->styleSheet);
+}
+
+void
+Designer::setSharedTheme(const Theme* theme)
+{
+  _sharedTheme = theme;
+}
+
+bool
+Designer::importTheme(const Theme* theme)
+{
+  for (int i = 0; i < ThemeFontCount; i++)
+    if (!theme->fonts[i][0])
+      return false;
+
+  _palette = theme->palette;
+
+  for (int i = 0; i < ThemeHintCount; i++)
+    setHint((WidgetHint) i, theme->hints[i]);
+
+  for (int i = 0; i < ThemeFontCount; i++)
+    {
+      Font** font = themeFont((DesignerFontType) i);
+      delete *font;
+      *font = new Font(std::string(theme->fonts[i]));
+    }
+
+  for (int i = 0; i < ThemeImageCount; i++)
+    {
+      const ThemeImage* shared = &theme->images[i];
+      if (shared->path[0])
+        {
+          Image** image = themeImage((ThemeImageType) i);
+          delete *image;
+          *image = new Image(shared->surfaceID, shared->path,
+              Size(shared->width, shared->height));
+        }
+    }
+  return true;
+}
+
+Image**
+Designer::themeImage(ThemeImageType type)
+{
+  switch (type)
+    {
+  case ThemeArrowUp:
+    return &_arrowUp;
+  case ThemeArrowDown:
+    return &_arrowDown;
+  case ThemeArrowLeft:
+    return &_arrowLeft;
+  case ThemeArrowRight:
+    return &_arrowRight;
+  case ThemeCheckEmpty:
+    return &_checkEmpty;
+  case ThemeCheckPartial:
+    return &_checkPartial;
+  case ThemeCheckFull:
+    return &_checkFull;
+  case ThemeGrid:
+    return &_grid;
+  case ThemePlusSign:
+    return &_plusSign;
+  case ThemeMinusSign:
+    return &_minusSign;
+  case ThemeDialogCritical:
+    return &_dialogCritical;
+  case ThemeDialogInfo:
+    return &_dialogInfo;
+  case ThemeDialogQuestion:
+    return &_dialogQuestion;
+  case ThemeDialogWarning:
+    return &_dialogWarning;
+  default:
+    return &_dialog;
+    }
+}
+
+Font**
+Designer::themeFont(DesignerFontType type)
+{
+  switch (type)
+    {
+  case ButtonFont:
+    return &_buttonFont;
+  case TitleFont:
+    return &_titleFont;
+  case InputFont:
+    return &_inputFont;
+  default:
+    return &_defaultFont;
+    }
+}
+
+void
+Designer::setHint(WidgetHint type, int value)
+{
+  switch (type)
+    {
+  case BorderWidth:
+    _borderWidth = value;
+    break;
+  case FrameBorderRadius:
+    _frameBorderRadius = value;
+    break;
+  case TextInputFrameRadius:
+    _textInputFrameRadius = value;
+    break;
+  case DialogShadow:
+    _dialogShadow = value;
+    break;
+
+  case ButtonHeight:
+    _buttonSize.setHeight(value);
+    break;
+  case ButtonWidth:
+    _buttonSize.setWidth(value);
+    break;
+  case ButtonOffset:
+    _buttonOffset = value;
+    break;
+  case ButtonRadius:
+    _buttonRadius = value;
+    break;
+  case ButtonCheckedIndicatorWidth:
+    _buttonCheckedIndicatorWidth = value;
+    break;
+
+  case RadioHeight:
+    _radiobuttonSize.setHeight(value);
+    break;
+  case RadioWidth:
+    _radiobuttonSize.setWidth(value);
+    break;
+  case RadioOffset:
+    _radiobuttonOffset = value;
+    break;
+
+  case CheckBoxHeight:
+    _checkboxSize.setHeight(value);
+    break;
+  case CheckBoxWidth:
+    _checkboxSize.setWidth(value);
+    break;
+  case CheckBoxOffset:
+    _checkboxOffset = value;
+    break;
+  case CheckBoxRadius:
+    _checkboxRadius = value;
+    break;
+
+  case ComboBoxRadius:
+    _comboboxRadius = value;
+    break;
+  case ComboBoxButtonWidth:
+    _comboboxButtonWidth = value;
+    break;
+
+  case ProgressBarHeight:
+    _progressbarSize.setHeight(value);
+    break;
+  case ProgressBarWidth:
+    _progressbarSize.setWidth(value);
+    break;
+  case ProgressBarRadius:
+    _progressbarRadius = value;
+    break;
+
+  case SliderHeight:
+    _sliderSize.setHeight(value);
+    break;
+  case SliderWidth:
+    _sliderSize.setWidth(value);
+    break;
+  case SliderRadius:
+    _sliderRadius = value;
+    break;
+  case SliderFrameHeight:
+    _sliderFrameHeight = value;
+    break;
+
+  case ScrollBarHeight:
+    _scrollbarSize.setHeight(value);
+    break;
+  case ScrollBarWidth:
+    _scrollbarSize.setWidth(value);
+    break;
+  case ScrollBarRadius:
+    _scrollbarRadius = value;
+    break;
+  case ScrollBarButtonWidth:
+    _scrollbarButtonWidth = value;
+    break;
+
+  case TabPanelHeight:
+    _tabPanelSize.setHeight(value);
+    break;
+  case TabPanelWidth:
+    _tabPanelSize.setWidth(value);
+    break;
+  case TabPanelButtonHeight:
+    _tabPanelButtonHeight = value;
+    break;
+  case TabPanelButtonOffset:
+    _tabPanelButtonOffset = value;
+    break;
+
+  default:
+    break;
+    }
+}
+
 void
 Designer::parsePalette(xmlDoc* node)
 {
@@ -681,46 +1007,42 @@ Designer::parseImages(std::string pathFS, xmlDoc* node)
               char* name = (char *) nameAttr;
               std::string path = std::string(pathFS).append((char *) pathAttr);
 
+              ThemeImageType type = ThemeImageCount;
               if (!strcmp(name, "CheckEmpty"))
-                _checkEmpty = new Image(path, _checkboxSize.width(),
-                    _checkboxSize.height());
+                type = ThemeCheckEmpty;
               else if (!strcmp(name, "CheckFull"))
-                _checkFull = new Image(path, _checkboxSize.width(),
-                    _checkboxSize.height());
+                type = ThemeCheckFull;
               else if (!strcmp(name, "CheckPartial"))
-                _checkPartial = new Image(path, _checkboxSize.width(),
-                    _checkboxSize.height());
+                type = ThemeCheckPartial;
               else if (!strcmp(name, "Grid"))
-                _grid = new Image(path, _scrollbarSize.height(),
-                    _scrollbarSize.height());
+                type = ThemeGrid;
               else if (!strcmp(name, "ArrowUp"))
-                _arrowUp = new Image(path, _scrollbarButtonWidth,
-                    _scrollbarSize.height());
+                type = ThemeArrowUp;
               else if (!strcmp(name, "ArrowDown"))
-                _arrowDown = new Image(path, _scrollbarButtonWidth,
-                    _scrollbarSize.height());
+                type = ThemeArrowDown;
               else if (!strcmp(name, "ArrowLeft"))
-                _arrowLeft = new Image(path, _scrollbarButtonWidth,
-                    _scrollbarSize.height());
+                type = ThemeArrowLeft;
               else if (!strcmp(name, "ArrowRight"))
-                _arrowRight = new Image(path, _scrollbarButtonWidth,
-                    _scrollbarSize.height());
+                type = ThemeArrowRight;
               else if (!strcmp(name, "Dialog"))
-                _dialog = new Image(path, 24, 24);
+                type = ThemeDialog;
               else if (!strcmp(name, "Critical"))
-                _dialogCritical = new Image(path, 48, 48);
+                type = ThemeDialogCritical;
               else if (!strcmp(name, "Information"))
-                _dialogInfo = new Image(path, 48, 48);
+                type = ThemeDialogInfo;
               else if (!strcmp(name, "Question"))
-                _dialogQuestion = new Image(path, 48, 48);
+                type = ThemeDialogQuestion;
               else if (!strcmp(name, "Warning"))
-                _dialogWarning = new Image(path, 48, 48);
+                type = ThemeDialogWarning;
               else if (!strcmp(name, "Plus"))
-                _plusSign = new Image(path, 48, 48);
+                type = ThemePlusSign;
               else if (!strcmp(name, "Minus"))
-                _minusSign = new Image(path, 48, 48);
-              else
+                type = ThemeMinusSign;
+
+              if (type == ThemeImageCount)
                 ILOG_ERROR("Image name=\"%s\" is not supported!", name);
+              else
+                loadThemeImage(type, path);
             }
           xmlFree(nameAttr);
           xmlFree(pathAttr);
@@ -729,6 +1051,39 @@ Designer::parseImages(std::string pathFS, xmlDoc* node)
     }
 }
 
+void
+Designer::loadThemeImage(ThemeImageType type, const std::string& path)
+{
+  Size size;
+  switch (type)
+    {
+  case ThemeCheckEmpty:
+  case ThemeCheckFull:
+  case ThemeCheckPartial:
+    size = _checkboxSize;
+    break;
+  case ThemeGrid:
+    size = Size(_scrollbarSize.height(), _scrollbarSize.height());
+    break;
+  case ThemeArrowUp:
+  case ThemeArrowDown:
+  case ThemeArrowLeft:
+  case ThemeArrowRight:
+    size = Size(_scrollbarButtonWidth, _scrollbarSize.height());
+    break;
+  case ThemeDialog:
+    size = Size(24, 24);
+    break;
+  default:
+    size = Size(48, 48);
+    break;
+    }
+
+  Image** image = themeImage(type);
+  delete *image;
+  *image = new Image(path, size);
+}
+
 void
 Designer::drawLabel(Painter* painter, Label* label)
 {
@@ -1493,6 +1848,8 @@ Designer::hint(WidgetHint type) const
     return _tabPanelSize.width();
   case TabPanelButtonHeight:
     return _tabPanelButtonHeight;
+  case TabPanelButtonOffset:
+    return _tabPanelButtonOffset;
 
   default:
     return -1;
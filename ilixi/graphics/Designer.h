@@ -29,6 +29,8 @@
 #include "types/Image.h"
 #include "types/Font.h"
 #include "graphics/Palette.h"
+#include "graphics/Theme.h"
+#include "graphics/StyleTable.h"
 #include <libxml/tree.h>
 
 namespace ilixi
@@ -73,6 +75,16 @@ namespace ilixi
      */
     Designer(const std::string& styleSheet);
 
+    /*!
+     * Constructor.
+     * Initialises style parameters from tables compiled at build time,
+     * without parsing a stylesheet.
+     *
+     * @param style
+     * @param borderWidth default border width, hints in style override it.
+     */
+    Designer(const StyleTable& style, int borderWidth = 1);
+
     /*!
      * Destructor.
      */
@@ -234,6 +246,24 @@ namespace ilixi
     Image*
     defaultIcon(DesignerIconType type) const;
 
+    /*!
+     * Stores palette, hints, fonts and shared surface IDs of images in theme.
+     * Used by Maestro in order to publish a parsed stylesheet.
+     *
+     * @param theme a theme inside shared memory pool.
+     */
+    void
+    exportTheme(Theme* theme);
+
+    /*!
+     * Sets a theme published by Maestro. Designers attach to this theme
+     * instead of parsing a stylesheet if both use the same file.
+     *
+     * @param theme NULL to parse stylesheets.
+     */
+    static void
+    setSharedTheme(const Theme* theme);
+
   protected:
     //! This property stores the palette.
     Palette _palette;
@@ -340,6 +370,11 @@ namespace ilixi
     //! Font for rendering input text.
     Font* _inputFont;
 
+    //! Full path to parsed stylesheet.
+    std::string _styleFile;
+    //! Theme published by Maestro, if any.
+    static const Theme* _sharedTheme;
+
     /*!
      * Parses an XML file and initialises style parameters.
      *
@@ -349,12 +384,45 @@ namespace ilixi
     void
     setStyleSheet(const std::string& styleSheet, const std::string& path);
 
+    /*!
+     * Initialises style parameters using tables compiled from a stylesheet.
+     *
+     * @param style
+     */
+    void
+    setStyleTable(const StyleTable& style);
+
     /*!
      * Delete images and fonts.
      */
     void
     cleanStyleElements();
 
+    /*!
+     * Initialises style parameters using a theme. Returns false if theme is
+     * not complete.
+     */
+    bool
+    importTheme(const Theme* theme);
+
+    /*!
+     * Returns a pointer to image member given its type.
+     */
+    Image**
+    themeImage(ThemeImageType type);
+
+    /*!
+     * Returns a pointer to font member given its type.
+     */
+    Font**
+    themeFont(DesignerFontType type);
+
+    /*!
+     * Sets hint value for given type.
+     */
+    void
+    setHint(WidgetHint type, int value);
+
     /*!
      * Parses colors from stylesheet.
      */
@@ -379,6 +447,15 @@ namespace ilixi
     void
     parseImages(std::string path, xmlDoc* node);
 
+    /*!
+     * Loads an image using size given by hints.
+     *
+     * @param type
+     * @param path full path to image.
+     */
+    void
+    loadThemeImage(ThemeImageType type, const std::string& path);
+
     void
     drawImage(Painter* painter, Image* image, int x, int y,
         bool disabled = false,
@@ -48,6 +48,20 @@ Painter::Painter(Widget* widget) :
   cairo_set_antialias(_context, (cairo_antialias_t) _antiAliasMode);
 }
 
+Painter::Painter(Surface* surface) :
+  _myWidget(NULL), _antiAliasMode(AliasSubPixel), _brushActive(true)
+{
+  _surface = surface;
+  _context = _surface->cairoContext();
+  _pangoLayout = pango_cairo_create_layout(_context);
+  _font = 0;
+
+  _brush = new Brush();
+  _defaultFont = new Font("sans 8");
+
+  cairo_set_antialias(_context, (cairo_antialias_t) _antiAliasMode);
+}
+
 Painter::~Painter()
 {
   delete _brush;
@@ -250,6 +264,54 @@ Painter::drawLine(const Point& p1, const Point& p2, DrawingMode mode)
   drawLine(p1.x(), p1.y(), p2.x(), p2.y(), mode);
 }
 
+void
+Painter::drawLines(const double* coords, int lineCount, DrawingMode mode)
+{
+  if (lineCount < 1)
+    return;
+  for (int i = 0; i < 4 * lineCount; i += 4)
+    {
+      cairo_move_to(_context, coords[i], coords[i + 1]);
+      cairo_line_to(_context, coords[i + 2], coords[i + 3]);
+    }
+  applyDrawingMode(mode);
+}
+
+void
+Painter::drawLines(const Point* points, int lineCount, DrawingMode mode)
+{
+  if (lineCount < 1)
+    return;
+  for (int i = 0; i < 2 * lineCount; i += 2)
+    {
+      cairo_move_to(_context, points[i].x(), points[i].y());
+      cairo_line_to(_context, points[i + 1].x(), points[i + 1].y());
+    }
+  applyDrawingMode(mode);
+}
+
+void
+Painter::drawPolyline(const double* coords, int pointCount, DrawingMode mode)
+{
+  if (pointCount < 2)
+    return;
+  cairo_move_to(_context, coords[0], coords[1]);
+  for (int i = 2; i < 2 * pointCount; i += 2)
+    cairo_line_to(_context, coords[i], coords[i + 1]);
+  applyDrawingMode(mode);
+}
+
+void
+Painter::drawPolyline(const Point* points, int pointCount, DrawingMode mode)
+{
+  if (pointCount < 2)
+    return;
+  cairo_move_to(_context, points[0].x(), points[0].y());
+  for (int i = 1; i < pointCount; i++)
+    cairo_line_to(_context, points[i].x(), points[i].y());
+  applyDrawingMode(mode);
+}
+
 void
 Painter::drawPolygon(const Point* points, int pointCount, DrawingMode mode)
 {
@@ -277,6 +339,44 @@ Painter::drawRectangle(const Rectangle& rect, DrawingMode mode)
   drawRectangle(rect.x(), rect.y(), rect.width(), rect.height(), mode);
 }
 
+void
+Painter::drawRects(const double* rects, int rectCount, DrawingMode mode)
+{
+  if (rectCount < 1)
+    return;
+  double x, y, width, height;
+  for (int i = 0; i < 4 * rectCount; i += 4)
+    {
+      x = rects[i];
+      y = rects[i + 1];
+      width = rects[i + 2];
+      height = rects[i + 3];
+      if (mode != FillPath)
+        getUserCoordinates(x, y, width, height);
+      cairo_rectangle(_context, x, y, width, height);
+    }
+  applyDrawingMode(mode);
+}
+
+void
+Painter::drawRects(const Rectangle* rects, int rectCount, DrawingMode mode)
+{
+  if (rectCount < 1)
+    return;
+  double x, y, width, height;
+  for (int i = 0; i < rectCount; i++)
+    {
+      x = rects[i].x();
+      y = rects[i].y();
+      width = rects[i].width();
+      height = rects[i].height();
+      if (mode != FillPath)
+        getUserCoordinates(x, y, width, height);
+      cairo_rectangle(_context, x, y, width, height);
+    }
+  applyDrawingMode(mode);
+}
+
 void
 Painter::drawRoundRectangle(double x, double y, double width, double height,
     int radius, DrawingMode mode, Corners corners)
@@ -452,6 +552,26 @@ Painter::drawPoint(double x, double y)
   cairo_stroke(_context);
 }
 
+void
+Painter::drawPoints(const double* coords, int pointCount)
+{
+  if (pointCount < 1)
+    return;
+  for (int i = 0; i < 2 * pointCount; i += 2)
+    addPoint(coords[i], coords[i + 1]);
+  applyDrawingMode(StrokePath);
+}
+
+void
+Painter::drawPoints(const Point* points, int pointCount)
+{
+  if (pointCount < 1)
+    return;
+  for (int i = 0; i < pointCount; i++)
+    addPoint(points[i].x(), points[i].y());
+  applyDrawingMode(StrokePath);
+}
+
 void
 Painter::drawCurrentPath(DrawingMode mode)
 {
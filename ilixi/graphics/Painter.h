@@ -86,6 +86,15 @@ namespace ilixi
      */
     Painter(Widget* widget);
 
+    /*!
+     * Constructor creates a new painter instance for the given surface.
+     * This is useful for drawing onto offscreen surfaces which are owned by a widget,
+     * e.g. a backing store which is blitted onto widget's surface later.
+     *
+     * @param surface Painter will work on this surface.
+     */
+    Painter(Surface* surface);
+
     /*!
      * Destructor. Calls end() automatically.
      */
@@ -351,6 +360,57 @@ namespace ilixi
     void
     drawLine(const Rectangle& rect, DrawingMode mode = StrokePath);
 
+    /*!
+     * Draws a set of unconnected line segments using a single path, so pen
+     * and stroke are applied only once for all segments.
+     *
+     * The following code draws a cross.
+     * \code
+     * double coords[8] = { 0, 0, 100, 100, 100, 0, 0, 100 };
+     * painter.drawLines(coords, 2);
+     * \endcode
+     *
+     * @param coords Array of (x1, y1, x2, y2) quadruples, one for each line.
+     * @param lineCount Number of lines in the array.
+     * @param mode Set painter's drawing mode.
+     */
+    void
+    drawLines(const double* coords, int lineCount,
+        DrawingMode mode = StrokePath);
+
+    /*!
+     * Draws a set of unconnected line segments using a single path.
+     *
+     * @param points Array of start and end points, two for each line.
+     * @param lineCount Number of lines in the array.
+     * @param mode Set painter's drawing mode.
+     */
+    void
+    drawLines(const Point* points, int lineCount,
+        DrawingMode mode = StrokePath);
+
+    /*!
+     * Draws an open polyline connecting given points in order.
+     *
+     * @param coords Array of (x, y) pairs.
+     * @param pointCount Number of points in the array.
+     * @param mode Set painter's drawing mode.
+     */
+    void
+    drawPolyline(const double* coords, int pointCount,
+        DrawingMode mode = StrokePath);
+
+    /*!
+     * Draws an open polyline connecting given points in order.
+     *
+     * @param points Array of points.
+     * @param pointCount Number of points in the array.
+     * @param mode Set painter's drawing mode.
+     */
+    void
+    drawPolyline(const Point* points, int pointCount,
+        DrawingMode mode = StrokePath);
+
     /*!
      * Draws a closed polygon using given points.
      *
@@ -403,6 +463,27 @@ namespace ilixi
     void
     drawRectangle(const Rectangle& rect, DrawingMode mode = StrokePath);
 
+    /*!
+     * Draws a set of rectangles using a single path.
+     *
+     * @param rects Array of (x, y, width, height) quadruples, one for each rectangle.
+     * @param rectCount Number of rectangles in the array.
+     * @param mode Set painter's drawing mode.
+     */
+    void
+    drawRects(const double* rects, int rectCount, DrawingMode mode = StrokePath);
+
+    /*!
+     * Draws a set of rectangles using a single path.
+     *
+     * @param rects Array of rectangles.
+     * @param rectCount Number of rectangles in the array.
+     * @param mode Set painter's drawing mode.
+     */
+    void
+    drawRects(const Rectangle* rects, int rectCount,
+        DrawingMode mode = StrokePath);
+
     /*!
      * Draws a rectangle inside the bounding rectangle defined by top left point (x, y)
      * and dimensions (width, height).
@@ -520,6 +601,24 @@ namespace ilixi
     void
     drawPoint(double x, double y);
 
+    /*!
+     * Draws a set of points with a single stroke using current pen.
+     *
+     * @param coords Array of (x, y) pairs.
+     * @param pointCount Number of points in the array.
+     */
+    void
+    drawPoints(const double* coords, int pointCount);
+
+    /*!
+     * Draws a set of points with a single stroke using current pen.
+     *
+     * @param points Array of points.
+     * @param pointCount Number of points in the array.
+     */
+    void
+    drawPoints(const Point* points, int pointCount);
+
     void
     drawCurrentPath(DrawingMode mode = StrokePath);
 
@@ -0,0 +1,92 @@
+/*
+ Copyright 2010, 2011 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ILIXI_STYLETABLE_H_
+#define ILIXI_STYLETABLE_H_
+
+#include "graphics/Palette.h"
+#include "graphics/Theme.h"
+#include <pango/pangocairo.h>
+
+namespace ilixi
+{
+  //! A palette colour compiled from a stylesheet.
+  struct StyleColor
+  {
+    //! Colour group, 0 if colour is a member of Palette.
+    ColorGroup Palette::*group;
+    //! Colour inside group.
+    Color ColorGroup::*groupColor;
+    //! Colour inside Palette, used if group is 0.
+    Color Palette::*color;
+    unsigned char red;
+    unsigned char green;
+    unsigned char blue;
+    unsigned char alpha;
+  };
+
+  //! A font compiled from a stylesheet.
+  struct StyleFont
+  {
+    DesignerFontType type;
+    const char* family;
+    int size;
+    PangoWeight weight;
+  };
+
+  //! A hint compiled from a stylesheet.
+  struct StyleHint
+  {
+    WidgetHint type;
+    int value;
+  };
+
+  //! An image compiled from a stylesheet, path is relative to StyleTable::path.
+  struct StyleImage
+  {
+    ThemeImageType type;
+    const char* path;
+  };
+
+  //! Stylesheet compiled into static tables at build time.
+  /*!
+   * Tables are generated by data/tdesigner/stylegen, see Designer(const StyleTable&).
+   */
+  struct StyleTable
+  {
+    //! Directory of stylesheet and its images.
+    const char* path;
+    //! File name of source stylesheet.
+    const char* styleSheet;
+    const StyleColor* colors;
+    unsigned int colorCount;
+    const StyleFont* fonts;
+    unsigned int fontCount;
+    const StyleHint* hints;
+    unsigned int hintCount;
+    const StyleImage* images;
+    unsigned int imageCount;
+  };
+}
+
+#endif /* ILIXI_STYLETABLE_H_ */
@@ -22,13 +22,29 @@
  */
 
 #include "graphics/Surface.h"
+#include "graphics/SurfacePool.h"
 #include "core/Window.h"
+#include "core/AppBase.h"
+#include "core/Arena.h"
 #include "core/Logger.h"
+#include "core/Trace.h"
+#include <string.h>
 
 using namespace ilixi;
 
+namespace
+{
+  // Headless surfaces are not shown on a screen, there is no sync to wait for.
+  DFBSurfaceFlipFlags
+  flipFlags()
+  {
+    return AppBase::headless() ? DSFLIP_NONE : DSFLIP_WAITFORSYNC;
+  }
+}
+
 Surface::Surface() :
-  _dfbSurface(NULL), _parentSurface(NULL), _cairoSurface(NULL),
+  _dfbSurface(NULL), _parentSurface(NULL), _poolSurface(NULL),
+      _cairoSurface(NULL),
       _cairoContext(NULL), _pangoContext(NULL), _pangoLayout(NULL)
 {
   pthread_mutex_init(&_surfaceLock, NULL);
@@ -40,24 +56,47 @@ Surface::~Surface()
   pthread_mutex_destroy(&_surfaceLock);
 }
 
+void*
+Surface::operator new(size_t size)
+{
+  return Arena::allocate(Arena::current(), size);
+}
+
+void
+Surface::operator delete(void* ptr, size_t size)
+{
+  Arena::deallocate(ptr, size);
+}
+
 bool
-Surface::createDFBSurface(int width, int height)
+Surface::createDFBSurface(int width, int height, bool doubleBuffered)
 {
   release();
-  DFBSurfaceDescription desc;
-  desc .flags = (DFBSurfaceDescriptionFlags) (DSDESC_WIDTH | DSDESC_HEIGHT
-      | DSDESC_PIXELFORMAT | DSDESC_CAPS);
-  desc.width = width;
-  desc.height = height;
-  desc.pixelformat = Window::pixelFormat();
-  desc.caps = (DFBSurfaceCapabilities) (DSCAPS_PREMULTIPLIED | DSCAPS_DOUBLE);
-  desc.hints = DSHF_FONT;
-  DFBResult ret = Window::DFBInterface()->CreateSurface(Window::DFBInterface(),
-      &desc, &_dfbSurface);
-  if (ret)
+  _parentSurface = NULL;
+  _poolSurface = surfacePoolAcquire(width, height, doubleBuffered);
+  if (!_poolSurface)
+    return false;
+
+  int poolWidth, poolHeight;
+  _poolSurface->GetSize(_poolSurface, &poolWidth, &poolHeight);
+  if (poolWidth == width && poolHeight == height)
     {
-      ILOG_ERROR("DFB CreateSurface Error: %d", ret);
-      return false;
+      _poolSurface->AddRef(_poolSurface);
+      _dfbSurface = _poolSurface;
+    }
+  else
+    {
+      DFBRectangle r =
+        { 0, 0, width, height };
+      DFBResult ret = _poolSurface->GetSubSurface(_poolSurface, &r,
+          &_dfbSurface);
+      if (ret)
+        {
+          ILOG_ERROR("DFB GetSubSurface Error: %d", ret);
+          surfacePoolRelease(_poolSurface);
+          _poolSurface = NULL;
+          return false;
+        }
     }
   _dfbSurface->SetBlittingFlags(_dfbSurface, DSBLIT_BLEND_ALPHACHANNEL);
   return true;
@@ -121,6 +160,50 @@ Surface::DFBSurface()
   return _dfbSurface;
 }
 
+unsigned int
+Surface::memoryUsage() const
+{
+  if (_parentSurface)
+    return 0;
+  return memoryUsage(_poolSurface ? _poolSurface : _dfbSurface);
+}
+
+unsigned int
+Surface::memoryUsage(IDirectFBSurface* surface)
+{
+  if (!surface)
+    return 0;
+
+  int width, height;
+  DFBSurfacePixelFormat format;
+  DFBSurfaceCapabilities caps;
+  surface->GetSize(surface, &width, &height);
+  surface->GetPixelFormat(surface, &format);
+  surface->GetCapabilities(surface, &caps);
+
+  unsigned int bytes = width * height * DFB_BYTES_PER_PIXEL(format);
+  if (caps & DSCAPS_TRIPLE)
+    return bytes * 3;
+  else if (caps & DSCAPS_DOUBLE)
+    return bytes * 2;
+  return bytes;
+}
+
+void
+Surface::memoryUsage(MemoryUsage& usage) const
+{
+  usage.pixels += memoryUsage();
+  if (_cairoSurface)
+    usage.cairo += MemoryCairoSurface;
+  if (_cairoContext)
+    usage.cairo += MemoryCairoContext;
+  if (_pangoContext)
+    usage.pango += MemoryPangoContext;
+  if (_pangoLayout)
+    usage.pango += MemoryPangoLayout + strlen(pango_layout_get_text(
+        _pangoLayout));
+}
+
 void
 Surface::setGeometry(const Rectangle& geometry)
 {
@@ -144,7 +227,8 @@ Surface::setGeometry(int x, int y, int width, int height)
 void
 Surface::flip()
 {
-  DFBResult ret = _dfbSurface->Flip(_dfbSurface, NULL, DSFLIP_WAITFORSYNC);
+  ILIXI_TRACE("flip");
+  DFBResult ret = _dfbSurface->Flip(_dfbSurface, NULL, flipFlags());
   if (ret)
     ILOG_ERROR("DFB Flip Error: %d", ret);
 }
@@ -152,10 +236,11 @@ Surface::flip()
 void
 Surface::flip(const Rectangle& rect)
 {
+  ILIXI_TRACE("flip");
   DFBRegion r =
     { rect.x(), rect.y(), rect.right() - 1, rect.bottom() - 1 };
 
-  DFBResult ret = _dfbSurface->Flip(_dfbSurface, &r, DSFLIP_WAITFORSYNC);
+  DFBResult ret = _dfbSurface->Flip(_dfbSurface, &r, flipFlags());
   if (ret)
     ILOG_ERROR("DFB Flip Error: %d", ret);
 }
@@ -250,14 +335,34 @@ Surface::release()
 {
   lock();
   if (_pangoLayout)
-    g_object_unref(_pangoLayout);
+    {
+      g_object_unref(_pangoLayout);
+      _pangoLayout = NULL;
+    }
   if (_pangoContext)
-    g_object_unref(_pangoContext);
+    {
+      g_object_unref(_pangoContext);
+      _pangoContext = NULL;
+    }
   if (_cairoContext)
-    cairo_destroy(_cairoContext);
+    {
+      cairo_destroy(_cairoContext);
+      _cairoContext = NULL;
+    }
   if (_cairoSurface)
-    cairo_surface_destroy(_cairoSurface);
+    {
+      cairo_surface_destroy(_cairoSurface);
+      _cairoSurface = NULL;
+    }
   if (_dfbSurface)
-    _dfbSurface->Release(_dfbSurface);
+    {
+      _dfbSurface->Release(_dfbSurface);
+      _dfbSurface = NULL;
+    }
+  if (_poolSurface)
+    {
+      surfacePoolRelease(_poolSurface);
+      _poolSurface = NULL;
+    }
   unlock();
 }
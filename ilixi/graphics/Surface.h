@@ -27,6 +27,7 @@
 #include <cairo-directfb.h>
 #include <pango/pangocairo.h>
 #include "types/Rectangle.h"
+#include "core/MemoryUsage.h"
 #include <string>
 
 namespace ilixi
@@ -48,15 +49,31 @@ namespace ilixi
     virtual
     ~Surface();
 
+    /*!
+     * Allocates surface from current arena if there is one, see ArenaScope.
+     */
+    static void*
+    operator new(size_t size);
+
+    /*!
+     * Frees surface allocated using operator new.
+     */
+    static void
+    operator delete(void* ptr, size_t size);
+
     /*!
      * Creates a new DFB surface which has the same pixel format as window.
      *
+     * Surface is a sub-surface of a pooled surface whose size is rounded up
+     * to a size class, see surfacePoolAcquire(). Pooled surface is returned
+     * to pool once this surface is released.
+     *
      * @param width in pixels.
      * @param height in pixels.
+     * @param doubleBuffered if false surface is created with a single buffer.
      */
-
     bool
-    createDFBSurface(int width, int height);
+    createDFBSurface(int width, int height, bool doubleBuffered = true);
 
     /*!
      * Creates a new DFB sub-surface.
@@ -105,6 +122,30 @@ namespace ilixi
     IDirectFBSurface*
     DFBSurface();
 
+    /*!
+     * Returns pixel memory owned by this surface in bytes, including
+     * rounding of pooled surface.
+     *
+     * Sub-surfaces share memory with their parent and return 0.
+     */
+    unsigned int
+    memoryUsage() const;
+
+    /*!
+     * Returns pixel memory of given DFB surface in bytes, counting all of its buffers.
+     *
+     * @param surface DFB surface.
+     */
+    static unsigned int
+    memoryUsage(IDirectFBSurface* surface);
+
+    /*!
+     * Adds pixel memory, cairo state and pango state of this surface to
+     * usage.
+     */
+    void
+    memoryUsage(MemoryUsage& usage) const;
+
     /*!
      * This method is used for modifying the current geometry of DirectFB surface.
      *
@@ -225,6 +266,8 @@ namespace ilixi
     IDirectFBSurface* _dfbSurface;
     //! Interface to parent DFB surface.
     IDirectFBSurface* _parentSurface;
+    //! Pooled surface which holds pixels, NULL for sub-surfaces of parent.
+    IDirectFBSurface* _poolSurface;
 
     //! Interface to cairo surface.
     cairo_surface_t* _cairoSurface;
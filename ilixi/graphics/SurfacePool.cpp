@@ -0,0 +1,219 @@
+/*
+ Copyright 2010, 2011 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "graphics/SurfacePool.h"
+#include "graphics/Surface.h"
+#include "core/Window.h"
+#include "core/Logger.h"
+#include "core/Trace.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <list>
+
+using namespace ilixi;
+
+namespace
+{
+  //! Idle surfaces older than this are released by trim, in nanoseconds.
+  const long long PoolMaxAge = 2000000000LL;
+  //! Minimum time between trims in nanoseconds.
+  const long long PoolTrimInterval = 1000000000LL;
+  //! Default limit of idle surfaces in kilobytes.
+  const int PoolDefaultLimit = 4096;
+
+  struct PoolEntry
+  {
+    IDirectFBSurface* surface;
+    int width;
+    int height;
+    unsigned int bytes;
+    //! Time surface was returned to pool.
+    long long released;
+  };
+
+  typedef std::list<PoolEntry> PoolList;
+
+  pthread_mutex_t poolLock = PTHREAD_MUTEX_INITIALIZER;
+  //! Idle surfaces, most recently released first.
+  PoolList pool;
+  SurfacePoolStats stats;
+  long long lastTrim = 0;
+  int poolLimit = -1;
+
+  //! Returns limit of idle surfaces in bytes.
+  unsigned int
+  limit()
+  {
+    if (poolLimit < 0)
+      {
+        const char* env = getenv("ILIXI_SURFACE_POOL");
+        int kb = (env && *env) ? atoi(env) : PoolDefaultLimit;
+        poolLimit = kb > 0 ? kb * 1024 : 0;
+      }
+    return poolLimit;
+  }
+
+  //! Rounds a dimension up to its size class, waste is at most 1/4 above 64.
+  int
+  sizeClass(int size)
+  {
+    int step = size <= 64 ? 16 : (size <= 512 ? 64 : 128);
+    return (size + step - 1) / step * step;
+  }
+
+  IDirectFBSurface*
+  create(int width, int height, bool doubleBuffered)
+  {
+    DFBSurfaceDescription desc;
+    desc.flags = (DFBSurfaceDescriptionFlags) (DSDESC_WIDTH | DSDESC_HEIGHT
+        | DSDESC_PIXELFORMAT | DSDESC_CAPS);
+    desc.width = width;
+    desc.height = height;
+    desc.pixelformat = Window::pixelFormat();
+    if (doubleBuffered)
+      desc.caps = (DFBSurfaceCapabilities) (DSCAPS_PREMULTIPLIED
+          | DSCAPS_DOUBLE);
+    else
+      desc.caps = DSCAPS_PREMULTIPLIED;
+    desc.hints = DSHF_FONT;
+    IDirectFBSurface* surface = NULL;
+    DFBResult ret = Window::DFBInterface()->CreateSurface(
+        Window::DFBInterface(), &desc, &surface);
+    if (ret)
+      {
+        ILOG_ERROR("DFB CreateSurface Error: %d", ret);
+        return NULL;
+      }
+    return surface;
+  }
+
+  //! Releases least recently used idle surface, pool must be locked.
+  unsigned int
+  dropOldest()
+  {
+    PoolEntry& entry = pool.back();
+    unsigned int bytes = entry.bytes;
+    entry.surface->Release(entry.surface);
+    stats.idle--;
+    stats.idleBytes -= bytes;
+    stats.trimmed++;
+    pool.pop_back();
+    return bytes;
+  }
+}
+
+IDirectFBSurface*
+ilixi::surfacePoolAcquire(int width, int height, bool doubleBuffered)
+{
+  // Flip of a sub-surface of a double buffered surface copies instead of
+  // swapping and reuse would clear only one buffer, so those are not pooled.
+  if (!limit() || doubleBuffered || width <= 0 || height <= 0)
+    return create(width, height, doubleBuffered);
+
+  width = sizeClass(width);
+  height = sizeClass(height);
+
+  IDirectFBSurface* surface = NULL;
+  pthread_mutex_lock(&poolLock);
+  for (PoolList::iterator it = pool.begin(); it != pool.end(); ++it)
+    {
+      if (it->width == width && it->height == height)
+        {
+          surface = it->surface;
+          stats.idle--;
+          stats.idleBytes -= it->bytes;
+          pool.erase(it);
+          break;
+        }
+    }
+  if (surface)
+    stats.hits++;
+  else
+    stats.misses++;
+  pthread_mutex_unlock(&poolLock);
+
+  if (!surface)
+    return create(width, height, false);
+
+  // reset state left by previous owner.
+  surface->SetClip(surface, NULL);
+  surface->Clear(surface, 0, 0, 0, 0);
+  return surface;
+}
+
+void
+ilixi::surfacePoolRelease(IDirectFBSurface* surface)
+{
+  if (!surface)
+    return;
+
+  DFBSurfaceCapabilities caps;
+  surface->GetCapabilities(surface, &caps);
+  unsigned int bytes = Surface::memoryUsage(surface);
+  if ((caps & DSCAPS_DOUBLE) || bytes > limit())
+    {
+      surface->Release(surface);
+      return;
+    }
+
+  PoolEntry entry;
+  surface->GetSize(surface, &entry.width, &entry.height);
+  entry.surface = surface;
+  entry.bytes = bytes;
+  entry.released = traceNow();
+
+  pthread_mutex_lock(&poolLock);
+  while (!pool.empty() && stats.idleBytes + bytes > limit())
+    dropOldest();
+  pool.push_front(entry);
+  stats.idle++;
+  stats.idleBytes += bytes;
+  pthread_mutex_unlock(&poolLock);
+}
+
+unsigned int
+ilixi::surfacePoolTrim(bool all)
+{
+  long long now = traceNow();
+  unsigned int bytes = 0;
+  pthread_mutex_lock(&poolLock);
+  if (all || now - lastTrim >= PoolTrimInterval)
+    {
+      lastTrim = now;
+      while (!pool.empty() && (all || now - pool.back().released > PoolMaxAge))
+        bytes += dropOldest();
+    }
+  pthread_mutex_unlock(&poolLock);
+  if (bytes)
+    ILOG_DEBUG("Surface pool released %u KB.", bytes / 1024);
+  return bytes;
+}
+
+SurfacePoolStats
+ilixi::surfacePoolStats()
+{
+  pthread_mutex_lock(&poolLock);
+  SurfacePoolStats snapshot = stats;
+  pthread_mutex_unlock(&poolLock);
+  return snapshot;
+}
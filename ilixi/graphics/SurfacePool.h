@@ -0,0 +1,93 @@
+/*
+ Copyright 2010, 2011 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ILIXI_SURFACEPOOL_H_
+#define ILIXI_SURFACEPOOL_H_
+
+#include <directfb.h>
+
+namespace ilixi
+{
+  //! Counters of surface pool.
+  struct SurfacePoolStats
+  {
+    //! Requests served by an idle surface.
+    unsigned int hits;
+    //! Requests which created a new surface.
+    unsigned int misses;
+    //! Number of idle surfaces in pool.
+    unsigned int idle;
+    //! Pixel memory of idle surfaces in bytes.
+    unsigned int idleBytes;
+    //! Number of idle surfaces released by trim policy.
+    unsigned int trimmed;
+  };
+
+  /*!
+   * Returns a surface in window pixel format which is at least width x
+   * height pixels.
+   *
+   * Dimensions of single buffered surfaces are rounded up to a size class,
+   * so that surfaces released by widgets of similar size can be reused;
+   * surface is cleared if it is reused. Callers should use a sub-surface of
+   * requested size. Double buffered surfaces are created with exact size
+   * and are not pooled. Returns NULL if surface can not be created.
+   *
+   * Pool keeps at most ILIXI_SURFACE_POOL kilobytes of idle surfaces,
+   * default is 4096. Setting it to 0 disables pooling and surfaces are
+   * created with exact size.
+   *
+   * @param width in pixels.
+   * @param height in pixels.
+   * @param doubleBuffered if false surface is created with a single buffer.
+   */
+  IDirectFBSurface*
+  surfacePoolAcquire(int width, int height, bool doubleBuffered);
+
+  /*!
+   * Returns surface to pool. Surface is released if pool is disabled, it is
+   * double buffered or it does not fit into pool even after least recently
+   * used surfaces are dropped.
+   *
+   * @param surface acquired using surfacePoolAcquire().
+   */
+  void
+  surfacePoolRelease(IDirectFBSurface* surface);
+
+  /*!
+   * Releases surfaces which were idle longer than two seconds. Checks at
+   * most once a second unless all is true, in which case every idle surface
+   * is released, e.g. before hibernating or releasing DirectFB. Returns
+   * bytes freed.
+   */
+  unsigned int
+  surfacePoolTrim(bool all = false);
+
+  /*!
+   * Returns a snapshot of pool counters.
+   */
+  SurfacePoolStats
+  surfacePoolStats();
+}
+
+#endif /* ILIXI_SURFACEPOOL_H_ */
@@ -26,6 +26,7 @@
 #include "types/LinearGradient.h"
 #include "types/RadialGradient.h"
 #include "ilixiGUI.h"
+#include "tdesigner_style.h"
 
 #include <libxml/xmlmemory.h>
 #include <libxml/parser.h>
@@ -41,6 +42,17 @@ TDesigner::TDesigner(const std::string& styleSheet) :
   setStyleSheet(styleSheet, ILIXI_DATADIR"tdesigner/");
 }
 
+TDesigner::TDesigner(const StyleTable& style) :
+  Designer(style, 2)
+{
+}
+
+const StyleTable&
+TDesigner::defaultStyle()
+{
+  return tdesignerStyle;
+}
+
 TDesigner::~TDesigner()
 {
 }
@@ -1054,14 +1066,21 @@ TDesigner::drawFrame(Painter* painter, const BorderBase* widget, int x, int y,
           painter->drawRectangle(x, y, width, height, Painter::FillPath);
         }
 
+      double left = x;
+      double top = y;
+      double right = x + width;
+      double bottom = y + height;
+
       pen->setLineWidth(widget->borderWidth());
       pen->setColor(_palette.getGroup(widget->state())._borderTop);
-      painter->drawLine(x, y, x + width, y);
-      painter->drawLine(x, y, x, y + height);
+      double topLeft[6] =
+        { left, bottom, left, top, right, top };
+      painter->drawPolyline(topLeft, 3);
 
       pen->setColor(_palette.getGroup(widget->state())._borderBottom);
-      painter->drawLine(x + width, y, x + width, y + height);
-      painter->drawLine(x, y + height, x + width, y + height);
+      double bottomRight[6] =
+        { right, top, right, bottom, left, bottom };
+      painter->drawPolyline(bottomRight, 3);
     }
   else if (widget->borderStyle() == SunkenBorder)
     {
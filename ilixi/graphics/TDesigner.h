@@ -34,6 +34,11 @@ namespace ilixi
   public:
     TDesigner(const std::string& styleSheet);
 
+    /*!
+     * Creates a designer using compiled tables, see defaultStyle().
+     */
+    TDesigner(const StyleTable& style);
+
     virtual
     ~TDesigner();
 
@@ -87,6 +92,12 @@ namespace ilixi
     virtual void
     drawLineEdit(Painter* painter, LineEdit* input, const Rectangle& selection);
 
+    /*!
+     * Returns tables compiled from data/tdesigner/stylesheet.xml at build time.
+     */
+    static const StyleTable&
+    defaultStyle();
+
   private:
     void
     drawButtonCheckIndicator(Painter* painter, Button* button,
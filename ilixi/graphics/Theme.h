@@ -0,0 +1,93 @@
+/*
+ Copyright 2010, 2011 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ILIXI_THEME_H_
+#define ILIXI_THEME_H_
+
+#include "directfb.h"
+#include "graphics/Palette.h"
+
+namespace ilixi
+{
+  //! Images of a theme.
+  enum ThemeImageType
+  {
+    ThemeArrowUp,
+    ThemeArrowDown,
+    ThemeArrowLeft,
+    ThemeArrowRight,
+    ThemeCheckEmpty,
+    ThemeCheckPartial,
+    ThemeCheckFull,
+    ThemeGrid,
+    ThemePlusSign,
+    ThemeMinusSign,
+    ThemeDialog,
+    ThemeDialogCritical,
+    ThemeDialogInfo,
+    ThemeDialogQuestion,
+    ThemeDialogWarning,
+    ThemeImageCount
+  };
+
+  //! Number of hints stored in a theme, see WidgetHint.
+  const int ThemeHintCount = TabPanelButtonOffset + 1;
+
+  //! Number of fonts stored in a theme, see DesignerFontType.
+  const int ThemeFontCount = InputFont + 1;
+
+  //! An image decoded into a shared DirectFB surface.
+  struct ThemeImage
+  {
+    //! ID of shared surface, 0 if image is not available.
+    DFBSurfaceID surfaceID;
+    //! Width of image.
+    int width;
+    //! Height of image.
+    int height;
+    //! Path to image file, used if shared surface can not be attached.
+    char path[256];
+  };
+
+  //! Parsed stylesheet and decoded images published by Maestro.
+  /*!
+   * Maestro parses the stylesheet once, decodes its images into shared
+   * surfaces and stores the result inside MaestroObject. Designer attaches
+   * to this theme instead of parsing the stylesheet if both use the same file.
+   */
+  struct Theme
+  {
+    //! Full path to stylesheet.
+    char styleSheet[256];
+    //! Colors for drawing and filling widgets.
+    Palette palette;
+    //! Hints indexed by WidgetHint.
+    int hints[ThemeHintCount];
+    //! Pango font descriptions indexed by DesignerFontType.
+    char fonts[ThemeFontCount][128];
+    //! Images indexed by ThemeImageType.
+    ThemeImage images[ThemeImageCount];
+  };
+}
+
+#endif /* ILIXI_THEME_H_ */
@@ -29,8 +29,10 @@ namespace ilixi
 #define ILIXI_VERSION 0.1.0
 #define ILIXI_BINDIR "/usr/local/bin/"
 #define ILIXI_DATADIR "/usr/local/share/ilixi-0.1.0/"	
+#define ILIXI_MODULEDIR "/usr/local/lib/ilixi-0.1.0/"
 #define ILIXI_LOGGER_ENABLED 1
 #define ILIXI_LOG_DEBUG_ENABLED 0
+#define ILIXI_LOG_LEVEL 5
 }
 
 #endif /* ILIXI_CONFIG_H_ */
@@ -22,6 +22,7 @@
  */
 
 #include "types/Brush.h"
+#include "core/Arena.h"
 
 using namespace ilixi;
 
@@ -45,6 +46,18 @@ Brush::~Brush()
 {
 }
 
+void*
+Brush::operator new(size_t size)
+{
+  return Arena::allocate(Arena::current(), size);
+}
+
+void
+Brush::operator delete(void* ptr, size_t size)
+{
+  Arena::deallocate(ptr, size);
+}
+
 Brush::BrushMode
 Brush::mode() const
 {
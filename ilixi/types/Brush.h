@@ -75,6 +75,18 @@ namespace ilixi
      */
     ~Brush();
 
+    /*!
+     * Allocates brush from current arena if there is one, see ArenaScope.
+     */
+    static void*
+    operator new(size_t size);
+
+    /*!
+     * Frees brush allocated using operator new.
+     */
+    static void
+    operator delete(void* ptr, size_t size);
+
     /*!
      * Returns brush mode. Default is SolidColorMode.
      */
@@ -210,7 +210,8 @@ namespace ilixi
 
     TabPanelHeight,
     TabPanelWidth,
-    TabPanelButtonHeight
+    TabPanelButtonHeight,
+    TabPanelButtonOffset
   };
 
   /*!
@@ -22,6 +22,9 @@
  */
 
 #include "types/Font.h"
+#include "core/MemoryUsage.h"
+#include "core/Arena.h"
+#include <string.h>
 
 using namespace ilixi;
 
@@ -53,6 +56,18 @@ Font::~Font()
   pango_font_description_free(_desc);
 }
 
+void*
+Font::operator new(size_t size)
+{
+  return Arena::allocate(Arena::current(), size);
+}
+
+void
+Font::operator delete(void* ptr, size_t size)
+{
+  Arena::deallocate(ptr, size);
+}
+
 PangoFontDescription*
 Font::fontDescription() const
 {
@@ -77,6 +92,13 @@ Font::size() const
   return pango_font_description_get_size(_desc);
 }
 
+unsigned int
+Font::memoryUsage() const
+{
+  const char* family = pango_font_description_get_family(_desc);
+  return sizeof(Font) + MemoryFontDescription + (family ? strlen(family) : 0);
+}
+
 PangoStretch
 Font::strecth() const
 {
@@ -77,6 +77,18 @@ namespace ilixi
      */
     ~Font();
 
+    /*!
+     * Allocates font from current arena if there is one, see ArenaScope.
+     */
+    static void*
+    operator new(size_t size);
+
+    /*!
+     * Frees font allocated using operator new.
+     */
+    static void
+    operator delete(void* ptr, size_t size);
+
     /*!
      * Returns font description.
      */
@@ -101,6 +113,12 @@ namespace ilixi
     int
     size() const;
 
+    /*!
+     * Returns estimated memory used by font description in bytes.
+     */
+    unsigned int
+    memoryUsage() const;
+
     /*!
      * Returns font strecth mode.
      */
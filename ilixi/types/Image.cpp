@@ -22,38 +22,59 @@
  */
 
 #include "types/Image.h"
+#include "graphics/Surface.h"
 #include "core/Window.h"
 #include "core/Logger.h"
+#include "core/Startup.h"
+#include "core/Trace.h"
 
 using namespace ilixi;
 
 IDirectFBImageProvider* Image::_provider = NULL;
+Image::ImageList Image::_images;
+pthread_mutex_t Image::_imagesLock = PTHREAD_MUTEX_INITIALIZER;
 
 Image::Image() :
-  _dfbSurface(0), _imagePath("")
+  _dfbSurface(0), _released(false), _sharedID(0), _imagePath("")
 {
+  addImage();
 }
 
 Image::Image(const std::string& path, int width, int height) :
-  _size(width, height), _dfbSurface(0)
+  _size(width, height), _dfbSurface(0), _released(false), _sharedID(0)
 {
+  addImage();
   loadImage(path);
 }
 
 Image::Image(const std::string& path, const Size& size) :
-  _size(size), _dfbSurface(0)
+  _size(size), _dfbSurface(0), _released(false), _sharedID(0)
 {
+  addImage();
   loadImage(path);
 }
 
+Image::Image(DFBSurfaceID surfaceID, const std::string& path,
+    const Size& size) :
+  _size(size), _dfbSurface(0), _released(false), _sharedID(0)
+{
+  addImage();
+  attachImage(surfaceID, path);
+}
+
 Image::Image(const Image& img) :
-  _size(img._size), _dfbSurface(0)
+  _size(img._size), _dfbSurface(0), _released(false), _sharedID(0)
 {
-  loadImage(img._imagePath);
+  addImage();
+  if (img._sharedID)
+    attachImage(img._sharedID, img._imagePath);
+  else
+    loadImage(img._imagePath);
 }
 
 Image::~Image()
 {
+  removeImage();
   if (_dfbSurface)
     _dfbSurface->Release(_dfbSurface);
 }
@@ -79,6 +100,14 @@ Image::size() const
 IDirectFBSurface*
 Image::getDFBSurface()
 {
+  if (_released)
+    {
+      _released = false;
+      if (_sharedID)
+        attachImage(_sharedID, _imagePath);
+      else
+        loadImage(_imagePath);
+    }
   return _dfbSurface;
 }
 
@@ -99,6 +128,8 @@ Image::loadImage(const std::string& path)
     }
 
   _imagePath = path;
+  _released = false;
+  _sharedID = 0;
 
   if (_dfbSurface)
     _dfbSurface->Release(_dfbSurface);
@@ -118,14 +149,106 @@ Image::loadImage(const std::string& path)
   return false;
 }
 
+bool
+Image::attachImage(DFBSurfaceID surfaceID, const std::string& path)
+{
+#if DIRECTFB_MAJOR_VERSION > 1 || DIRECTFB_MINOR_VERSION >= 5
+  if (surfaceID)
+    {
+      IDirectFBSurface* surface;
+      if (Window::DFBInterface()->GetSurface(Window::DFBInterface(), surfaceID,
+          &surface) == DFB_OK)
+        {
+          if (_dfbSurface)
+            _dfbSurface->Release(_dfbSurface);
+          _dfbSurface = surface;
+          _imagePath = path;
+          _released = false;
+          _sharedID = surfaceID;
+          return true;
+        }
+      ILOG_WARNING("Shared surface %u is not available, loading %s", surfaceID,
+          path.c_str());
+    }
+#endif
+  return loadImage(path);
+}
+
+DFBSurfaceID
+Image::surfaceID()
+{
+  DFBSurfaceID id = 0;
+#if DIRECTFB_MAJOR_VERSION > 1 || DIRECTFB_MINOR_VERSION >= 5
+  IDirectFBSurface* surface = getDFBSurface();
+  if (surface)
+    surface->GetID(surface, &id);
+#endif
+  return id;
+}
+
+unsigned int
+Image::memoryUsage() const
+{
+  if (!_dfbSurface || _sharedID)
+    return 0;
+  return Surface::memoryUsage(_dfbSurface);
+}
+
+unsigned int
+Image::release()
+{
+  if (!_dfbSurface)
+    return 0;
+  // shared surfaces are owned by another process.
+  unsigned int bytes = _sharedID ? 0 : Surface::memoryUsage(_dfbSurface);
+  _dfbSurface->Release(_dfbSurface);
+  _dfbSurface = NULL;
+  _released = true;
+  return bytes;
+}
+
+unsigned int
+Image::releaseAll()
+{
+  unsigned int bytes = 0;
+  pthread_mutex_lock(&_imagesLock);
+  for (ImageList::iterator it = _images.begin(); it != _images.end(); ++it)
+    bytes += (*it)->release();
+  pthread_mutex_unlock(&_imagesLock);
+  ILOG_DEBUG("Released %u bytes of image data.", bytes);
+  return bytes;
+}
+
+void
+Image::addImage()
+{
+  pthread_mutex_lock(&_imagesLock);
+  _images.push_back(this);
+  pthread_mutex_unlock(&_imagesLock);
+}
+
+void
+Image::removeImage()
+{
+  pthread_mutex_lock(&_imagesLock);
+  _images.remove(this);
+  pthread_mutex_unlock(&_imagesLock);
+}
+
 bool
 Image::renderToSurface(IDirectFBSurface* surface, const char* path, int width,
     int height)
 {
+  ILIXI_TRACE("decodeImage");
+  startupBegin(StartupImages);
   if (Window::DFBInterface()->CreateImageProvider(Window::DFBInterface(), path,
       &_provider) != DFB_OK)
-    return false;
+    {
+      startupEnd(StartupImages);
+      return false;
+    }
   _provider->RenderTo(_provider, surface, NULL);
   _provider->Release(_provider);
+  startupEnd(StartupImages);
   return true;
 }
@@ -27,6 +27,8 @@
 #include "directfb.h"
 #include "types/Size.h"
 #include <string>
+#include <list>
+#include <pthread.h>
 
 namespace ilixi
 {
@@ -58,6 +60,15 @@ namespace ilixi
      */
     Image(const std::string& path, const Size& size);
 
+    /*!
+     * Attaches to a shared surface, see attachImage().
+     *
+     * @param surfaceID
+     * @param path
+     * @param size
+     */
+    Image(DFBSurfaceID surfaceID, const std::string& path, const Size& size);
+
     /*!
      * Copy constructor.
      */
@@ -88,6 +99,8 @@ namespace ilixi
 
     /*!
      * Returns a pointer to DirectFB surface.
+     *
+     * If image was released, it is loaded again first.
      */
     IDirectFBSurface*
     getDFBSurface();
@@ -105,6 +118,42 @@ namespace ilixi
     bool
     loadImage(const std::string& path);
 
+    /*!
+     * Attaches to a surface decoded by another process, e.g. Maestro. If surface
+     * is not available, image is loaded from path. Returns true if successful.
+     *
+     * @param surfaceID ID of a shared surface.
+     * @param path image path.
+     */
+    bool
+    attachImage(DFBSurfaceID surfaceID, const std::string& path);
+
+    /*!
+     * Returns ID of decoded surface for sharing with other processes, 0 if not available.
+     */
+    DFBSurfaceID
+    surfaceID();
+
+    /*!
+     * Returns memory used by decoded surface in bytes. Surfaces shared by
+     * another process and released images return 0.
+     */
+    unsigned int
+    memoryUsage() const;
+
+    /*!
+     * Releases decoded surface while keeping image path and size. Image is
+     * loaded again on next call to getDFBSurface(). Returns bytes freed.
+     */
+    unsigned int
+    release();
+
+    /*!
+     * Releases decoded surfaces of all images in application. Returns bytes freed.
+     */
+    static unsigned int
+    releaseAll();
+
   private:
     //! This property stores the size for image.
     Size _size;
@@ -112,9 +161,27 @@ namespace ilixi
     std::string _imagePath;
     //! This property stores the pointer to DirectFB surface.
     IDirectFBSurface* _dfbSurface;
+    //! This flag is set if surface is released and should be loaded on demand.
+    bool _released;
+    //! ID of attached shared surface, 0 if surface is decoded by this image.
+    DFBSurfaceID _sharedID;
     //! This property stores the pointer to DirectFB provider.
     static IDirectFBImageProvider* _provider;
 
+    typedef std::list<Image*> ImageList;
+    //! List of all images in application.
+    static ImageList _images;
+    //! Serialises access to image list.
+    static pthread_mutex_t _imagesLock;
+
+    //! Adds image to image list.
+    void
+    addImage();
+
+    //! Removes image from image list.
+    void
+    removeImage();
+
     /*!
      * Renders image to DirectFB surface using provider.
      * @param surface
@@ -23,31 +23,91 @@
 
 #include "types/Video.h"
 #include "core/Window.h"
+#include "core/AppBase.h"
+#include "graphics/ColorConversion.h"
 #include "core/Logger.h"
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
+#include <sys/time.h>
+#include <unistd.h>
 
 using namespace ilixi;
 
-static void
-videoCB(void *cdata)
+//! Number of recent latencies kept for percentile calculation.
+static const unsigned int latencySamples = 256;
+//! Refresh period assumed if display does not provide one, 60 Hz.
+static const long defaultRefreshPeriod = 16667;
+//! Tolerance for refresh jitter when counting late frames.
+static const long refreshSlack = 1000;
+
+static long long
+timeMicros()
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec * 1000000LL + tv.tv_usec;
+}
+
+namespace ilixi
+{
+  void
+  videoCB(void *cdata)
+  {
+    Video* v = (Video*) cdata;
+    v->queueFrame();
+  }
+}
+
+//*********************************************************************
+// VideoPresenter
+//*********************************************************************
+VideoPresenter::VideoPresenter(Video* video) :
+  Thread(), _video(video)
+{
+}
+
+VideoPresenter::~VideoPresenter()
 {
-  Video* v = (Video*) cdata;
-  v->frameUpdated(v->frame());
 }
 
-Video::Video(const std::string& path) :
-  _provider(NULL), _frame(NULL)
+int
+VideoPresenter::run()
 {
+  _video->measureRefresh();
+  while (_video->presentFrame())
+    ;
+  return 0;
+}
+
+//*********************************************************************
+// Video
+//*********************************************************************
+Video::Video(const std::string& path, FrameFormat format) :
+  _provider(NULL), _frame(NULL), _target(NULL), _frameFormat(format),
+      _pendingIndex(-1), _presentingIndex(-1), _framePending(false),
+      _presenting(false), _decodeTime(0), _lastRefresh(0),
+      _refreshPeriod(defaultRefreshPeriod), _latencySum(0),
+      _latencies(latencySamples, 0), _latencyIndex(0)
+{
+  for (int i = 0; i < 3; ++i)
+    _argbFrames[i] = NULL;
+  pthread_mutex_init(&_frameLock, NULL);
+  pthread_cond_init(&_frameCond, NULL);
+  _presenter = new VideoPresenter(this);
+  resetStatistics();
   load(path);
 }
 
 Video::~Video()
 {
+  stop();
+  delete _presenter;
+  pthread_cond_destroy(&_frameCond);
+  pthread_mutex_destroy(&_frameLock);
   if (_provider)
     _provider->Release(_provider);
-  if (_frame)
-    _frame->Release(_frame);
+  releaseFrames();
 }
 
 double
@@ -231,6 +291,18 @@ Video::frame() const
   return _frame;
 }
 
+IDirectFBSurface*
+Video::target() const
+{
+  return _target;
+}
+
+Video::FrameFormat
+Video::frameFormat() const
+{
+  return _frameFormat;
+}
+
 bool
 Video::load(const std::string& path)
 {
@@ -243,8 +315,10 @@ Video::load(const std::string& path)
       return false;
     }
 
+  stop();
   if (_provider)
     _provider->Release(_provider);
+  releaseFrames();
 
   int ret = Window::DFBInterface()->CreateVideoProvider(Window::DFBInterface(),
       path.c_str(), &_provider);
@@ -263,8 +337,29 @@ Video::load(const std::string& path)
       if (_streamDesc.caps & DVSCAPS_VIDEO)
         {
           _provider->GetSurfaceDescription(_provider, &_surfaceDesc);
-          Window::DFBInterface()->CreateSurface(Window::DFBInterface(),
-              &_surfaceDesc, &_frame);
+          if (_frameFormat == NativeYUV)
+            {
+              DFBSurfaceDescription desc = _surfaceDesc;
+              if (desc.pixelformat != DSPF_I420 && desc.pixelformat
+                  != DSPF_YV12 && desc.pixelformat != DSPF_UYVY)
+                desc.pixelformat = DSPF_I420;
+              // frames are read by CPU, keep them in system memory.
+              desc.flags = (DFBSurfaceDescriptionFlags) (desc.flags
+                  | DSDESC_PIXELFORMAT | DSDESC_CAPS);
+              desc.caps = DSCAPS_SYSTEMONLY;
+              Window::DFBInterface()->CreateSurface(Window::DFBInterface(),
+                  &desc, &_frame);
+              _surfaceDesc.pixelformat = desc.pixelformat;
+
+              desc.pixelformat = DSPF_ARGB;
+              desc.caps = DSCAPS_PREMULTIPLIED;
+              for (int i = 0; i < 3; ++i)
+                Window::DFBInterface()->CreateSurface(Window::DFBInterface(),
+                    &desc, &_argbFrames[i]);
+            }
+          else
+            Window::DFBInterface()->CreateSurface(Window::DFBInterface(),
+                &_surfaceDesc, &_frame);
         }
 
       _provider->GetCapabilities(_provider, &_providerCaps);
@@ -274,9 +369,24 @@ Video::load(const std::string& path)
 
 void
 Video::play()
+{
+  play(_frame);
+}
+
+void
+Video::play(IDirectFBSurface* surface, DFBRectangle* rect)
 {
   if (_provider)
-    _provider->PlayTo(_provider, _frame, NULL, videoCB, (void*) this);
+    {
+      if (_argbFrames[0] && surface != _frame)
+        ILOG_WARNING("NativeYUV frames are not converted for this surface!");
+      _target = surface;
+      startPresenter();
+      DFBResult ret = _provider->PlayTo(_provider, _target, rect, videoCB,
+          (void*) this);
+      if (ret)
+        ILOG_ERROR("DFBVideoProvider: PlayTo Error: %d", ret);
+    }
 }
 
 void
@@ -304,6 +414,7 @@ Video::stop()
 {
   if (_provider)
     _provider->Stop(_provider);
+  stopPresenter();
 }
 
 void
@@ -326,6 +437,227 @@ Video::setVolume(float level)
       ;
 }
 
+VideoStatistics
+Video::statistics()
+{
+  pthread_mutex_lock(&_frameLock);
+  VideoStatistics stats = _stats;
+  unsigned int count = std::min(_stats.presented, latencySamples);
+  std::vector<long> recent(_latencies.begin(), _latencies.begin() + count);
+  pthread_mutex_unlock(&_frameLock);
+
+  if (count)
+    {
+      std::vector<long>::iterator p99 = recent.begin() + (count * 99) / 100;
+      std::nth_element(recent.begin(), p99, recent.end());
+      stats.p99Latency = *p99 / 1000.0;
+    }
+  return stats;
+}
+
+void
+Video::resetStatistics()
+{
+  pthread_mutex_lock(&_frameLock);
+  _stats.decoded = 0;
+  _stats.presented = 0;
+  _stats.dropped = 0;
+  _stats.late = 0;
+  _stats.meanLatency = 0;
+  _stats.p99Latency = 0;
+  _latencySum = 0;
+  _latencyIndex = 0;
+  pthread_mutex_unlock(&_frameLock);
+}
+
+void
+Video::queueFrame()
+{
+  int index = -1;
+  if (_argbFrames[0] && _target == _frame)
+    {
+      index = convertFrame();
+      if (index < 0)
+        return;
+    }
+
+  pthread_mutex_lock(&_frameLock);
+  _stats.decoded++;
+  if (_framePending)
+    _stats.dropped++;
+  _framePending = true;
+  _pendingIndex = index;
+  _decodeTime = timeMicros();
+  pthread_cond_signal(&_frameCond);
+  pthread_mutex_unlock(&_frameLock);
+}
+
+bool
+Video::presentFrame()
+{
+  pthread_mutex_lock(&_frameLock);
+  while (_presenting && !_framePending)
+    pthread_cond_wait(&_frameCond, &_frameLock);
+  if (!_presenting)
+    {
+      pthread_mutex_unlock(&_frameLock);
+      return false;
+    }
+  _framePending = false;
+  _presentingIndex = _pendingIndex;
+  _pendingIndex = -1;
+  long long decodeTime = _decodeTime;
+  pthread_mutex_unlock(&_frameLock);
+
+  // hand frame over right after a refresh, receivers then have a whole
+  // refresh period until their DSFLIP_WAITFORSYNC flip shows it.
+  long long refresh = waitForRefresh();
+
+  pthread_mutex_lock(&_frameLock);
+  if (_framePending)
+    {
+      // a newer frame was decoded while waiting, it replaces this one.
+      _stats.dropped++;
+      _framePending = false;
+      _presentingIndex = _pendingIndex;
+      _pendingIndex = -1;
+      decodeTime = _decodeTime;
+    }
+  pthread_mutex_unlock(&_frameLock);
+
+  if (_presentingIndex < 0)
+    frameUpdated(_target);
+  else
+    frameUpdated(_argbFrames[_presentingIndex]);
+
+  long latency = timeMicros() - decodeTime;
+
+  pthread_mutex_lock(&_frameLock);
+  _stats.presented++;
+  // deadline is first refresh after decoding, which is at most one refresh
+  // period away.
+  if (refresh - decodeTime > _refreshPeriod + refreshSlack)
+    _stats.late++;
+  _latencySum += latency;
+  _stats.meanLatency = _latencySum / (_stats.presented * 1000.0);
+  _latencies[_latencyIndex] = latency;
+  _latencyIndex = (_latencyIndex + 1) % latencySamples;
+  _presentingIndex = -1;
+  pthread_mutex_unlock(&_frameLock);
+  return true;
+}
+
+void
+Video::measureRefresh()
+{
+  IDirectFBDisplayLayer* layer = Window::DFBLayer();
+  if (AppBase::headless() || !layer)
+    {
+      _refreshPeriod = defaultRefreshPeriod;
+      _lastRefresh = timeMicros();
+      return;
+    }
+
+  layer->WaitForSync(layer);
+  long long start = timeMicros();
+  layer->WaitForSync(layer);
+  _lastRefresh = timeMicros();
+  _refreshPeriod = _lastRefresh - start;
+  if (_refreshPeriod < 1000 || _refreshPeriod > 100000)
+    {
+      ILOG_WARNING("Refresh period %ld us is not plausible, using %ld us.",
+          _refreshPeriod, defaultRefreshPeriod);
+      _refreshPeriod = defaultRefreshPeriod;
+    }
+}
+
+long long
+Video::waitForRefresh()
+{
+  IDirectFBDisplayLayer* layer = Window::DFBLayer();
+  if (!AppBase::headless() && layer)
+    {
+      layer->WaitForSync(layer);
+      _lastRefresh = timeMicros();
+      return _lastRefresh;
+    }
+
+  // without a display, refreshes are simulated by a timer.
+  long long now = timeMicros();
+  long long next = _lastRefresh + ((now - _lastRefresh) / _refreshPeriod + 1)
+      * _refreshPeriod;
+  usleep(next - now);
+  _lastRefresh = next;
+  return next;
+}
+
+int
+Video::convertFrame()
+{
+  // use the frame which is neither pending nor being presented.
+  pthread_mutex_lock(&_frameLock);
+  int index = 0;
+  while (index == _pendingIndex || index == _presentingIndex)
+    ++index;
+  pthread_mutex_unlock(&_frameLock);
+
+  void* src;
+  void* dst;
+  int srcPitch, dstPitch;
+  IDirectFBSurface* argb = _argbFrames[index];
+  if (_frame->Lock(_frame, DSLF_READ, &src, &srcPitch))
+    return -1;
+  if (argb->Lock(argb, DSLF_WRITE, &dst, &dstPitch))
+    {
+      _frame->Unlock(_frame);
+      return -1;
+    }
+  bool ok = convertYUVToARGB(_surfaceDesc.pixelformat, src, srcPitch, dst,
+      dstPitch, _surfaceDesc.width, _surfaceDesc.height);
+  argb->Unlock(argb);
+  _frame->Unlock(_frame);
+  return ok ? index : -1;
+}
+
+void
+Video::releaseFrames()
+{
+  if (_frame)
+    {
+      _frame->Release(_frame);
+      _frame = NULL;
+    }
+  for (int i = 0; i < 3; ++i)
+    if (_argbFrames[i])
+      {
+        _argbFrames[i]->Release(_argbFrames[i]);
+        _argbFrames[i] = NULL;
+      }
+}
+
+void
+Video::startPresenter()
+{
+  stopPresenter();
+  pthread_mutex_lock(&_frameLock);
+  _presenting = true;
+  _framePending = false;
+  pthread_mutex_unlock(&_frameLock);
+  _presenter->start();
+}
+
+void
+Video::stopPresenter()
+{
+  pthread_mutex_lock(&_frameLock);
+  bool presenting = _presenting;
+  _presenting = false;
+  pthread_cond_signal(&_frameCond);
+  pthread_mutex_unlock(&_frameLock);
+  if (presenting)
+    _presenter->join();
+}
+
 std::string
 Video::toString()
 {
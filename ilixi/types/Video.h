@@ -25,23 +25,79 @@
 #define ILIXI_VIDEO_H_
 
 #include "directfb.h"
+#include "core/Thread.h"
 #include <string>
+#include <vector>
 #include <sigc++/signal.h>
 
 namespace ilixi
 {
+  class Video;
+
+  //! Presents decoded frames of a video.
+  class VideoPresenter : public Thread
+  {
+  public:
+    VideoPresenter(Video* video);
+
+    virtual
+    ~VideoPresenter();
+
+    int
+    run();
+
+  private:
+    Video* _video;
+  };
+
+  //! Video playback statistics.
+  struct VideoStatistics
+  {
+    //! Number of frames decoded by provider.
+    unsigned int decoded;
+    //! Number of frames presented.
+    unsigned int presented;
+    //! Number of frames replaced by a newer frame before being presented.
+    unsigned int dropped;
+    //! Number of frames which missed first display refresh after decoding.
+    unsigned int late;
+    //! Mean presentation latency in milliseconds.
+    double meanLatency;
+    //! 99th percentile of presentation latency in milliseconds.
+    double p99Latency;
+  };
+
   //! Loads and plays video using DirectFB video providers.
+  /*!
+   * Decoded frames are handed over to a presenter thread which emits
+   * frameUpdated right after a display refresh. If presentation can not keep
+   * up with decoding, only the newest frame is kept and older ones are
+   * dropped.
+   */
   class Video : virtual public sigc::trackable
   {
+    friend class VideoPresenter;
     friend void
-    renderToSurface(void *);
+    videoCB(void *);
 
   public:
+    /*!
+     * This enum specifies pixel format of frames decoded by play().
+     */
+    enum FrameFormat
+    {
+      ProviderFormat, //!< Provider selects format, DirectFB converts when frame is blitted.
+      NativeYUV
+    //!< Provider decodes to YUV, frames are converted to ARGB by ilixi before presentation.
+    };
 
     /*!
      * Constructor.
+     *
+     * @param path to video file.
+     * @param format pixel format of decoded frames.
      */
-    Video(const std::string& path);
+    Video(const std::string& path, FrameFormat format = ProviderFormat);
 
     /*!
      * Destructor.
@@ -181,6 +237,19 @@ namespace ilixi
     IDirectFBSurface*
     frame() const;
 
+    /*!
+     * Returns the surface which video provider renders into. This is either
+     * video frame or the surface given to play(IDirectFBSurface*).
+     */
+    IDirectFBSurface*
+    target() const;
+
+    /*!
+     * Returns pixel format of decoded frames.
+     */
+    FrameFormat
+    frameFormat() const;
+
     /*!
      * Loads a video file. Returns true if successful.
      */
@@ -193,6 +262,18 @@ namespace ilixi
     void
     play();
 
+    /*!
+     * Starts playing video directly onto given surface, e.g. a sub-surface
+     * of a window. Frames are scaled to fit destination rectangle and
+     * private video frame is not used. NativeYUV frames are only converted
+     * when surface is video frame.
+     *
+     * @param surface destination surface.
+     * @param rect destination rectangle inside surface, or NULL for whole surface.
+     */
+    void
+    play(IDirectFBSurface* surface, DFBRectangle* rect = NULL);
+
     /*!
      * Pauses video.
      */
@@ -224,13 +305,25 @@ namespace ilixi
     void
     setVolume(float level);
 
+    /*!
+     * Returns frame counters and presentation latency since playback started.
+     */
+    VideoStatistics
+    statistics();
+
+    /*!
+     * Resets frame counters and presentation latency.
+     */
+    void
+    resetStatistics();
+
     /*!
      * Returns video and audio information.
      */
     std::string
     toString();
 
-    //! This signal is emitted when a new frame is available.
+    //! This signal is emitted from presenter thread when a new frame is available.
     sigc::signal<void, IDirectFBSurface*> frameUpdated;
 
   private:
@@ -238,6 +331,16 @@ namespace ilixi
     IDirectFBVideoProvider* _provider;
     //! Video surface.
     IDirectFBSurface* _frame;
+    //! Surface which provider renders into.
+    IDirectFBSurface* _target;
+    //! Pixel format of decoded frames.
+    FrameFormat _frameFormat;
+    //! Converted frames if frame format is NativeYUV, used in rotation.
+    IDirectFBSurface* _argbFrames[3];
+    //! Index of converted frame waiting for presentation, or -1.
+    int _pendingIndex;
+    //! Index of converted frame being presented, or -1.
+    int _presentingIndex;
 
     //! Path to video file.
     std::string _path;
@@ -247,6 +350,64 @@ namespace ilixi
     DFBSurfaceDescription _surfaceDesc;
     //! DFB video provider capabilities.
     DFBVideoProviderCapabilities _providerCaps;
+
+    //! Emits frameUpdated for queued frames.
+    VideoPresenter* _presenter;
+    //! Protects presentation queue and statistics.
+    pthread_mutex_t _frameLock;
+    //! Signalled when a frame is queued or presentation stops.
+    pthread_cond_t _frameCond;
+    //! True if a decoded frame is waiting for presentation.
+    bool _framePending;
+    //! False if presenter thread should exit.
+    bool _presenting;
+    //! Decode time of pending frame in microseconds.
+    long long _decodeTime;
+    //! Time of last display refresh in microseconds.
+    long long _lastRefresh;
+    //! Display refresh period in microseconds.
+    long _refreshPeriod;
+
+    //! Frame counters.
+    VideoStatistics _stats;
+    //! Sum of presentation latencies in microseconds.
+    long long _latencySum;
+    //! Recent presentation latencies in microseconds, used as a ring buffer.
+    std::vector<long> _latencies;
+    //! Next position in _latencies.
+    unsigned int _latencyIndex;
+
+    //! Queues a decoded frame, replacing pending frame if any.
+    void
+    queueFrame();
+
+    //! Converts YUV frame into a free ARGB frame, returns its index or -1.
+    int
+    convertFrame();
+
+    //! Releases frame surfaces.
+    void
+    releaseFrames();
+
+    //! Waits for a queued frame and presents it. Returns false if stopped.
+    bool
+    presentFrame();
+
+    //! Measures display refresh period, called by presenter thread.
+    void
+    measureRefresh();
+
+    //! Waits for next display refresh and returns its time.
+    long long
+    waitForRefresh();
+
+    //! Starts presenter thread.
+    void
+    startPresenter();
+
+    //! Stops presenter thread.
+    void
+    stopPresenter();
   };
 
 }
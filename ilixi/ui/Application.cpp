@@ -24,16 +24,32 @@
 #include "ui/Application.h"
 #include "graphics/Painter.h"
 #include "graphics/TDesigner.h"
+#include "graphics/SurfacePool.h"
 #include "core/Logger.h"
+#include "core/Startup.h"
+#include "core/Trace.h"
+#include "core/PerfStats.h"
+#include "ui/PerfHUD.h"
+#include "types/Image.h"
 
 using namespace ilixi;
 
+namespace
+{
+  //! Minimum time between memory usage updates in nanoseconds.
+  const long long MemoryPublishInterval = 1000000000LL;
+}
+
 Application::Application(int argc, char* argv[]) :
-  AppBase(argc, argv), WindowWidget(), _fullscreen(false)
+  AppBase(argc, argv), WindowWidget(), _fullscreen(false),
+      _backgroundImage(NULL), _hibernation(true), _hibernated(false),
+      _hud(NULL), _memoryPublished(0)
 {
+  pthread_mutex_init(&_hibernateLock, NULL);
   _surfaceDesc = WindowDescription;
   initDFB(NULL, NULL);
   setUIManager(_windowUIManager);
+  Designer::setSharedTheme(sharedTheme());
   setDesigner("TDesigner", "stylesheet.xml");
   //  _designer = getDesigner();
   setTitle("Untitled");
@@ -49,7 +65,9 @@ Application::Application(int argc, char* argv[]) :
 
 Application::~Application()
 {
+  delete _hud;
   delete _designer;
+  pthread_mutex_destroy(&_hibernateLock);
 }
 
 void
@@ -62,27 +80,60 @@ Application::onShow()
 {
 }
 
+void
+Application::onClipboardChanged(unsigned int generation)
+{
+}
+
 void
 Application::quit()
 {
   setAppMode(Terminated);
 }
 
+void
+Application::setHibernation(bool hibernation)
+{
+  _hibernation = hibernation;
+}
+
+void
+Application::setPerfHUDVisible(bool visible, bool flash)
+{
+  if (visible)
+    {
+      if (!_hud)
+        _hud = new PerfHUD();
+      _hud->showHUD(getStatusBarHeight());
+      perfFlashEnabled = flash;
+      _memoryPublished = 0;
+    }
+  else if (_hud)
+    _hud->hideHUD();
+}
+
 void
 Application::exec()
 {
   ILOG_DEBUG( "%s is starting...", title().c_str());
   callMaestro(ModeRequest, Visible);
 
+  const char* hud = getenv("ILIXI_HUD");
+  if (hud && *hud)
+    setPerfHUDVisible(true, strcmp(hud, "flash") == 0);
+
   // enter event loop
   bool quit = false;
   DFBWindowEvent event;
 
   while (!quit)
     {
+      tracePoll();
 
       if (appMode() == Terminated)
         quit = true;
+      else if (_hibernation && !_hibernated && appMode() == Hidden)
+        hibernate();
 
       if (!_activeWindow)
         {
@@ -91,6 +142,7 @@ Application::exec()
         }
 
       _buffer->WaitForEventWithTimeout(_buffer, 0, 50);
+      ILIXI_TRACE("exec");
       while (_buffer->GetEvent(_buffer, DFB_EVENT(&event)) == DFB_OK)
         {
           // Ignore events outside active window.
@@ -114,6 +166,17 @@ Application::exec()
               continue;
             }
 
+          // handle F12 release, toggles performance HUD.
+          else if (event.key_symbol == DIKS_F12 && event.type == DWET_KEYUP)
+            {
+              bool visible = _hud && _hud->hudVisible();
+              if (event.modifiers == DIMM_SHIFT)
+                setPerfHUDVisible(true, !(visible && perfFlashEnabled));
+              else
+                setPerfHUDVisible(!visible);
+              continue;
+            }
+
           // handle TAB release.
           else if (event.key_symbol == DIKS_TAB && event.type == DWET_KEYUP)
             {
@@ -128,6 +191,11 @@ Application::exec()
             _activeWindow->handleWindowEvent(event);
         }
 
+      surfacePoolTrim();
+      publishMemoryUsage();
+      if (_hud)
+        _hud->refresh();
+
       // Paint windows which have updates pending
       for (windowListIterator it = _windowList.begin(); it != _windowList.end(); ++it)
         ((Window*) *it)->updateWindow();
@@ -140,8 +208,15 @@ Application::exec()
 void
 Application::show(Window::TransitionStyle style, int value1, int value2)
 {
+  pthread_mutex_lock(&_hibernateLock);
   if (appMode() != Visible)
     {
+      if (_hibernated)
+        {
+          restoreWindowSurface();
+          _hibernated = false;
+          setHibernated(0);
+        }
       initDFBWindow();
       setSize(_windowDesc.width, _windowDesc.height);
       setUIManager(_windowUIManager);
@@ -154,6 +229,7 @@ Application::show(Window::TransitionStyle style, int value1, int value2)
       callMaestro(Notification, Visible);
       onShow();
     }
+  pthread_mutex_unlock(&_hibernateLock);
 }
 
 void
@@ -169,15 +245,68 @@ Application::hide(Window::TransitionStyle style, int value1, int value2)
     }
 }
 
+void
+Application::hibernate()
+{
+  pthread_mutex_lock(&_hibernateLock);
+  if (appMode() == Hidden)
+    {
+      // widget surfaces go to surface pool, which is emptied afterwards.
+      unsigned int bytes = surfacePoolStats().idleBytes;
+      bytes += releaseSurfaces();
+      surfacePoolTrim(true);
+      bytes += releaseWindowSurface();
+      bytes += Image::releaseAll();
+      _hibernated = true;
+      setHibernated(bytes);
+      ILOG_NOTICE("Hibernating, released %u KB.", bytes / 1024);
+    }
+  pthread_mutex_unlock(&_hibernateLock);
+}
+
+void
+Application::memoryUsage(MemoryUsage& usage) const
+{
+  WindowWidget::memoryUsage(usage);
+  if (_backgroundImage)
+    usage.images += _backgroundImage->memoryUsage();
+}
+
+void
+Application::publishMemoryUsage()
+{
+  long long now = traceNow();
+  if (_memoryPublished && now - _memoryPublished < MemoryPublishInterval)
+    return;
+  _memoryPublished = now;
+
+  // HUD is not part of application, it would only skew results.
+  MemoryUsage usage;
+  for (windowListIterator it = _windowList.begin(); it != _windowList.end(); ++it)
+    {
+      WindowWidget* window = dynamic_cast<WindowWidget*> (*it);
+      if (window && window != _hud)
+        window->memoryUsage(usage);
+    }
+  setMemoryUsage(usage);
+  if (_hud)
+    _hud->setMemoryUsage(usage);
+}
+
 void
 Application::setDesigner(const char* designer, const char* styleSheet)
 {
   if (_designer)
     return;
-  if (!strcmp(designer, "TDesigner"))
+  startupBegin(StartupDesigner);
+  // default stylesheet is compiled at build time, others are parsed.
+  if (!strcmp(designer, "TDesigner") && !strcmp(styleSheet, "stylesheet.xml"))
+    _designer = new TDesigner(TDesigner::defaultStyle());
+  else if (!strcmp(designer, "TDesigner"))
     _designer = new TDesigner(styleSheet);
   else
     _designer = new Designer(styleSheet);
+  startupEnd(StartupDesigner);
 }
 
 void
@@ -241,9 +370,13 @@ Application::reactorCB(ReactorMessage *msg, void *ctx)
       }
     break;
 
+  case ClipboardChanged:
+    onClipboardChanged(msg->appID);
+    return RS_OK;
+
   case OSKEvent:
     if (msg->senderFusionID == 1)
-      _activeWindow->_windowUIManager->setOSKWidgetText(getOSKText());
+      _activeWindow->_windowUIManager->applyOSKEdits(msg->mode == Ready);
     else
       {
         ILOG_ERROR("Sender is not authorised!");
@@ -31,6 +31,8 @@
 
 namespace ilixi
 {
+  class PerfHUD;
+
   //! Main application.
   /*!
    * This class is used to create a new UI application.
@@ -59,10 +61,47 @@ namespace ilixi
     virtual void
     onShow();
 
+    /*!
+     * This method is called when another application publishes a buffer on
+     * clipboard.
+     *
+     * @param generation clipboard generation, see clipboardGeneration().
+     */
+    virtual void
+    onClipboardChanged(unsigned int generation);
+
     //! Terminates application.
     void
     quit();
 
+    /*!
+     * Sets whether application releases its window surface, widget surfaces
+     * and decoded images while hidden. Released resources are created again
+     * on demand once application is shown. Enabled by default.
+     *
+     * @param hibernation
+     */
+    void
+    setHibernation(bool hibernation);
+
+    /*!
+     * Shows or hides performance HUD. HUD can also be toggled using F12 key
+     * and repaint flashing using Shift+F12. If ILIXI_HUD environment
+     * variable is set, HUD is shown at startup and if it is set to "flash",
+     * repaint flashing is enabled as well.
+     *
+     * @param visible
+     * @param flash if true, damaged regions are flashed as they are repainted.
+     */
+    void
+    setPerfHUDVisible(bool visible, bool flash = false);
+
+    /*!
+     * Adds background image to usage as well.
+     */
+    virtual void
+    memoryUsage(MemoryUsage& usage) const;
+
     /*!
      * Final!
      */
@@ -104,6 +143,31 @@ namespace ilixi
     Image* _backgroundImage;
     //! Title of this application.
     std::string _appTitle;
+    //! This flag specifies if application hibernates while hidden.
+    bool _hibernation;
+    //! This flag is set while application is hibernating.
+    bool _hibernated;
+    //! Serialises hibernate() and show().
+    pthread_mutex_t _hibernateLock;
+    //! Performance HUD, created on demand.
+    PerfHUD* _hud;
+    //! Time memory usage was last published in nanoseconds.
+    long long _memoryPublished;
+
+    /*!
+     * Releases surfaces and decoded images if application is hidden. This
+     * method is executed inside main event loop.
+     */
+    void
+    hibernate();
+
+    /*!
+     * Sums memory usage of application windows and publishes it in
+     * application record and HUD once a second. This method is executed
+     * inside main event loop.
+     */
+    void
+    publishMemoryUsage();
 
     //! Paints background using current designer.
     virtual void
@@ -39,6 +39,14 @@ Button::~Button()
   delete _icon;
 }
 
+void
+Button::memoryUsage(MemoryUsage& usage) const
+{
+  TextLayout::memoryUsage(usage);
+  if (_icon)
+    usage.images += _icon->memoryUsage();
+}
+
 bool
 Button::checkable() const
 {
@@ -47,6 +47,12 @@ namespace ilixi
     virtual
     ~Button();
 
+    /*!
+     * Adds icon image to usage.
+     */
+    virtual void
+    memoryUsage(MemoryUsage& usage) const;
+
     /*!
      * Returns true if button is checkable.
      */
@@ -25,6 +25,8 @@
 #include "core/UIManager.h"
 #include <algorithm>
 #include "core/Logger.h"
+#include "core/Startup.h"
+#include "core/Trace.h"
 
 using namespace ilixi;
 
@@ -110,7 +112,12 @@ void
 ContainerBase::doLayout()
 {
   if (_layout)
-    _layout->tile();
+    {
+      ILIXI_TRACE_TYPE("tile", *_layout);
+      startupBegin(StartupLayout);
+      _layout->tile();
+      startupEnd(StartupLayout);
+    }
   if (parent())
     parent()->doLayout();
 }
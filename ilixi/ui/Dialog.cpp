@@ -131,7 +131,8 @@ Dialog::execute()
   setUIManager(_windowUIManager);
   paint(Rectangle(0, 0, w, h));
 
-  _window->GrabPointer(_window);
+  if (_window)
+    _window->GrabPointer(_window);
   showWindow(Fade);
 }
 
@@ -314,7 +315,8 @@ void
 Dialog::closeDialog()
 {
   hideWindow(Fade);
-  _window->UngrabPointer(_window);
+  if (_window)
+    _window->UngrabPointer(_window);
   invalidateSurface();
   releaseWindow();
 }
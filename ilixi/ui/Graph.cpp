@@ -24,6 +24,7 @@
 #include "ui/Graph.h"
 #include "graphics/Painter.h"
 #include <algorithm>
+#include <math.h>
 #include "types/FontMetrics.h"
 
 using namespace ilixi;
@@ -33,34 +34,39 @@ using namespace ilixi;
 //******************************************************
 GraphCurve::GraphCurve(std::string title, int size, Color penColor) :
   _title(title), _symbolStyle(NoSymbol), _lineStyle(Line), _size(size),
-      _values(new double[size]), _curvePen(penColor), _graph(NULL)
+      _values(new double[size]), _curvePen(penColor), _graph(NULL), _pending(0)
 {
   for (int i = 0; i < size; ++i)
     _values[i] = 0;
+  resetTracking();
 }
 
 GraphCurve::GraphCurve(std::string title, int size, const Pen& pen) :
   _title(title), _symbolStyle(NoSymbol), _lineStyle(Line), _size(size),
-      _values(new double[size]), _curvePen(pen), _graph(NULL)
+      _values(new double[size]), _curvePen(pen), _graph(NULL), _pending(0)
 {
   for (int i = 0; i < size; ++i)
     _values[i] = 0;
+  resetTracking();
 }
 
 GraphCurve::GraphCurve(std::string title, double* values, int size,
     const Pen& pen) :
   _title(title), _symbolStyle(NoSymbol), _lineStyle(Line), _size(size),
-      _values(new double[size]), _curvePen(pen), _graph(NULL)
+      _values(new double[size]), _curvePen(pen), _graph(NULL), _pending(0)
 {
   std::copy(values, values + size, _values);
+  resetTracking();
 }
 
 GraphCurve::GraphCurve(const GraphCurve& curve) :
   _title(curve._title), _symbolStyle(curve._symbolStyle),
       _lineStyle(curve._lineStyle), _size(curve._size),
-      _values(new double[curve._size]), _curvePen(curve._curvePen)
+      _values(new double[curve._size]), _curvePen(curve._curvePen),
+      _graph(NULL), _pending(0)
 {
   std::copy(curve._values, curve._values + curve._size, _values);
+  resetTracking();
 }
 
 GraphCurve::~GraphCurve()
@@ -107,6 +113,22 @@ GraphCurve::values() const
   return _values;
 }
 
+double
+GraphCurve::minimum() const
+{
+  if (_minQueue.empty())
+    return 0;
+  return _minQueue.front().second;
+}
+
+double
+GraphCurve::maximum() const
+{
+  if (_maxQueue.empty())
+    return 0;
+  return _maxQueue.front().second;
+}
+
 Pen*
 GraphCurve::pen()
 {
@@ -118,6 +140,8 @@ GraphCurve::push(double value)
 {
   memmove(_values, _values + 1, (_size - 1) * sizeof(double));
   _values[_size - 1] = value;
+  ++_pending;
+  track(value);
 }
 
 void
@@ -129,6 +153,7 @@ GraphCurve::resize(int size)
   delete[] _values;
   _values = temp;
   _size = size;
+  resetTracking();
 }
 
 void
@@ -155,12 +180,52 @@ GraphCurve::setPen(const Pen& pen)
   _curvePen = pen;
 }
 
+void
+GraphCurve::track(double value)
+{
+  unsigned long index = _pushCount++;
+
+  // Values which can no longer become an extremum are dropped from the back,
+  // so each value is pushed and popped at most once.
+  while (!_maxQueue.empty() && _maxQueue.back().second <= value)
+    _maxQueue.pop_back();
+  _maxQueue.push_back(std::make_pair(index, value));
+
+  while (!_minQueue.empty() && _minQueue.back().second >= value)
+    _minQueue.pop_back();
+  _minQueue.push_back(std::make_pair(index, value));
+
+  if (index >= (unsigned long) _size)
+    {
+      unsigned long oldest = index - _size + 1;
+      while (_maxQueue.front().first < oldest)
+        _maxQueue.pop_front();
+      while (_minQueue.front().first < oldest)
+        _minQueue.pop_front();
+    }
+}
+
+void
+GraphCurve::resetTracking()
+{
+  _minQueue.clear();
+  _maxQueue.clear();
+  _pushCount = 0;
+  for (int i = 0; i < _size; ++i)
+    track(_values[i]);
+}
+
 //******************************************************
 // GraphArea
 //******************************************************
 GraphArea::GraphArea(Widget* parent) :
-  Widget(parent)
+  Widget(parent), _yScale(1), _graph(NULL), _sampleStep(1),
+      _pendingSamples(0), _sampleCount(0), _scrollOffset(0), _front(0),
+      _plotValid(false), _labelSurface(NULL), _labelsValid(false)
 {
+  _plotSurface[0] = NULL;
+  _plotSurface[1] = NULL;
+
   _gridPen = new Pen();
   _gridPen->setColor(Color(1, 1, 1));
   _gridPen->setLineWidth(1);
@@ -168,10 +233,14 @@ GraphArea::GraphArea(Widget* parent) :
   dashes[0] = 1;
   dashes[1] = 1;
   _gridPen->setDash(dashes, 2, 0);
+
+  sigGeometryUpdated.connect(
+      sigc::mem_fun(this, &GraphArea::updatePlotGeometry));
 }
 
 GraphArea::~GraphArea()
 {
+  releasePlot();
   delete _gridPen;
 }
 
@@ -181,36 +250,80 @@ GraphArea::setGraph(Graph* graph)
   _graph = graph;
 }
 
+void
+GraphArea::scrollPlot(int samples)
+{
+  _pendingSamples += samples;
+}
+
+void
+GraphArea::invalidatePlot()
+{
+  _plotValid = false;
+}
+
+void
+GraphArea::invalidateLabels()
+{
+  _labelsValid = false;
+}
+
 void
 GraphArea::compose(const Rectangle& rect)
 {
-  Size yLabelSize = Size(40, 20);
-  Size xLabelSize = Size(40, 20);
-  char labelBuffer[20];
+  if (_graph->_renderMode == Graph::StreamingMode)
+    {
+      if (!_labelsValid)
+        renderLabels();
+
+      int dx = _pendingSamples * _sampleStep;
+      if (!_plotValid || dx >= _streamRect.width())
+        renderPlot();
+      else if (dx)
+        {
+          int sw = _streamRect.width();
+          int sh = _streamRect.height();
+          Surface* back = _plotSurface[1 - _front];
+
+          // shift current plot to the left and clear the strip uncovered.
+          back->lock();
+          back->blit(_plotSurface[_front], Rectangle(dx, 0, sw - dx, sh), 0, 0);
+          back->clear(Rectangle(sw - dx, 0, dx, sh));
+          back->unlock();
+          cairo_surface_mark_dirty(back->cairoSurface());
+
+          _sampleCount += _pendingSamples;
+          _scrollOffset += dx;
+
+          Painter p(back);
+          p.begin(Rectangle(sw - dx, 0, dx, sh));
+          drawPlotStrip(&p, sw - dx, _pendingSamples);
+          p.end();
+
+          _front = 1 - _front;
+          _pendingSamples = 0;
+        }
+
+      surface()->lock();
+      surface()->clip(rect);
+      surface()->blit(_labelSurface);
+      surface()->blit(_plotSurface[_front], _streamRect.x(), _streamRect.y());
+      surface()->resetClip();
+      surface()->unlock();
+      return;
+    }
 
   Painter p(this);
   p.begin(rect);
 
-  int x = yLabelSize.width() + 5;
-  int y = yLabelSize.height() / 2;
-  int w = width() - xLabelSize.width() / 2 - x;
-  int h = height() - xLabelSize.height() - y;
-  double x2 = width() - xLabelSize.width() / 2;
-  double y2 = height() - xLabelSize.height();
-
-  // positions for vertical grid lines
-  double vLines[_graph->_xMaxTicks];
-  vLines[0] = x;
+  int x = _plotRect.x();
+  int y = _plotRect.y();
+  int w = _plotRect.width();
+  int h = _plotRect.height();
+  double x2 = _plotRect.right();
+  double y2 = _plotRect.bottom();
   double xTickStep = w / (_graph->_xMaxTicks + .0);
-  for (int i = 1; i <= _graph->_xMaxTicks; ++i)
-    vLines[i] = vLines[i - 1] + xTickStep;
-
-  // positions for horizontal grid lines
-  double hLines[_graph->_yMaxTicks];
-  hLines[0] = y;
   double yTickStep = h / (_graph->_yMaxTicks + .0);
-  for (int i = 1; i <= _graph->_yMaxTicks; ++i)
-    hLines[i] = hLines[i - 1] + yTickStep;
 
   // draw background
   p.getBrush()->setColor(Color(1, 1, 1, 0.2));
@@ -220,120 +333,292 @@ GraphArea::compose(const Rectangle& rect)
   p.setPen(_gridPen);
   p.setAntiAliasMode(Painter::AliasNone);
 
-  for (int i = 0; i <= _graph->_xMaxTicks; ++i)
-    p.drawLine(vLines[i], y, vLines[i], y2, Painter::StrokePath);
+  _coords.clear();
+  for (unsigned int i = 0; i <= _graph->_xMaxTicks; ++i)
+    {
+      _coords.push_back(x + i * xTickStep);
+      _coords.push_back(y);
+      _coords.push_back(x + i * xTickStep);
+      _coords.push_back(y2);
+    }
+  for (unsigned int i = 0; i <= _graph->_yMaxTicks; ++i)
+    {
+      _coords.push_back(x);
+      _coords.push_back(y + i * yTickStep);
+      _coords.push_back(x2);
+      _coords.push_back(y + i * yTickStep);
+    }
+  p.drawLines(&_coords[0], _coords.size() / 4);
 
-  for (int i = 0; i <= _graph->_yMaxTicks; ++i)
-    p.drawLine(x, hLines[i], x2, hLines[i], Painter::StrokePath);
+  // draw tick labels
+  drawLabels(&p);
 
-  // draw labels x-axis tick labels
-  p.getBrush()->setColor(Color(1, 1, 1, 0.5));
+  // draw plot data
   p.setAntiAliasMode(Painter::AliasSubPixel);
-  p.setLayoutAlignment(PANGO_ALIGN_CENTER);
+  _yScale = h / (_graph->_yMax - _graph->_yMin + 0.0);
+  for (unsigned int curve = 0; curve < _graph->_curves.size(); ++curve)
+    {
+      GraphCurve* c = _graph->_curves[curve];
+      if (c->size() < 2)
+        continue;
+      drawCurve(&p, c, 0, c->size(), x, w / (c->size() - 1.0), y2, _yScale);
+    }
+  p.end();
+}
+
+void
+GraphArea::drawLabels(Painter* p)
+{
+  char labelBuffer[32];
+  int yLabelWidth = _plotRect.x() - 5;
+  double xTickStep = _plotRect.width() / (_graph->_xMaxTicks + .0);
+  double yTickStep = _plotRect.height() / (_graph->_yMaxTicks + .0);
+
+  // draw labels x-axis tick labels
+  p->getBrush()->setColor(Color(1, 1, 1, 0.5));
+  p->setAntiAliasMode(Painter::AliasSubPixel);
+  p->setLayoutAlignment(PANGO_ALIGN_CENTER);
   double xLabelOffset = xTickStep / 2.0;
   int step = _graph->_windowSize / _graph->_xMaxTicks;
-  for (int i = 0; i <= _graph->_xMaxTicks; i++)
+  for (unsigned int i = 0; i <= _graph->_xMaxTicks; i++)
     {
       sprintf(labelBuffer, "%d", _graph->_windowSize - (i * step));
-      p.drawText(labelBuffer, vLines[i] - xLabelOffset, y2 + 5, xTickStep, 1);
+      p->drawText(labelBuffer, _plotRect.x() + i * xTickStep - xLabelOffset,
+          _plotRect.bottom() + 5, xTickStep, 1);
     }
 
   // draw labels y-axis tick labels
-  int yStep = 100 / _graph->_yMaxTicks;
-  p.setLayoutAlignment(PANGO_ALIGN_RIGHT);
-  for (int i = 0; i <= _graph->_yMaxTicks; ++i)
+  double yStep = (_graph->_yMax - _graph->_yMin) / _graph->_yMaxTicks;
+  p->setLayoutAlignment(PANGO_ALIGN_RIGHT);
+  for (unsigned int i = 0; i <= _graph->_yMaxTicks; ++i)
     {
-      sprintf(labelBuffer, "%d %%", 100 - (i * yStep));
-      p.drawText(labelBuffer, 0, hLines[i] - 5, yLabelSize.width(), 1);
+      snprintf(labelBuffer, sizeof(labelBuffer), _graph->_yLabelFormat.c_str(),
+          _graph->_yMax - (i * yStep));
+      p->drawText(labelBuffer, 0, _plotRect.y() + i * yTickStep - 5,
+          yLabelWidth, 1);
     }
+}
 
-  // draw plot data
+void
+GraphArea::drawPlotStrip(Painter* p, int from, int samples)
+{
+  int pw = _streamRect.width() - 1;
+  int ph = _streamRect.height() - 1;
+  cairo_t* context = p->cairoContext();
 
-  _yScale = h / (_graph->_yMax - _graph->_yMin + 0.0);
-  double xOffset = 0;
-  double cXP = 0;
-  double cXC = 0;
-  double cYP = 0;
-  double cYC = 0;
-  cairo_t* context = p.cairoContext();
-  for (int curve = 0; curve < _graph->_curves.size(); ++curve)
+  // limit drawing to strip, old content must not be painted over.
+  cairo_rectangle(context, from, 0, pw + 1 - from, ph + 1);
+  cairo_clip(context);
+
+  // draw background
+  p->getBrush()->setColor(Color(1, 1, 1, 0.2));
+  p->drawRectangle(from, 0, pw + 1 - from, ph + 1, Painter::FillPath);
+
+  // draw grid, dashes and vertical lines move along with scrolled content.
+  p->setPen(_gridPen);
+  p->setAntiAliasMode(Painter::AliasNone);
+
+  int dashStart = from - (from + _scrollOffset) % 2;
+  double yTickStep = ph / (_graph->_yMaxTicks + .0);
+  _coords.clear();
+  for (unsigned int i = 0; i <= _graph->_yMaxTicks; ++i)
+    {
+      _coords.push_back(dashStart);
+      _coords.push_back(i * yTickStep);
+      _coords.push_back(pw + 1);
+      _coords.push_back(i * yTickStep);
+    }
+
+  unsigned int tickSamples = std::max(1,
+      _graph->_windowSize / (int) _graph->_xMaxTicks);
+  for (int age = 0; age < samples; ++age)
+    if ((unsigned int) age <= _sampleCount && (_sampleCount - age)
+        % tickSamples == 0)
+      {
+        _coords.push_back(pw - age * _sampleStep);
+        _coords.push_back(0);
+        _coords.push_back(pw - age * _sampleStep);
+        _coords.push_back(ph);
+      }
+  p->drawLines(&_coords[0], _coords.size() / 4);
+
+  // draw plot data, newest value is on the right edge.
+  p->setAntiAliasMode(Painter::AliasSubPixel);
+  double yScale = ph / (_graph->_yMax - _graph->_yMin + 0.0);
+  for (unsigned int curve = 0; curve < _graph->_curves.size(); ++curve)
+    {
+      GraphCurve* c = _graph->_curves[curve];
+      int last = c->size() - 1;
+      int oldest = std::min(samples, last);
+      if (oldest < 1)
+        continue;
+      drawCurve(p, c, last - oldest, oldest + 1, pw - oldest * _sampleStep,
+          _sampleStep, ph, yScale);
+    }
+  p->resetClip();
+}
+
+void
+GraphArea::drawCurve(Painter* p, GraphCurve* curve, int first, int count,
+    double x, double xStep, double base, double yScale)
+{
+  double* values = curve->values();
+  double yMin = _graph->_yMin;
+  GraphCurve::LineStyle style = curve->lineStyle();
+
+  p->setPen(curve->pen());
+  p->getBrush()->setColor(curve->pen()->getColor());
+
+  // collect whole curve first, so it is stroked or filled only once.
+  _coords.clear();
+  double xp = x;
+  double yp = base - (values[first] - yMin) * yScale;
+  if (style == GraphCurve::LineArea)
+    {
+      _coords.push_back(xp);
+      _coords.push_back(base);
+    }
+  if (style == GraphCurve::Line || style == GraphCurve::LineArea || style
+      == GraphCurve::Step)
+    {
+      _coords.push_back(xp);
+      _coords.push_back(yp);
+    }
+
+  for (int i = 1; i < count; ++i)
     {
-      p.setPen(_graph->_curves[curve]->pen());
-
-      xOffset = w / (_graph->_curves[curve]->size() + .0);
-      cXP = x;
-      cXC = cXP + xOffset;
-      cYP = y2 - (_graph->_curves[curve]->values()[0] * _yScale);
-      cYC = y2 - (_graph->_curves[curve]->values()[1] * _yScale);
-      if (_graph->_curves[curve]->lineStyle() == GraphCurve::Line)
-        p .drawLine(cXP, cYP, cXC, cYC);
-      else if (_graph->_curves[curve]->lineStyle() == GraphCurve::Step)
+      double xc = x + i * xStep;
+      double yc = base - (values[first + i] - yMin) * yScale;
+
+      if (style == GraphCurve::Line || style == GraphCurve::LineArea)
         {
-          p .drawLine(cXP, cYP, cXP, cYC);
-          p .drawLine(cXP, cYC, cXC, cYC);
+          _coords.push_back(xc);
+          _coords.push_back(yc);
         }
-      else if (_graph->_curves[curve]->lineStyle() == GraphCurve::Bar)
+      else if (style == GraphCurve::Step)
         {
-          p.setAntiAliasMode(Painter::AliasNone);
-          p.getBrush()->setColor(_graph->_curves[curve]->pen()->getColor());
-          p.drawRectangle(cXP, cYC, xOffset, y2 - cYC, Painter::FillPath);
+          _coords.push_back(xp);
+          _coords.push_back(yc);
+          _coords.push_back(xc);
+          _coords.push_back(yc);
         }
-      else if (_graph->_curves[curve]->lineStyle() == GraphCurve::LineArea)
+      else if (style == GraphCurve::Bar)
         {
-          cairo_line_to(context, cXP, cYP);
+          _coords.push_back(xp);
+          _coords.push_back(yc);
+          _coords.push_back(xStep);
+          _coords.push_back(base - yc);
         }
-
-      cXP = cXC;
-      cYP = cYC;
-      for (int point = 1; point < _graph->_curves[curve]->size(); ++point)
-        {
-          cXC = cXP + xOffset;
-          cYC = y2 - (_graph->_curves[curve]->values()[point] * _yScale);
-
-          if (_graph->_curves[curve]->lineStyle() == GraphCurve::Line)
-            p.drawLine(cXP, cYP, cXC, cYC);
-
-          else if (_graph->_curves[curve]->lineStyle() == GraphCurve::Step)
-            {
-              p.drawLine(cXP, cYP, cXP, cYC);
-              p.drawLine(cXP, cYC, cXC, cYC);
-            }
-
-          else if (_graph->_curves[curve]->lineStyle() == GraphCurve::Bar)
-            p.drawRectangle(cXP, cYC, xOffset, y2 - cYC, Painter::FillPath);
-
-          else if (_graph->_curves[curve]->lineStyle() == GraphCurve::Stick)
-            {
-              //              p.getPen()->setLineWidth(
-              //                  _graph->_curves[curve]->pen()->getLineWidth());
-              p.drawLine(cXC, cYP, cXC, cYC);
-              //              p.getPen()->setLineWidth(1);
-              p.drawEllipse(cXC - 2.5, cYC - 2.5, 5, 5, Painter::StrokeAndFill);
-            }
-
-          else if (_graph->_curves[curve]->lineStyle() == GraphCurve::LineArea)
-            {
-              cairo_line_to(context, cXC, cYC);
-            }
-
-          cXP = cXC;
-          cYP = cYC;
-        } // end for points
-
-      if (_graph->_curves[curve]->lineStyle() == GraphCurve::LineArea)
+      else if (style == GraphCurve::Stick)
         {
-
-          cairo_line_to(context, cXP, cYP);
-          cairo_line_to(context, cXP, y2);
-          cairo_line_to(context, x, y2);
-          cairo_line_to(context, x,
-              y2 - (_graph->_curves[curve]->values()[0] * _yScale));
-          //          cairo_close_path(context);
-          cairo_fill(context);
+          _coords.push_back(xc);
+          _coords.push_back(yp);
+          _coords.push_back(xc);
+          _coords.push_back(yc);
         }
 
-    } // end for curve
+      xp = xc;
+      yp = yc;
+    }
+
+  if (style == GraphCurve::Line || style == GraphCurve::Step)
+    p->drawPolyline(&_coords[0], _coords.size() / 2);
+  else if (style == GraphCurve::LineArea)
+    {
+      _coords.push_back(xp);
+      _coords.push_back(base);
+      p->drawPolyline(&_coords[0], _coords.size() / 2, Painter::FillPath);
+    }
+  else if (style == GraphCurve::Bar)
+    p->drawRects(&_coords[0], _coords.size() / 4, Painter::FillPath);
+  else if (style == GraphCurve::Stick)
+    {
+      p->drawLines(&_coords[0], _coords.size() / 4);
+      for (unsigned int i = 2; i < _coords.size(); i += 4)
+        p->drawEllipse(_coords[i] - 2.5, _coords[i + 1] - 2.5, 5, 5,
+            Painter::AddPath);
+      p->drawCurrentPath(Painter::StrokeAndFill);
+    }
+}
+
+void
+GraphArea::renderLabels()
+{
+  if (!_labelSurface)
+    {
+      _labelSurface = new Surface();
+      _labelSurface->createDFBSurface(width(), height(), false);
+    }
+  _labelSurface->clear();
+
+  Painter p(_labelSurface);
+  p.begin(Rectangle(0, 0, width(), height()));
+  drawLabels(&p);
+  p.end();
+  _labelsValid = true;
+}
+
+void
+GraphArea::renderPlot()
+{
+  if (!_plotSurface[0])
+    for (int i = 0; i < 2; ++i)
+      {
+        _plotSurface[i] = new Surface();
+        _plotSurface[i]->createDFBSurface(_streamRect.width(),
+            _streamRect.height(), false);
+        _plotSurface[i]->DFBSurface()->SetBlittingFlags(
+            _plotSurface[i]->DFBSurface(), DSBLIT_NOFX);
+      }
+
+  _sampleCount += _pendingSamples;
+  _scrollOffset += _pendingSamples * _sampleStep;
+  _pendingSamples = 0;
+
+  Surface* target = _plotSurface[_front];
+  target->clear();
+
+  Painter p(target);
+  p.begin(Rectangle(0, 0, _streamRect.width(), _streamRect.height()));
+  drawPlotStrip(&p, 0, _graph->_windowSize);
   p.end();
+  _plotValid = true;
+}
+
+void
+GraphArea::releasePlot()
+{
+  for (int i = 0; i < 2; ++i)
+    {
+      delete _plotSurface[i];
+      _plotSurface[i] = NULL;
+    }
+  delete _labelSurface;
+  _labelSurface = NULL;
+  _plotValid = false;
+  _labelsValid = false;
+}
+
+void
+GraphArea::updatePlotGeometry()
+{
+  Size yLabelSize = Size(40, 20);
+  Size xLabelSize = Size(40, 20);
+
+  int x = yLabelSize.width() + 5;
+  int y = yLabelSize.height() / 2;
+  _plotRect = Rectangle(x, y, width() - xLabelSize.width() / 2 - x,
+      height() - xLabelSize.height() - y);
+
+  // Streaming plot is snapped to a whole number of pixels per sample
+  // so that scrolling is an exact blit.
+  int samples = _graph->_windowSize > 1 ? _graph->_windowSize - 1 : 1;
+  _sampleStep = std::max(1, _plotRect.width() / samples);
+  int pw = std::min(samples * _sampleStep, _plotRect.width());
+  _streamRect = Rectangle(_plotRect.right() - pw, y, pw + 1,
+      _plotRect.height() + 1);
+
+  releasePlot();
 }
 
 //******************************************************
@@ -399,7 +684,8 @@ GraphLegend::compose(const Rectangle& rect)
 // Graph
 //******************************************************
 Graph::Graph(std::string title, int windowSize, Widget* parent) :
-  Widget(parent), _autoScale(false), _showLegend(false), _xMaxTicks(5),
+  Widget(parent), _autoScale(false), _showLegend(false),
+      _renderMode(ReplotMode), _xMaxTicks(5),
       _yMaxTicks(5), _windowSize(windowSize)
 {
   setConstraints(MinimumConstraint, MinimumExpandingConstraint);
@@ -432,6 +718,8 @@ Graph::Graph(std::string title, int windowSize, Widget* parent) :
 
   _yMin = 0;
   _yMax = 100;
+  _scaleMargin = 0.1;
+  _yLabelFormat = "%.0f %%";
 }
 
 //Graph::Graph(const Graph& graph)
@@ -462,6 +750,7 @@ void
 Graph::addCurve(GraphCurve* curve)
 {
   _curves.push_back(curve);
+  _graphArea->invalidatePlot();
 }
 
 void
@@ -476,6 +765,7 @@ Graph::clear()
   for (int i = 0; i < _curves.size(); ++i)
     delete _curves[i];
   _curves.clear();
+  _graphArea->invalidatePlot();
 }
 
 void
@@ -483,6 +773,17 @@ Graph::replot()
 {
   if (_autoScale)
     scale();
+
+  // Number of samples to scroll is given by the most recently updated curve.
+  int samples = 0;
+  for (unsigned int i = 0; i < _curves.size(); ++i)
+    {
+      samples = std::max(samples, _curves[i]->_pending);
+      _curves[i]->_pending = 0;
+    }
+
+  if (_renderMode == StreamingMode)
+    _graphArea->scrollPlot(samples);
   _graphArea->update();
 }
 
@@ -506,6 +807,18 @@ Graph::legendShown() const
   return _showLegend;
 }
 
+Graph::RenderMode
+Graph::renderMode() const
+{
+  return _renderMode;
+}
+
+double
+Graph::scaleMargin() const
+{
+  return _scaleMargin;
+}
+
 std::string
 Graph::title() const
 {
@@ -516,6 +829,8 @@ void
 Graph::setAutoScale(bool autoScale)
 {
   _autoScale = autoScale;
+  if (_autoScale)
+    scale();
 }
 
 void
@@ -532,18 +847,42 @@ Graph::setLegendShown(bool shown)
   _showLegend = shown;
 }
 
+void
+Graph::setRenderMode(RenderMode mode)
+{
+  if (_renderMode != mode)
+    {
+      _renderMode = mode;
+      _graphArea->invalidatePlot();
+      _graphArea->update();
+    }
+}
+
 void
 Graph::setTitle(std::string title)
 {
   _title->setText(title);
 }
 
+void
+Graph::setScaleMargin(double margin)
+{
+  _scaleMargin = margin;
+}
+
 void
 Graph::setXLabels(const std::vector<std::string>& xLabels)
 {
   _xLabels = xLabels;
 }
 
+void
+Graph::setYLabelFormat(const std::string& format)
+{
+  _yLabelFormat = format;
+  _graphArea->invalidateLabels();
+}
+
 void
 Graph::compose(const Rectangle& rect)
 {
@@ -555,25 +894,34 @@ Graph::compose(const Rectangle& rect)
 void
 Graph::scale()
 {
-  //  _yMin = INT_MAX;
-  //  _yMax = 0;
-  //  int curveSize = 0;
-  //  for (int i = 0; i < _curves.size(); ++i)
-  //    {
-  //
-  //      if (windowSize < _size)
-  //        windowSize = _size - windowSize;
-  //      else
-  //        windowSize = _size;
-  //
-  //      for (int i = curveSize; i > 0; --i)
-  //        {
-  //          if (_values[i] < min)
-  //            min = _values[i];
-  //          if (_values[i] > max)
-  //            max = _values[i];
-  //        }
-  //    }
+  if (_curves.empty())
+    return;
+
+  // Extrema of each curve are tracked while values are pushed, O(curves) here.
+  double dataMin = _curves[0]->minimum();
+  double dataMax = _curves[0]->maximum();
+  for (unsigned int i = 1; i < _curves.size(); ++i)
+    {
+      dataMin = std::min(dataMin, _curves[i]->minimum());
+      dataMax = std::max(dataMax, _curves[i]->maximum());
+    }
+
+  double span = dataMax - dataMin;
+  if (span <= 0)
+    span = dataMax ? fabs(dataMax) : 1;
+  double margin = span * _scaleMargin;
+
+  // Keep current range while values stay inside it and do not leave too much
+  // space unused, so that jitter does not cause full replots.
+  if (dataMin < _yMin || dataMax > _yMax || dataMin - _yMin > 3 * margin
+      || _yMax - dataMax > 3 * margin)
+    {
+      _yMin = dataMin - margin;
+      _yMax = dataMax + margin;
+      _graphArea->invalidatePlot();
+      _graphArea->invalidateLabels();
+      sigScaleChanged(_yMin, _yMax);
+    }
 }
 
 void
@@ -28,6 +28,7 @@
 #include "ui/Label.h"
 #include "types/Pen.h"
 #include <vector>
+#include <deque>
 
 namespace ilixi
 {
@@ -36,6 +37,7 @@ namespace ilixi
 
   class GraphCurve
   {
+    friend class Graph;
   public:
 
     enum SymbolStyle
@@ -77,6 +79,18 @@ namespace ilixi
     double*
     values() const;
 
+    /*!
+     * Returns the minimum value inside curve's window.
+     */
+    double
+    minimum() const;
+
+    /*!
+     * Returns the maximum value inside curve's window.
+     */
+    double
+    maximum() const;
+
     Pen*
     pen();
 
@@ -106,6 +120,24 @@ namespace ilixi
     double* _values;
     Pen _curvePen;
     Graph* _graph;
+    //! Number of values pushed since last replot.
+    int _pending;
+
+    typedef std::deque<std::pair<unsigned long, double> > ExtremaQueue;
+    //! Monotonic queue of (push index, value) pairs, front is window minimum.
+    ExtremaQueue _minQueue;
+    //! Monotonic queue of (push index, value) pairs, front is window maximum.
+    ExtremaQueue _maxQueue;
+    //! Number of values tracked so far.
+    unsigned long _pushCount;
+
+    //! Adds value to min./max. queues and drops values which left the window.
+    void
+    track(double value);
+
+    //! Rebuilds min./max. queues from current values.
+    void
+    resetTracking();
   };
 
   class GraphArea : public Widget
@@ -119,6 +151,24 @@ namespace ilixi
     void
     setGraph(Graph* graph);
 
+    /*!
+     * Scrolls plot area by given number of samples. Only used in streaming mode.
+     */
+    void
+    scrollPlot(int samples);
+
+    /*!
+     * Forces a full redraw of backing surfaces upon next paint.
+     */
+    void
+    invalidatePlot();
+
+    /*!
+     * Forces tick labels to be rasterised again upon next paint.
+     */
+    void
+    invalidateLabels();
+
   protected:
     virtual void
     compose(const Rectangle& rect);
@@ -126,6 +176,54 @@ namespace ilixi
     double _yScale;
     Pen* _gridPen;
     Graph* _graph;
+
+  private:
+    //! Plot area inside widget, excluding tick labels.
+    Rectangle _plotRect;
+    //! Plot area inside widget in streaming mode, snapped to sample steps.
+    Rectangle _streamRect;
+    //! Width of a sample in pixels in streaming mode.
+    int _sampleStep;
+    //! Number of samples waiting to be scrolled into backing surface.
+    int _pendingSamples;
+    //! Total number of samples scrolled, used for aligning vertical grid lines.
+    unsigned int _sampleCount;
+    //! Total number of pixels scrolled, used for aligning grid dashes.
+    unsigned int _scrollOffset;
+    //! Backing surfaces for plot area, used alternately in streaming mode.
+    Surface* _plotSurface[2];
+    //! Index of backing surface which holds the current plot.
+    int _front;
+    //! If false, backing surfaces are redrawn completely.
+    bool _plotValid;
+    //! Pre-rasterised tick labels.
+    Surface* _labelSurface;
+    //! If false, tick labels are rasterised again.
+    bool _labelsValid;
+    //! Coordinate buffer for batched drawing, reused between frames.
+    std::vector<double> _coords;
+
+    void
+    drawLabels(Painter* painter);
+
+    void
+    drawPlotStrip(Painter* painter, int from, int samples);
+
+    void
+    drawCurve(Painter* painter, GraphCurve* curve, int first, int count,
+        double x, double xStep, double base, double yScale);
+
+    void
+    renderLabels();
+
+    void
+    renderPlot();
+
+    void
+    releasePlot();
+
+    void
+    updatePlotGeometry();
   };
 
   class GraphLegend : public Widget
@@ -160,6 +258,16 @@ namespace ilixi
       yAxis, xAxis
     };
 
+    /*!
+     * This enum specifies how the graph area is redrawn upon replot().
+     */
+    enum RenderMode
+    {
+      ReplotMode, //!< Background, grid, labels and curves are redrawn completely.
+      StreamingMode
+    //!< Plot area is scrolled inside a backing surface and only new segments are drawn.
+    };
+
     Graph(std::string title, int windowSize, Widget* parent = 0);
 
     //    Graph(const Graph& graph);
@@ -194,6 +302,12 @@ namespace ilixi
     bool
     legendShown() const;
 
+    RenderMode
+    renderMode() const;
+
+    double
+    scaleMargin() const;
+
     std::string
     title() const;
 
@@ -206,12 +320,42 @@ namespace ilixi
     void
     setLegendShown(bool shown);
 
+    /*!
+     * Sets render mode of graph. StreamingMode should be used if values are
+     * appended to curves continuously and replot() is called after each sample.
+     */
+    void
+    setRenderMode(RenderMode mode);
+
+    /*!
+     * Sets the margin which is added above and below values when graph is auto scaled.
+     * Margin is given as a fraction of the value range and it also acts as a hysteresis,
+     * i.e. scale is not modified as long as values stay inside the current range and
+     * do not leave more than three margins unused.
+     *
+     * @param margin Default is 0.1.
+     */
+    void
+    setScaleMargin(double margin);
+
     void
     setTitle(std::string title);
 
     void
     setXLabels(const std::vector<std::string>& xLabels);
 
+    /*!
+     * Sets printf style format of tick labels on y-axis, e.g. "%.1f". Default is "%.0f %%".
+     */
+    void
+    setYLabelFormat(const std::string& format);
+
+    /*!
+     * This signal is emitted if y-axis range is modified by auto scaling.
+     * Parameters are the new minimum and maximum respectively.
+     */
+    sigc::signal<void, double, double> sigScaleChanged;
+
   protected:
     virtual void
     compose(const Rectangle& rect);
@@ -221,6 +365,8 @@ namespace ilixi
     bool _autoScale;
     //! If true a legend is shown beside graph.
     bool _showLegend;
+    //! Specifies how graph area is redrawn.
+    RenderMode _renderMode;
     //! Number of maximum ticks on x-axis.
     unsigned int _xMaxTicks;
     //! Number of maximum ticks on y-axis.
@@ -231,6 +377,8 @@ namespace ilixi
     double _yMin;
     //! Maximum value on y-axis.
     double _yMax;
+    //! Fraction of value range added to y-axis range while auto scaling.
+    double _scaleMargin;
 
     //! Title of graph.
     Label* _title;
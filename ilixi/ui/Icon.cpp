@@ -55,6 +55,14 @@ Icon::preferredSize() const
   return Size(48, 48);
 }
 
+void
+Icon::memoryUsage(MemoryUsage& usage) const
+{
+  Widget::memoryUsage(usage);
+  if (_ownImage && _image)
+    usage.images += _image->memoryUsage();
+}
+
 bool
 Icon::border() const
 {
@@ -43,6 +43,12 @@ namespace ilixi
     virtual Size
     preferredSize() const;
 
+    /*!
+     * Adds image to usage if icon owns it.
+     */
+    virtual void
+    memoryUsage(MemoryUsage& usage) const;
+
     bool
     border() const;
 
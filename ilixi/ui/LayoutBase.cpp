@@ -27,6 +27,7 @@
 #include <algorithm>
 
 #include "core/Logger.h"
+#include "core/Trace.h"
 using namespace ilixi;
 
 LayoutBase::LayoutBase(Widget* parent) :
@@ -103,12 +104,16 @@ LayoutBase::setVisible(bool visible)
   if (visible && _state & InvisibleState)
     {
       _state = (WidgetState) (_state & ~InvisibleState);
+      if (uiManager())
+        uiManager()->updateFocusChain(this);
       if (parent())
         parent()->doLayout();
     }
   else if (!visible && !(_state & InvisibleState))
     {
       _state = (WidgetState) (_state | InvisibleState);
+      if (uiManager())
+        uiManager()->updateFocusChain(this);
       if (parent())
         parent()->doLayout();
     }
@@ -171,7 +176,10 @@ LayoutBase::paint(const Rectangle& rect)
       if (intersect.isValid())
         {
           if (_layoutModified)
-            tile();
+            {
+              ILIXI_TRACE_TYPE("tile", *this);
+              tile();
+            }
           paintChildren(intersect);
         }
     }
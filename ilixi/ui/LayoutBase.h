@@ -125,7 +125,8 @@ namespace ilixi
       Size size;
     };
 
-    typedef std::list<ActiveWidget> ActiveWidgetList;
+    typedef std::list<ActiveWidget, ArenaAllocator<ActiveWidget> >
+        ActiveWidgetList;
     typedef ActiveWidgetList::iterator ActiveWidgetListIterator;
 
     //! This list is updated every time the layout is tiling.
@@ -67,6 +67,7 @@ LineEdit::clear()
 {
   _text = "";
   pango_layout_set_text(_layout, _text.c_str(), _text.length());
+  _layoutDirty = false;
   update();
 }
 
@@ -83,11 +84,26 @@ LineEdit::setText(const std::string &text)
     {
       _text = text;
       pango_layout_set_text(_layout, _text.c_str(), _text.length());
+      _layoutDirty = false;
       sigTextChanged(_text);
       update();
     }
 }
 
+void
+LineEdit::insertText(unsigned int index, const std::string& text)
+{
+  TextLayout::insertText(index, text);
+  sigTextChanged(_text);
+}
+
+void
+LineEdit::eraseText(unsigned int index, unsigned int length)
+{
+  TextLayout::eraseText(index, length);
+  sigTextChanged(_text);
+}
+
 void
 LineEdit::pointerButtonDownEvent(const PointerEvent& mouseEvent)
 {
@@ -56,6 +56,12 @@ namespace ilixi
     virtual void
     setText(const std::string &text);
 
+    virtual void
+    insertText(unsigned int index, const std::string& text);
+
+    virtual void
+    eraseText(unsigned int index, unsigned int length);
+
     sigc::signal<void, std::string> sigTextChanged;
 
   protected:
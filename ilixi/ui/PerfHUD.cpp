@@ -0,0 +1,194 @@
+/*
+ Copyright 2010, 2011 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ui/PerfHUD.h"
+#include "core/PerfStats.h"
+#include "core/Trace.h"
+#include "graphics/SurfacePool.h"
+#include "graphics/Painter.h"
+#include <cxxabi.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace ilixi;
+
+namespace
+{
+  const int HUDWidth = 280;
+  const int HUDHeight = 230;
+  //! Number of widgets listed.
+  const unsigned int HUDTopCount = 6;
+  //! Minimum time between repaints in nanoseconds.
+  const long long HUDRefreshInterval = 500000000LL;
+}
+
+PerfHUD::PerfHUD() :
+  WindowWidget(), _hudVisible(false), _lastRefresh(0)
+{
+  setMargin(0);
+  setBorderStyle(NoBorder);
+}
+
+PerfHUD::~PerfHUD()
+{
+  if (_hudVisible)
+    perfStatsEnable(false);
+}
+
+void
+PerfHUD::showHUD(int top)
+{
+  if (_hudVisible)
+    return;
+
+  setSize(HUDWidth, HUDHeight);
+  initDFBWindow(_layerConfig.width - HUDWidth - 10,
+      top + 10, HUDWidth, HUDHeight, true);
+  if (_window)
+    {
+      _window->SetOptions(_window,
+          (DFBWindowOptions) (DWOP_ALPHACHANNEL | DWOP_GHOST));
+      _window->RaiseToTop(_window);
+      _window->SetOpacity(_window, 255);
+    }
+
+  perfStatsEnable(true);
+  _hudVisible = true;
+  _lastRefresh = 0;
+  refresh();
+}
+
+void
+PerfHUD::hideHUD()
+{
+  if (!_hudVisible)
+    return;
+  if (_window)
+    _window->SetOpacity(_window, 0);
+  perfStatsEnable(false);
+  perfFlashEnabled = false;
+  _hudVisible = false;
+}
+
+bool
+PerfHUD::hudVisible() const
+{
+  return _hudVisible;
+}
+
+void
+PerfHUD::refresh()
+{
+  if (!_hudVisible)
+    return;
+  long long now = traceNow();
+  if (now - _lastRefresh < HUDRefreshInterval)
+    return;
+  _lastRefresh = now;
+  update(Rectangle(0, 0, HUDWidth, HUDHeight));
+}
+
+void
+PerfHUD::setMemoryUsage(const MemoryUsage& usage)
+{
+  _memory = usage;
+}
+
+void
+PerfHUD::paint(const Rectangle& rect)
+{
+  // Painting HUD must not show up in its own statistics.
+  perfStatsPaused = true;
+  WindowWidget::paint(rect);
+  perfStatsPaused = false;
+}
+
+void
+PerfHUD::compose(const Rectangle& rect)
+{
+  Painter p(this);
+  p.begin(rect);
+  p.setOperator(CAIRO_OPERATOR_SOURCE);
+  p.getBrush()->setColor(Color(0, 0, 0, 0.75));
+  p.drawRectangle(0, 0, width(), height(), Painter::FillPath);
+  p.setOperator(CAIRO_OPERATOR_OVER);
+
+  char text[128];
+  unsigned int buckets[PerfHistogramBuckets];
+  unsigned int frames = perfHistogram(buckets);
+  SurfacePoolStats pool = surfacePoolStats();
+  unsigned int requests = pool.hits + pool.misses;
+  snprintf(text, sizeof(text), "%.0f FPS    %u frames    pool %u%%%s",
+      perfFPS(), frames, requests ? 100 * pool.hits / requests : 0,
+      perfFlashEnabled ? "    flashing" : "");
+  p.getBrush()->setColor(Color(1, 1, 1));
+  p.drawText(text, 8, 4, width() - 16, 16, AlignVTop, false);
+
+  // Frame time histogram
+  unsigned int maxCount = 1;
+  for (unsigned int i = 0; i < PerfHistogramBuckets; ++i)
+    if (buckets[i] > maxCount)
+      maxCount = buckets[i];
+  int barWidth = (width() - 16) / PerfHistogramBuckets;
+  for (unsigned int i = 0; i < PerfHistogramBuckets; ++i)
+    {
+      int barHeight = 50 * buckets[i] / maxCount;
+      if (i < 3)
+        p.getBrush()->setColor(Color(0.3, 0.9, 0.3));
+      else if (i < 5)
+        p.getBrush()->setColor(Color(0.9, 0.8, 0.2));
+      else
+        p.getBrush()->setColor(Color(0.9, 0.3, 0.3));
+      p.drawRectangle(8 + i * barWidth, 74 - barHeight, barWidth - 2,
+          barHeight, Painter::FillPath);
+      if (i < PerfHistogramBuckets - 1)
+        snprintf(text, sizeof(text), "<%u", PerfHistogramBounds[i]);
+      else
+        snprintf(text, sizeof(text), "more");
+      p.getBrush()->setColor(Color(0.8, 0.8, 0.8));
+      p.drawText(text, 8 + i * barWidth, 76, barWidth, 14, AlignVTop, false);
+    }
+
+  // Memory usage in KB
+  snprintf(text, sizeof(text), "%u KB  px %u  cr %u  pg %u  img %u  fnt %u",
+      _memory.total() / 1024, _memory.pixels / 1024, _memory.cairo / 1024,
+      _memory.pango / 1024, _memory.images / 1024, _memory.fonts / 1024);
+  p.getBrush()->setColor(Color(1, 1, 1));
+  p.drawText(text, 8, 94, width() - 16, 16, AlignVTop, false);
+
+  // Most expensive widgets
+  PerfWidgetCost top[HUDTopCount];
+  unsigned int count = perfTopWidgets(top, HUDTopCount);
+  p.drawText("compose() ms / calls", 8, 112, width() - 16, 16, AlignVTop,
+      false);
+  for (unsigned int i = 0; i < count; ++i)
+    {
+      int status;
+      char* name = abi::__cxa_demangle(top[i].type, NULL, NULL, &status);
+      snprintf(text, sizeof(text), "%8.2f %6u  %s", top[i].time / 1000000.0,
+          top[i].calls, name ? name : top[i].type);
+      free(name);
+      p.drawText(text, 8, 130 + i * 16, width() - 16, 16, AlignVTop, false);
+    }
+  p.end();
+}
@@ -0,0 +1,102 @@
+/*
+ Copyright 2010, 2011 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ILIXI_PERFHUD_H_
+#define ILIXI_PERFHUD_H_
+
+#include "ui/WindowWidget.h"
+
+namespace ilixi
+{
+  //! Overlay window showing performance statistics.
+  /*!
+   * Shows frame rate, a histogram of frame times, memory usage of
+   * application and widgets with the highest cumulative compose() time.
+   * Timings are only collected while HUD is visible, see PerfStats.h. HUD
+   * window does not receive input.
+   */
+  class PerfHUD : public WindowWidget
+  {
+  public:
+    /*!
+     * Constructor.
+     */
+    PerfHUD();
+
+    /*!
+     * Destructor.
+     */
+    virtual
+    ~PerfHUD();
+
+    /*!
+     * Creates HUD window if necessary, starts collecting timings and makes
+     * HUD visible. HUD is placed at top right corner of layer.
+     *
+     * @param top y coordinate of HUD window, e.g. below status bar.
+     */
+    void
+    showHUD(int top = 0);
+
+    /*!
+     * Hides HUD and stops collecting timings.
+     */
+    void
+    hideHUD();
+
+    /*!
+     * Returns true if HUD is visible.
+     */
+    bool
+    hudVisible() const;
+
+    /*!
+     * Repaints HUD if its contents are older than refresh interval. This
+     * method is executed inside main event loop.
+     */
+    void
+    refresh();
+
+    /*!
+     * Sets memory usage shown on next repaint.
+     */
+    void
+    setMemoryUsage(const MemoryUsage& usage);
+
+    virtual void
+    paint(const Rectangle& rect);
+
+  private:
+    //! This flag is set while HUD is visible.
+    bool _hudVisible;
+    //! Time of last repaint in nanoseconds.
+    long long _lastRefresh;
+    //! Memory usage of application.
+    MemoryUsage _memory;
+
+    virtual void
+    compose(const Rectangle& rect);
+  };
+}
+
+#endif /* ILIXI_PERFHUD_H_ */
@@ -125,7 +125,6 @@ ScrollArea::paint(const Rectangle& rect)
               if (_layout->surface())
                 _layout->surface()->clear(intersect);
               _layout->paint(intersect);
-              _layout->flip(_layout->mapToSurface(intersect));
               _layout->blit(
                   this,
                   Rectangle(-_widgetOffsetX, -_widgetOffsetY, canvasWidth(),
@@ -130,7 +130,7 @@ namespace ilixi
     compose(const Rectangle& rect);
 
     /*!
-     * Blits layout's surface onto scroll area's surface and flips to make changes visible.
+     * Moves layout to current scroll offset and schedules repaint of canvas.
      */
     void
     blitLayout();
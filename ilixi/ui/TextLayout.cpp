@@ -27,7 +27,8 @@
 using namespace ilixi;
 
 TextLayout::TextLayout(std::string text, Widget* parent) :
-  Widget(parent), _font(NULL), _context(NULL), _layout(NULL), _text(text)
+  Widget(parent), _font(NULL), _context(NULL), _layout(NULL),
+      _layoutDirty(false), _text(text)
 {
   PangoFontMap* fontmap = pango_cairo_font_map_get_default();
   if (fontmap)
@@ -53,6 +54,18 @@ TextLayout::~TextLayout()
   g_object_unref(_context);
 }
 
+void
+TextLayout::memoryUsage(MemoryUsage& usage) const
+{
+  Widget::memoryUsage(usage);
+  if (_context)
+    usage.pango += MemoryPangoContext;
+  if (_layout)
+    usage.pango += MemoryPangoLayout + _text.length();
+  if (_font)
+    usage.fonts += _font->memoryUsage();
+}
+
 PangoEllipsizeMode
 TextLayout::ellipsizeMode() const
 {
@@ -158,6 +171,11 @@ TextLayout::textHeightForWidth(int width) const
 PangoLayout*
 TextLayout::layout() const
 {
+  if (_layoutDirty)
+    {
+      pango_layout_set_text(_layout, _text.c_str(), _text.length());
+      _layoutDirty = false;
+    }
   return _layout;
 }
 
@@ -178,6 +196,27 @@ TextLayout::append(std::string text)
 {
   _text += text;
   pango_layout_set_text(_layout, _text.c_str(), _text.length());
+  _layoutDirty = false;
+  update();
+}
+
+void
+TextLayout::insertText(unsigned int index, const std::string& text)
+{
+  if (index > _text.length())
+    index = _text.length();
+  _text.insert(index, text);
+  _layoutDirty = true;
+  update();
+}
+
+void
+TextLayout::eraseText(unsigned int index, unsigned int length)
+{
+  if (index >= _text.length())
+    return;
+  _text.erase(index, length);
+  _layoutDirty = true;
   update();
 }
 
@@ -251,6 +290,7 @@ TextLayout::setText(const std::string &text)
 {
   _text = text;
   pango_layout_set_text(_layout, _text.c_str(), _text.length());
+  _layoutDirty = false;
   update();
 }
 
@@ -259,6 +299,7 @@ TextLayout::setMarkup(const std::string &markup)
 {
   pango_layout_set_markup(_layout, markup.c_str(), markup.length());
   _text = pango_layout_get_text(_layout);
+  _layoutDirty = false;
   update();
 }
 
@@ -56,6 +56,12 @@ namespace ilixi
     virtual
     ~TextLayout();
 
+    /*!
+     * Adds pango context, pango layout and font of widget to usage.
+     */
+    virtual void
+    memoryUsage(MemoryUsage& usage) const;
+
     /*!
      * Returns ellipsization mode for text inside widget's text layout.
      */
@@ -173,6 +179,25 @@ namespace ilixi
     void
     append(std::string text);
 
+    /*!
+     * Inserts text at given byte index. Pango layout is updated once, on the
+     * next call to layout(), for all edits made until then.
+     *
+     * @param index byte offset in text, clamped to text length.
+     * @param text
+     */
+    virtual void
+    insertText(unsigned int index, const std::string& text);
+
+    /*!
+     * Erases length bytes of text starting at given byte index.
+     *
+     * @param index byte offset in text.
+     * @param length number of bytes.
+     */
+    virtual void
+    eraseText(unsigned int index, unsigned int length);
+
     /*!
      * Sets text ellipsization mode of text inside widget's text layout.
      *
@@ -304,6 +329,8 @@ namespace ilixi
     PangoContext* _context;
     //! Pointer to pango layout.
     PangoLayout* _layout;
+    //! True if _text was edited since it was last set on _layout.
+    mutable bool _layoutDirty;
     //! This property holds text to display inside widget's text layout.
     std::string _text;
     //! This property stores the position of pango layout and it is used for drawing text.
@@ -34,7 +34,8 @@
 using namespace ilixi;
 
 VideoPlayer::VideoPlayer(Widget* parent) :
-  BorderBase(parent), _videoSurface(NULL), _video(NULL)
+  BorderBase(parent), _presentationMode(DirectPresentation),
+      _shownSeconds(-1), _videoSurface(NULL), _video(NULL)
 {
   setBorderStyle(StyledBorder);
   setInputMethod(PointerInputOnly);
@@ -113,19 +114,65 @@ VideoPlayer::preferredSize() const
 }
 
 void
-VideoPlayer::load(const std::string& path)
+VideoPlayer::load(const std::string& path, Video::FrameFormat format)
 {
   delete _video;
-  _video = new Video(path);
+  _video = new Video(path, format);
+  _shownSeconds = -1;
   _video->frameUpdated.connect(sigc::mem_fun(this, &VideoPlayer::updateVideo));
+  if (_presentationMode == DirectPresentation && format == Video::NativeYUV)
+    ILOG_INFO("NativeYUV video (%s) is converted and blitted in direct mode.",
+        path.c_str());
   _play->setEnabled();
 }
 
+Video*
+VideoPlayer::video() const
+{
+  return _video;
+}
+
+VideoPlayer::PresentationMode
+VideoPlayer::presentationMode() const
+{
+  return _presentationMode;
+}
+
+void
+VideoPlayer::setPresentationMode(PresentationMode mode)
+{
+  if (mode == _presentationMode)
+    return;
+  _presentationMode = mode;
+  if (_video && (_video->status() == DVSTATE_PLAY || _video->status()
+      == DVSTATE_BUFFERING))
+    {
+      _video->stop();
+      startVideo();
+    }
+}
+
 void
 VideoPlayer::compose(const Rectangle& rect)
 {
+  bool direct = directPresentation() && _video->status() == DVSTATE_PLAY;
+
+  // video area belongs to provider, it is not damaged by widget paints.
+  if (direct && _videoRect.contains(rect, true))
+    return;
+
   Painter painter(this);
   painter.begin(rect);
+  if (direct)
+    {
+      cairo_t* context = painter.cairoContext();
+      cairo_set_fill_rule(context, CAIRO_FILL_RULE_EVEN_ODD);
+      cairo_rectangle(context, 0, 0, width(), height());
+      cairo_rectangle(context, _videoRect.x(), _videoRect.y(),
+          _videoRect.width(), _videoRect.height());
+      cairo_clip(context);
+      cairo_set_fill_rule(context, CAIRO_FILL_RULE_WINDING);
+    }
   designer()->drawFrame(&painter, this, 0, 0, width(), height(), true,
       BottomCorners);
   painter.end();
@@ -163,16 +210,23 @@ VideoPlayer::updateVPGeometry()
 void
 VideoPlayer::updateVideo(IDirectFBSurface* frame)
 {
-  _videoSurface->DFBSurface()->StretchBlit(_videoSurface->DFBSurface(), frame,
-      NULL, NULL);
+  if (frame != _videoSurface->DFBSurface())
+    _videoSurface->DFBSurface()->StretchBlit(_videoSurface->DFBSurface(),
+        frame, NULL, NULL);
   _videoSurface->flip();
 
+  // overlays are only damaged if their values change.
   if (!_position->pressed())
     {
-      char buffer[9];
-      toHMS(_video->position(), buffer);
-      _time->setText(buffer);
-      _position->setValue(100 * (_video->position() / _video->length()), false);
+      double position = _video->position();
+      if ((int) position != _shownSeconds)
+        {
+          char buffer[9];
+          toHMS(position, buffer);
+          _time->setText(buffer);
+          _shownSeconds = position;
+        }
+      _position->setValue(100 * (position / _video->length()), false);
     }
 
   if (_video->status() == DVSTATE_FINISHED)
@@ -188,7 +242,7 @@ VideoPlayer::playVideo()
   switch (_video->status())
     {
   case DVSTATE_STOP:
-    _video->play();
+    startVideo();
     _play->setIcon(ILIXI_DATADIR"pause.png", Size(16, 16));
     //    _play->update();
     _rewind->setEnabled();
@@ -198,7 +252,7 @@ VideoPlayer::playVideo()
     break;
   case DVSTATE_FINISHED:
     _video->seek(0);
-    _video->play();
+    startVideo();
     _play->setIcon(ILIXI_DATADIR"pause.png", Size(16, 16));
     //    _play->update();
     _rewind->setEnabled();
@@ -219,6 +273,23 @@ VideoPlayer::playVideo()
     }
 }
 
+bool
+VideoPlayer::directPresentation() const
+{
+  // YUV frames must pass through the converter, see Video::queueFrame().
+  return _presentationMode == DirectPresentation && _video
+      && _video->frameFormat() != Video::NativeYUV;
+}
+
+void
+VideoPlayer::startVideo()
+{
+  if (directPresentation() && _videoSurface)
+    _video->play(_videoSurface->DFBSurface());
+  else
+    _video->play();
+}
+
 void
 VideoPlayer::rewindVideo()
 {
@@ -233,6 +304,7 @@ VideoPlayer::seekVideo(int position)
   char buffer[9];
   toHMS(secs, buffer);
   _time->setText(buffer);
+  _shownSeconds = secs;
 }
 
 void
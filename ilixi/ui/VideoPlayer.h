@@ -40,6 +40,16 @@ namespace ilixi
   class VideoPlayer : public BorderBase
   {
   public:
+    /*!
+     * This enum specifies how decoded frames reach the screen.
+     */
+    enum PresentationMode
+    {
+      BlitPresentation, //!< Provider decodes into video frame, which is then scaled onto video surface.
+      DirectPresentation
+    //!< Provider renders directly into video surface, only the video area is flipped.
+    };
+
     /*!
      * Constructor.
      */
@@ -61,11 +71,40 @@ namespace ilixi
      * Loads video for playback.
      *
      * @param path to video file.
+     * @param format pixel format of decoded frames. NativeYUV frames are
+     * always converted and blitted, even in DirectPresentation mode.
+     */
+    void
+    load(const std::string& path,
+        Video::FrameFormat format = Video::ProviderFormat);
+
+    /*!
+     * Returns video object, or NULL if no video is loaded.
+     *
+     * Use Video::statistics() to query frame counters during playback.
+     */
+    Video*
+    video() const;
+
+    /*!
+     * Returns presentation mode.
+     */
+    PresentationMode
+    presentationMode() const;
+
+    /*!
+     * Sets presentation mode. Default is DirectPresentation.
+     *
+     * If video is playing, playback continues using new mode.
      */
     void
-    load(const std::string& path);
+    setPresentationMode(PresentationMode mode);
 
   private:
+    //! Presentation mode.
+    PresentationMode _presentationMode;
+    //! Last playback time shown in time label, in seconds.
+    int _shownSeconds;
     //! Subsurface for blitting video.
     Surface* _videoSurface;
     //! Video object.
@@ -106,6 +145,14 @@ namespace ilixi
     void
     playVideo();
 
+    //! Returns true if provider renders directly into video surface.
+    bool
+    directPresentation() const;
+
+    //! Starts provider using current presentation mode.
+    void
+    startVideo();
+
     //! Seeks video to start.
     void
     rewindVideo();
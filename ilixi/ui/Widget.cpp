@@ -26,6 +26,9 @@
 #include "core/Window.h"
 #include <algorithm>
 #include "core/Logger.h"
+#include "core/Trace.h"
+#include "core/PerfStats.h"
+#include "core/Arena.h"
 
 using namespace ilixi;
 
@@ -57,7 +60,8 @@ WidgetThread::run()
 Widget::Widget(Widget* parent) :
   _state(DefaultState), _surfaceDesc(DefaultDescription),
       _inputMethod(NoInput), _parent(parent), _surface(NULL), _uiManager(NULL),
-      _horizontalResizeConstraint(NoConstraint),
+      _registeredIn(NULL), _uiPrev(NULL), _uiNext(NULL), _focusPrev(NULL),
+      _focusNext(NULL), _horizontalResizeConstraint(NoConstraint),
       _verticalResizeConstraint(NoConstraint)
 {
   sigGeometryUpdated.connect(sigc::mem_fun(this, &Widget::updateFrameGeometry));
@@ -65,6 +69,8 @@ Widget::Widget(Widget* parent) :
 
 Widget::~Widget()
 {
+  if (perfStatsEnabled)
+    perfForget(this);
   if (_uiManager)
     _uiManager->removeWidget(this);
   for (WidgetListIterator it = _children.begin(); it != _children.end(); ++it)
@@ -72,6 +78,18 @@ Widget::~Widget()
   delete _surface;
 }
 
+void*
+Widget::operator new(size_t size)
+{
+  return Arena::allocate(Arena::current(), size);
+}
+
+void
+Widget::operator delete(void* ptr, size_t size)
+{
+  Arena::deallocate(ptr, size);
+}
+
 int
 Widget::x() const
 {
@@ -427,9 +445,13 @@ Widget::addChild(Widget* child)
     return;
 
   child->_parent = this;
-  if (_uiManager)
-    child->setUIManager(_uiManager);
+  Widget* previous = _children.empty() ? NULL : _children.back();
   _children.push_back(child);
+  if (_uiManager)
+    {
+      _uiManager->insertWidget(child, previous);
+      child->setUIManager(_uiManager);
+    }
 }
 
 void
@@ -453,8 +475,12 @@ Widget::raiseChildToFront(Widget* child)
   if (_children.size() == 1)
     return;
   WidgetListIterator it = std::find(_children.begin(), _children.end(), child);
-  if (child == *it)
-    std::iter_swap(it, _children.begin());
+  if (it != _children.end())
+    {
+      std::iter_swap(it, _children.begin());
+      if (_uiManager)
+        _uiManager->relinkChildren(this);
+    }
 }
 
 void
@@ -465,8 +491,12 @@ Widget::lowerChildToBottom(Widget* child)
   if (_children.size() == 1)
     return;
   WidgetListIterator it = std::find(_children.begin(), _children.end(), child);
-  if (child == *it)
-    std::iter_swap(it, _children.end());
+  if (it != _children.end())
+    {
+      std::iter_swap(it, --_children.end());
+      if (_uiManager)
+        _uiManager->relinkChildren(this);
+    }
 }
 
 void
@@ -477,8 +507,13 @@ Widget::raiseChild(Widget* child)
   if (_children.size() == 1)
     return;
   WidgetListIterator it = std::find(_children.begin(), _children.end(), child);
-  if (child == *it && it != _children.begin())
-    std::iter_swap(it, --it);
+  if (it != _children.end() && it != _children.begin())
+    {
+      WidgetListIterator previous = it;
+      std::iter_swap(it, --previous);
+      if (_uiManager)
+        _uiManager->relinkChildren(this);
+    }
 }
 
 void
@@ -489,8 +524,15 @@ Widget::lowerChild(Widget* child)
   if (_children.size() == 1)
     return;
   WidgetListIterator it = std::find(_children.begin(), _children.end(), child);
-  if (child == *it && it != _children.end())
-    std::iter_swap(it, ++it);
+  if (it == _children.end())
+    return;
+  WidgetListIterator next = it;
+  if (++next != _children.end())
+    {
+      std::iter_swap(it, next);
+      if (_uiManager)
+        _uiManager->relinkChildren(this);
+    }
 }
 
 void
@@ -512,6 +554,8 @@ Widget::setEnabled()
   if ((_state & DisabledState))
     {
       _state = (WidgetState) (_state & ~DisabledState);
+      if (_uiManager)
+        _uiManager->updateFocusChain(this);
       update();
     }
 }
@@ -522,6 +566,8 @@ Widget::setDisabled()
   if (!(_state & DisabledState))
     {
       _state = (WidgetState) (_state | DisabledState);
+      if (_uiManager)
+        _uiManager->updateFocusChain(this);
       update();
     }
 }
@@ -532,11 +578,15 @@ Widget::setVisible(bool visible)
   if (visible && _state & InvisibleState)
     {
       _state = (WidgetState) (_state & ~InvisibleState);
+      if (_uiManager)
+        _uiManager->updateFocusChain(this);
       doLayout();
     }
   else if (!visible && !(_state & InvisibleState))
     {
       _state = (WidgetState) (_state | InvisibleState);
+      if (_uiManager)
+        _uiManager->updateFocusChain(this);
       doLayout();
     }
 }
@@ -551,6 +601,8 @@ void
 Widget::setInputMethod(WidgetInputMethod method)
 {
   _inputMethod = method;
+  if (_uiManager)
+    _uiManager->updateFocusChain(this);
 }
 
 void
@@ -567,11 +619,24 @@ Widget::paint(const Rectangle& rect)
 {
   if (visible())
     {
+      ILIXI_TRACE_TYPE("paint", *this);
       updateSurface();
+      if (_surfaceDesc & InitialiseSurface)
+        return;
       Rectangle intersect = _frameGeometry.intersected(rect);
       if (intersect.isValid())
         {
-          compose(mapToSurface(intersect));
+            {
+              ILIXI_TRACE_TYPE("compose", *this);
+              if (perfStatsEnabled)
+                {
+                  long long begin = traceNow();
+                  compose(mapToSurface(intersect));
+                  perfCompose(this, typeid(*this).name(), traceNow() - begin);
+                }
+              else
+                compose(mapToSurface(intersect));
+            }
           paintChildren(intersect);
         }
     }
@@ -686,25 +751,61 @@ Widget::updateSurface()
 {
   if (!_surface && (_surfaceDesc & InitialiseSurface))
     {
-      delete _surface;
+      // parent surface may be released, see releaseSurfaces().
+      IDirectFBSurface* parentSurface = NULL;
+      if (_surfaceDesc & RootWindow)
+        parentSurface = _uiManager->root()->DFBSurface();
+      else if (_parent && _parent->surface())
+        parentSurface = _parent->surface()->DFBSurface();
+
       _surface = new Surface();
       bool ret = false;
+      // own surfaces are blitted by parent, never flipped, so they are
+      // single buffered and can be reused from surface pool.
       if (_surfaceDesc & HasOwnSurface)
-        ret = _surface->createDFBSurface(width(), height());
-      else if (_surfaceDesc & RootWindow)
-        ret = _surface->createDFBSubSurface(_surfaceGeometry,
-            _uiManager->root()->DFBSurface());
-      else if (_parent)
-        ret = _surface->createDFBSubSurface(_surfaceGeometry,
-            _parent->surface()->DFBSurface());
+        ret = _surface->createDFBSurface(width(), height(), false);
+      else if (parentSurface)
+        ret = _surface->createDFBSubSurface(_surfaceGeometry, parentSurface);
       if (ret)
         _surfaceDesc = (SurfaceDescription) (_surfaceDesc & ~InitialiseSurface);
+      else
+        {
+          delete _surface;
+          _surface = NULL;
+        }
     }
 
   if (_surfaceDesc & SurfaceModified)
     sigGeometryUpdated();
 }
 
+unsigned int
+Widget::releaseSurfaces()
+{
+  unsigned int bytes = 0;
+  for (WidgetListIterator it = _children.begin(); it != _children.end(); ++it)
+    bytes += ((Widget*) *it)->releaseSurfaces();
+
+  if (_surface)
+    {
+      bytes += _surface->memoryUsage();
+      delete _surface;
+      _surface = NULL;
+      _surfaceDesc = (SurfaceDescription) (_surfaceDesc | InitialiseSurface);
+    }
+  return bytes;
+}
+
+void
+Widget::memoryUsage(MemoryUsage& usage) const
+{
+  for (WidgetListConstIterator it = _children.begin(); it != _children.end(); ++it)
+    ((Widget*) *it)->memoryUsage(usage);
+
+  if (_surface)
+    _surface->memoryUsage(usage);
+}
+
 void
 Widget::updateFrameGeometry()
 {
@@ -852,10 +953,13 @@ Widget::setUIManager(UIManager* uiManager)
 {
   _surfaceDesc = (SurfaceDescription) (_surfaceDesc | InitialiseSurface);
   _uiManager = uiManager;
+  // children are listed in tree order, each followed by its own children.
+  Widget* previous = NULL;
   for (WidgetListIterator it = _children.begin(); it != _children.end(); ++it)
     {
+      _uiManager->insertWidget(*it, previous);
       (*it)->setUIManager(uiManager);
-      _uiManager->addWidget(*it);
+      previous = *it;
     }
 }
 
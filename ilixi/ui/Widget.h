@@ -28,6 +28,7 @@
 #include "graphics/Designer.h"
 #include "types/Enums.h"
 #include "types/Event.h"
+#include "core/Arena.h"
 #include <list>
 #include <string>
 #include <sigc++/signal.h>
@@ -81,6 +82,18 @@ namespace ilixi
     virtual
     ~Widget();
 
+    /*!
+     * Allocates widget from current arena if there is one, see ArenaScope.
+     */
+    static void*
+    operator new(size_t size);
+
+    /*!
+     * Frees widget allocated using operator new.
+     */
+    static void
+    operator delete(void* ptr, size_t size);
+
     /*!
      * Returns x coordinate of the widget relative to its parent.
      */
@@ -567,6 +580,22 @@ namespace ilixi
     virtual void
     doLayout();
 
+    /*!
+     * Releases surfaces of widget and its children. Surfaces are created
+     * again next time widget is painted. Returns number of bytes freed.
+     */
+    virtual unsigned int
+    releaseSurfaces();
+
+    /*!
+     * Adds memory held by widget and its children to usage.
+     *
+     * Reimplement this method in widgets which own images, fonts or text
+     * layouts and call base class implementation.
+     */
+    virtual void
+    memoryUsage(MemoryUsage& usage) const;
+
     /*!
      * Maps the given rectangle in absolute coordinates to local coordinates.
      *
@@ -684,7 +713,7 @@ namespace ilixi
      */
     WidgetInputMethod _inputMethod;
 
-    typedef std::list<Widget*> WidgetList;
+    typedef std::list<Widget*, ArenaAllocator<Widget*> > WidgetList;
     typedef WidgetList::iterator WidgetListIterator;
     typedef WidgetList::const_iterator WidgetListConstIterator;
     typedef WidgetList::reverse_iterator WidgetListReverseIterator;
@@ -884,6 +913,17 @@ namespace ilixi
     //! Pointer to UIManager of this widget.
     UIManager* _uiManager;
 
+    //! UIManager whose list contains this widget, NULL if none.
+    UIManager* _registeredIn;
+    //! Previous widget in UIManager's list, in tree order.
+    Widget* _uiPrev;
+    //! Next widget in UIManager's list, in tree order.
+    Widget* _uiNext;
+    //! Previous widget in UIManager's focus chain, NULL if widget can not get focus.
+    Widget* _focusPrev;
+    //! Next widget in UIManager's focus chain, NULL if widget can not get focus.
+    Widget* _focusNext;
+
     //! This property defines widget's behaviour inside a layout. Default is NoConstraint.
     WidgetResizeConstraint _horizontalResizeConstraint;
 
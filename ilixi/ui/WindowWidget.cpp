@@ -23,15 +23,21 @@
 
 #include "WindowWidget.h"
 #include "core/Logger.h"
+#include "core/Startup.h"
+#include "core/Trace.h"
+#include "core/PerfStats.h"
+#include "graphics/Painter.h"
 
 using namespace ilixi;
 
 WindowWidget::WindowWidget(Widget* parent) :
-  Window(), Frame(parent)
+  Window(), Frame(parent), _arena(NULL)
 {
   pthread_mutex_init(&_updates._listLock, NULL);
   sem_init(&_updates._updateReady, 0, 0);
   sem_init(&_updates._paintReady, 0, 1);
+  _flash._time = 0;
+  _flash._clearing = false;
   _surfaceDesc = WindowDescription;
   setUIManager(_windowUIManager);
   setMargin(5);
@@ -42,6 +48,16 @@ WindowWidget::~WindowWidget()
   pthread_mutex_destroy(&_updates._listLock);
   sem_destroy(&_updates._updateReady);
   sem_destroy(&_updates._paintReady);
+  if (_arena)
+    _arena->destroy();
+}
+
+Arena*
+WindowWidget::arena()
+{
+  if (!_arena)
+    _arena = new Arena();
+  return _arena;
 }
 
 void
@@ -50,9 +66,18 @@ WindowWidget::doLayout()
   update();
 }
 
+void
+WindowWidget::memoryUsage(MemoryUsage& usage) const
+{
+  Frame::memoryUsage(usage);
+  usage.pixels += Surface::memoryUsage(_windowSurface);
+}
+
 void
 WindowWidget::paint(const Rectangle& rect)
 {
+  // surfaces created during paint come from window's arena.
+  ArenaScope scope(_arena ? _arena : Arena::current());
   if (visible())
     {
       int ready;
@@ -65,13 +90,16 @@ WindowWidget::paint(const Rectangle& rect)
         }
       else
         {
+          ILIXI_TRACE_TYPE("paint", *this);
+          long long frameBegin = perfStatsEnabled ? traceNow() : 0;
           sem_wait(&_updates._updateReady);
           updateSurface();
           Rectangle intersect = _frameGeometry.intersected(
               _updates._updateRegion);
           sem_post(&_updates._paintReady);
-          if (intersect.isValid())
+          if (intersect.isValid() && surface())
             {
+              startupBegin(StartupPaint);
               if (_backgroundFilled)
                 {
                   surface()->clear(intersect);
@@ -81,7 +109,23 @@ WindowWidget::paint(const Rectangle& rect)
                 surface()->clear(intersect);
 
               paintChildren(intersect);
+              startupEnd(StartupPaint);
+              if (perfFlashEnabled && !perfStatsPaused && !_flash._clearing)
+                {
+                  Painter p(this);
+                  p.begin(intersect);
+                  p.getBrush()->setColor(Color(1, 0, 1, 0.3));
+                  p.drawRectangle(intersect, Painter::FillPath);
+                  p.end();
+                  _flash._region = _flash._region.isNull() ? intersect
+                      : _flash._region.united(intersect);
+                  _flash._time = traceNow();
+                }
+              startupBegin(StartupFlip);
               surface()->flip(intersect);
+              startupEnd(StartupFlip);
+              if (frameBegin)
+                perfFrame(traceNow() - frameBegin);
             }
         }
     }
@@ -150,6 +194,7 @@ WindowWidget::updateWindow()
 
   if (_updates._updateQueue.size())
     {
+      ILIXI_TRACE("updateWindow");
       pthread_mutex_lock(&_updates._listLock);
       Rectangle updateTemp;
       updateTemp = _updates._updateQueue[0];
@@ -169,4 +214,13 @@ WindowWidget::updateWindow()
           paint(_updates._updateRegion);
         }
     }
+  // Repaint flashed regions once they have been visible for a while.
+  else if (!_flash._region.isNull() && traceNow() - _flash._time > 150000000LL)
+    {
+      Rectangle region = _flash._region;
+      _flash._region = Rectangle();
+      _flash._clearing = true;
+      repaint(region);
+      _flash._clearing = false;
+    }
 }
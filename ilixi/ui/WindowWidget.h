@@ -25,6 +25,7 @@
 #define ILIXI_WINDOWWIDGET_H_
 
 #include "core/Window.h"
+#include "core/Arena.h"
 #include "ui/Frame.h"
 #include <vector>
 #include "types/Rectangle.h"
@@ -59,6 +60,26 @@ namespace ilixi
     virtual void
     repaint(const Rectangle& rect);
 
+    /*!
+     * Adds window surface, widget surfaces and resources of child widgets
+     * to usage.
+     */
+    virtual void
+    memoryUsage(MemoryUsage& usage) const;
+
+    /*!
+     * Returns arena of window, creating it first if necessary.
+     *
+     * Child widgets constructed inside an ArenaScope for this arena, and
+     * their child and layout list nodes, are allocated next to each other.
+     * Once arena exists, surfaces, painter brushes and fonts, and update
+     * queue entries created while painting window are allocated from it as
+     * well. Arena is destroyed with window and its memory is freed after
+     * last object.
+     */
+    Arena*
+    arena();
+
   protected:
     /*!
      * Handles incoming input events if window has focus.
@@ -77,9 +98,23 @@ namespace ilixi
       sem_t _updateReady;
       sem_t _paintReady;
       Rectangle _updateRegion;
-      std::vector<Rectangle> _updateQueue;
+      std::vector<Rectangle, ArenaAllocator<Rectangle> > _updateQueue;
     } _updates;
 
+    //! Stores regions flashed while perfFlashEnabled is set.
+    struct
+    {
+      //! Union of flashed regions which are not repainted yet.
+      Rectangle _region;
+      //! Time of last flash in nanoseconds.
+      long long _time;
+      //! This flag is set while flashed regions are repainted.
+      bool _clearing;
+    } _flash;
+
+    //! Arena for widgets of window, NULL until requested.
+    Arena* _arena;
+
     //! Updates dirty regions inside window.
     virtual void
     updateWindow();